@@ -0,0 +1,17 @@
+// Configuration for the *_diagnostics tools: the default configuration (spacemouse-keys/config.h) with the
+// calibrations and diagnostics, which are off there.
+#include "../spacemouse-keys/config.h"
+#undef LIN_TABLE
+#define LIN_TABLE 1
+#undef KIN_MATRIX
+#define KIN_MATRIX 1
+#undef ENABLE_TELEMETRY
+#define ENABLE_TELEMETRY 1
+#undef MICRO_BENCH
+#define MICRO_BENCH 1
+#undef FLIGHT_RECORDER
+#define FLIGHT_RECORDER 1
+#undef STACK_MONITOR
+#define STACK_MONITOR 1
+#undef LATENCY_STATS
+#define LATENCY_STATS 1
@@ -0,0 +1,14 @@
+// Configuration for encoder_bench_timed: the encoder test configuration (wheel as axis and as keys) with the
+// time based encoder engine, which is not in any of the configurations in testConfig/.
+#include "../testConfig/d2_test_encoder_key.h"
+#undef RAXIS_ECH
+#define RAXIS_ECH 100
+#define ENCODER_TIMED 1
+#define ROTARY_KEY_MS 17
+// d2 has NUMKEYS 3, its key B (index 3) would be outside of keyState[], and its key on pin 2 is ENCODER_CLK
+#undef ROTARY_KEY_IDX_A
+#undef ROTARY_KEY_IDX_B
+#define ROTARY_KEY_IDX_A 1
+#define ROTARY_KEY_IDX_B 2
+#undef KEYLIST
+#define KEYLIST {14, 15, 16}
@@ -0,0 +1,4 @@
+// The sketch as translation unit for the host build. The Arduino IDE compiles the .ino file the same way
+// after adding the include of Arduino.h.
+#include <Arduino.h>
+#include "spacemouse-keys.ino"
@@ -0,0 +1,5 @@
+// Configuration for idle_bench: the default configuration (spacemouse-keys/config.h) with the idle mode, which is
+// off there.
+#include "../spacemouse-keys/config.h"
+#undef IDLE_MODE
+#define IDLE_MODE 1
@@ -0,0 +1,5 @@
+// Configuration for idle_bench_encoder: the encoder wheel test configuration (testConfig/d_test_encoder.h) with the
+// idle mode, so idle_bench also wakes up the idle mode with the encoder.
+#include "../testConfig/d_test_encoder.h"
+#undef IDLE_MODE
+#define IDLE_MODE 1
@@ -0,0 +1,5 @@
+// Configuration for kinematics_bench_resistive: the resistive joysticks (testConfig/b_test_resistiveJoystick.h) with
+// the decoupling matrix, which only the hall effect sensors of *_diagnostics have, for --exclusive.
+#include "../testConfig/b_test_resistiveJoystick.h"
+#undef KIN_MATRIX
+#define KIN_MATRIX 1
@@ -0,0 +1,5 @@
+// Configuration for log_decode: spacemouse-keys/config.h with the texts and parameter names in full,
+// so the decoder knows them, even if config.h selects LOG_TOKENIZED 1.
+#include "config.h"
+#undef LOG_TOKENIZED
+#define LOG_TOKENIZED 0
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Measures the flash data (PROGMEM tables and F()/PSTR() strings) of every configuration with
+plain text and with tokenized log messages (LOG_TOKENIZED, see spacemouse-keys/logMessages.h).
+
+    python3 host/progmem_report.py [--markdown]
+
+Each configuration (spacemouse-keys/config.h and testConfig/*.h) is compiled twice with the host
+shim and linked with --gc-sections. The shim places PROGMEM data and strings in .progmem* sections
+(see shim/avr/pgmspace.h), their sum is reported. The code is not measured: the AVR code size
+differs from the host, and logPrint() calls are smaller with tokens, so the savings are a lower bound.
+"""
+import glob
+import os
+import subprocess
+import sys
+import tempfile
+
+HOST = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HOST)
+FIRMWARE = os.path.join(ROOT, "spacemouse-keys")
+CXX = os.environ.get("CXX", "g++")
+CXXFLAGS = ["-std=gnu++14", "-Os", "-w", "-ffunction-sections", "-fdata-sections",
+            "-DARDUINO_ARCH_AVR", "-DARDUINO=10819", "-I", os.path.join(HOST, "shim"), "-I", FIRMWARE]
+
+MAIN = "void setup();\nvoid loop();\nint main() {\n  setup();\n  for (;;) loop();\n}\n"
+
+
+def progmem_size(config, tokenized, tmp):
+    """returns the bytes in .progmem* sections of the linked firmware"""
+    wrapper = os.path.join(tmp, "config_%d.h" % tokenized)
+    with open(wrapper, "w") as f:
+        f.write('#include "%s"\n#undef LOG_TOKENIZED\n#define LOG_TOKENIZED %d\n' % (config, tokenized))
+    main = os.path.join(tmp, "main.cpp")
+    with open(main, "w") as f:
+        f.write(MAIN)
+    sources = sorted(glob.glob(os.path.join(FIRMWARE, "*.cpp")))
+    sources += [os.path.join(HOST, "firmware_main.cpp"), os.path.join(HOST, "shim", "Arduino.cpp"), main]
+    exe = os.path.join(tmp, "firmware_%d" % tokenized)
+    subprocess.run([CXX] + CXXFLAGS + ["-include", wrapper] + sources +
+                   ["-Wl,--gc-sections", "-o", exe], check=True)
+    out = subprocess.run(["size", "-A", exe], check=True, capture_output=True, text=True).stdout
+    return sum(int(line.split()[1]) for line in out.splitlines() if line.startswith(".progmem"))
+
+
+def description(config):
+    if config.endswith("config.h"):
+        return "default configuration"
+    with open(config) as f:
+        return f.readline().strip().lstrip("/ ").strip()
+
+
+def main():
+    configs = [os.path.join(FIRMWARE, "config.h")]
+    configs += sorted(glob.glob(os.path.join(ROOT, "testConfig", "*.h")))
+    rows = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for config in configs:
+            text = progmem_size(config, 0, tmp)
+            tokens = progmem_size(config, 1, tmp)
+            name = os.path.relpath(config, ROOT) if config.endswith("config.h") else os.path.basename(config)
+            rows.append((name, description(config), text, tokens))
+            print("%-28s %6d %6d %6d" % (name, text, tokens, tokens - text), file=sys.stderr)
+    if "--markdown" in sys.argv:
+        print("| Config | Description | PROGMEM text (bytes) | PROGMEM tokenized (bytes) | Difference (bytes) |")
+        print("|--------|-------------|----------------------|---------------------------|--------------------|")
+        for name, desc, text, tokens in rows:
+            print("| %s | %s | %d | %d | %d |" % (name, desc, text, tokens, tokens - text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,568 @@
+// Implementation of the Arduino shim: virtual clock, simulated pins, ADC, serial, USB and EEPROM
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <PluggableUSB.h>
+#include <Encoder.h>
+#include <FastLED.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#include <ucontext.h>
+
+#include <deque>
+#include <iostream>
+#include <map>
+
+#include "sim.h"
+
+// default interrupt service routines, overridden by the firmware if it uses the interrupt
+extern "C" __attribute__((weak)) void shim_EE_READY_vect(void) {}
+extern "C" __attribute__((weak)) void shim_WDT_vect(void) {}
+extern "C" __attribute__((weak)) void shim_TIMER1_OVF_vect(void) {}
+extern "C" __attribute__((weak)) void shim_ADC_vect(void) {}
+
+// RAM above .bss, the stack of the firmware with sim::runOnStack() (see stackFreeMin() of the firmware)
+const uint32_t STACK_SIZE = 32768;
+const uint8_t STACK_PAINT = 0xC5;  // as in spacemouse-keys/stackMonitor.h
+uint8_t __heap_start[STACK_SIZE];
+uint8_t* __brkval = nullptr;
+
+namespace {
+
+const uint32_t EEPROM_WRITE_MICROS = 3400;  // erase and write of one byte
+const int NUM_INTERRUPTS = 5;
+
+struct State {
+  uint64_t micros = 0;
+  uint32_t analogReadMicros = 104;
+  uint32_t analogReads = 0;
+  int analog[NUM_DIGITAL_PINS] = {};
+  sim::AnalogSource analogSource;
+  int digital[NUM_DIGITAL_PINS] = {};
+  std::deque<char> serialIn;
+  std::string serialOut;
+  bool serialEcho = false;
+  uint32_t serialMicrosPerByte = 0;
+  std::vector<sim::UsbPacket> usbPackets;
+  std::vector<uint8_t> usbPending[8];
+  std::deque<uint8_t> usbRx;
+  bool usbSuspended = false;
+  uint8_t sleepMode = 0;
+  bool sleepEnabled = false;
+  uint64_t sleepMicros = 0;  // time in sleep_cpu()
+  uint32_t sleeps = 0;
+  uint8_t eeprom[1024];
+  uint32_t eepromWrites = 0;
+  uint64_t eepromBusyUntil = 0;
+  uint64_t watchdogStart = 0;  // last wdt_reset()
+  uint64_t timer1Cycles = 0;   // CPU cycles, which haven't made a full prescaler step of Timer1 yet
+  bool interruptsEnabled = true;
+  int32_t encoder = 0;
+  int encoderPins[2] = {-1, -1};
+  uint8_t encoderState = 0;
+  std::multimap<uint64_t, std::pair<uint8_t, int>> scheduledPins;  // virtual time -> pin, value
+  void (*isr[NUM_INTERRUPTS])(void) = {};
+  int isrMode[NUM_INTERRUPTS] = {};
+
+  State() {
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    for (int i = 0; i < NUM_DIGITAL_PINS; i++) digital[i] = HIGH;
+  }
+};
+
+State& state() {
+  static State s;
+  return s;
+}
+
+// EEPROM control register: starts reads and writes like the hardware
+void eecrWritten(uint8_t oldValue, uint8_t newValue) {
+  State& s = state();
+  if (newValue & _BV(EERE)) {
+    EEDR.poke(s.eeprom[EEAR & E2END]);
+    newValue &= ~_BV(EERE);
+  }
+  if ((newValue & _BV(EEPE)) && !(oldValue & _BV(EEPE)) && (oldValue & _BV(EEMPE))) {
+    s.eeprom[EEAR & E2END] = EEDR;
+    s.eepromWrites++;
+    s.eepromBusyUntil = s.micros + EEPROM_WRITE_MICROS;
+    newValue &= ~_BV(EEMPE);
+  }
+  EECR.poke(newValue);
+}
+
+// watchdog control register: a write restarts the timeout, a written WDIF clears the flag
+void wdtcsrWritten(uint8_t, uint8_t newValue) {
+  state().watchdogStart = state().micros;
+  WDTCSR.poke(newValue & ~_BV(WDIF));
+}
+
+// Timer1 interrupt flag register: writing 1 clears a flag
+void tifr1Written(uint8_t oldValue, uint8_t newValue) {
+  TIFR1.poke(oldValue & ~newValue);
+}
+
+// Timer1 in normal mode: count the CPU cycles of us with the prescaler, set TOV1 at each overflow
+void advanceTimer1(uint64_t us) {
+  static const uint16_t prescalers[8] = {0, 1, 8, 64, 256, 1024, 0, 0};  // 6, 7: external clock, not simulated
+  State& s = state();
+  uint16_t prescaler = prescalers[TCCR1B & 7];
+  if (prescaler == 0) return;
+  s.timer1Cycles += us * (F_CPU / 1000000L);
+  uint64_t ticks = s.timer1Cycles / prescaler;
+  s.timer1Cycles %= prescaler;
+  uint64_t count = TCNT1 + ticks;
+  TCNT1.poke((uint16_t)count);
+  for (uint64_t overflows = count >> 16; overflows > 0; overflows--) {
+    TIFR1.poke(TIFR1 | _BV(TOV1));
+    if ((TIMSK1 & _BV(TOIE1)) && s.interruptsEnabled) {
+      TIFR1.poke(TIFR1 & ~_BV(TOV1));  // cleared by the execution of the vector
+      shim_TIMER1_OVF_vect();
+    }
+  }
+}
+
+// timeout of the watchdog from the prescaler bits: 16 ms * 2^prescaler
+uint64_t watchdogTimeout() {
+  uint8_t prescaler = (WDTCSR & 7) | ((WDTCSR & _BV(WDP3)) ? 8 : 0);
+  return 16000ULL << prescaler;
+}
+
+// position of the Encoder library: quadrature decoding as in its interrupt routine
+void updateEncoder() {
+  State& s = state();
+  if (s.encoderPins[0] < 0) return;
+  static const int8_t step[16] = {0, 1, -1, 2, -1, 0, -2, 1, 1, -2, 0, -1, 2, -1, 1, 0};
+  uint8_t index = s.encoderState | (s.digital[s.encoderPins[0]] ? 4 : 0) | (s.digital[s.encoderPins[1]] ? 8 : 0);
+  s.encoder += step[index];
+  s.encoderState = index >> 2;
+}
+
+// call the interrupt service routines, which are due
+void dispatchInterrupts() {
+  State& s = state();
+  if (!s.interruptsEnabled) return;
+  for (int guard = 0; guard < 100000; guard++) {
+    if ((EECR & _BV(EERIE)) && !(EECR & _BV(EEPE))) {
+      shim_EE_READY_vect();
+    } else {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+ShimReg8 EECR(eecrWritten);
+ShimReg16 EEAR;
+ShimReg8 EEDR;
+ShimReg8 WDTCSR(wdtcsrWritten);
+ShimReg8 SREG;
+ShimReg8 TCCR1A;
+ShimReg8 TCCR1B;
+ShimReg16 TCNT1;
+ShimReg8 TIMSK1;
+ShimReg8 TIFR1(tifr1Written);
+
+Serial_ Serial;
+CFastLED FastLED;
+EEPROMClass EEPROM;
+USBDevice_ USBDevice;
+
+//--- simulation control
+namespace sim {
+
+void reset() {
+  State& s = state();
+  int encoderPins[2] = {s.encoderPins[0], s.encoderPins[1]};  // wiring of the global Encoder object
+  s = State();
+  if (encoderPins[0] >= 0) shimEncoderPins(encoderPins[0], encoderPins[1]);
+  EECR.poke(0);
+  EEAR.poke(0);
+  EEDR.poke(0);
+  WDTCSR.poke(0);
+  TCCR1A.poke(0);
+  TCCR1B.poke(0);
+  TCNT1.poke(0);
+  TIMSK1.poke(0);
+  TIFR1.poke(0);
+}
+
+uint32_t now() { return (uint32_t)state().micros; }
+
+void advanceMicros(uint32_t us) {
+  State& s = state();
+  uint64_t target = s.micros + us;
+  dispatchInterrupts();
+  advanceTimer1(us);
+  while (!s.scheduledPins.empty() && s.scheduledPins.begin()->first <= target) {
+    auto change = *s.scheduledPins.begin();
+    s.scheduledPins.erase(s.scheduledPins.begin());
+    if (change.first > s.micros) s.micros = change.first;
+    setInterruptPin(change.second.first, change.second.second);
+  }
+  while ((EECR & _BV(EEPE)) && s.eepromBusyUntil <= target) {
+    if (s.eepromBusyUntil > s.micros) s.micros = s.eepromBusyUntil;
+    EECR.poke(EECR & ~_BV(EEPE));  // write done: EEPROM is ready again
+    dispatchInterrupts();
+  }
+  while ((WDTCSR & _BV(WDIE)) && s.interruptsEnabled && s.watchdogStart + watchdogTimeout() <= target) {
+    s.watchdogStart += watchdogTimeout();
+    if (s.watchdogStart > s.micros) s.micros = s.watchdogStart;
+    shim_WDT_vect();  // the interrupt mode stays on, as without WDE on the hardware
+  }
+  s.micros = target;
+}
+
+void setAnalogReadMicros(uint32_t us) { state().analogReadMicros = us; }
+void setAnalog(uint8_t pin, int value) { state().analog[pin % NUM_DIGITAL_PINS] = value; }
+void setAnalogSource(AnalogSource source) { state().analogSource = source; }
+uint32_t analogReadCount() { return state().analogReads; }
+
+void setDigital(uint8_t pin, int value) { state().digital[pin % NUM_DIGITAL_PINS] = value; }
+int getDigital(uint8_t pin) { return state().digital[pin % NUM_DIGITAL_PINS]; }
+
+void serialInput(const std::string& text) {
+  for (char c : text) state().serialIn.push_back(c);
+}
+size_t serialInputPending() { return state().serialIn.size(); }
+
+std::string takeSerialOutput() {
+  std::string out;
+  out.swap(state().serialOut);
+  return out;
+}
+void setSerialEcho(bool echo) { state().serialEcho = echo; }
+void setSerialMicrosPerByte(uint32_t us) { state().serialMicrosPerByte = us; }
+
+std::vector<UsbPacket>& usbPackets() { return state().usbPackets; }
+void usbReceive(const std::vector<uint8_t>& data) {
+  for (uint8_t b : data) state().usbRx.push_back(b);
+}
+void setUsbSuspended(bool suspended) { state().usbSuspended = suspended; }
+
+uint64_t sleepMicros() { return state().sleepMicros; }
+uint32_t sleepCount() { return state().sleeps; }
+
+uint8_t* eeprom() { return state().eeprom; }
+uint32_t eepromWriteCount() { return state().eepromWrites; }
+
+void setEncoder(int32_t position) { state().encoder = position; }
+
+static ucontext_t callerContext, stackContext;
+static const std::function<void()>* stackBody;
+
+static void stackEntry() { (*stackBody)(); }
+
+void runOnStack(const std::function<void()>& body) {
+  memset(__heap_start, STACK_PAINT, STACK_SIZE);
+  stackBody = &body;
+  getcontext(&stackContext);
+  stackContext.uc_stack.ss_sp = __heap_start;
+  stackContext.uc_stack.ss_size = STACK_SIZE;
+  stackContext.uc_link = &callerContext;
+  makecontext(&stackContext, stackEntry, 0);
+  swapcontext(&callerContext, &stackContext);
+}
+
+__attribute__((noinline)) void paintStack() {
+  uint8_t* below = (uint8_t*)__builtin_frame_address(0) - 256;  // below the frames of this function and memset()
+  if (below <= __heap_start || below >= __heap_start + STACK_SIZE) return;  // not on the firmware stack
+  for (uint8_t* p = __heap_start; p < below; p++) *p = STACK_PAINT;
+}
+
+uint32_t stackSize() { return STACK_SIZE; }
+
+void setInterruptPin(uint8_t pin, int value) {
+  State& s = state();
+  int old = s.digital[pin % NUM_DIGITAL_PINS];
+  s.digital[pin % NUM_DIGITAL_PINS] = value;
+  if (old != value && (pin == s.encoderPins[0] || pin == s.encoderPins[1])) updateEncoder();
+  int num = digitalPinToInterrupt(pin);
+  if (num < 0 || num >= NUM_INTERRUPTS || !s.isr[num] || old == value || !s.interruptsEnabled) return;
+  int mode = s.isrMode[num];
+  if (mode == CHANGE || (mode == RISING && value) || (mode == FALLING && !value)) s.isr[num]();
+}
+
+void schedulePin(uint8_t pin, int value, uint32_t micros) {
+  State& s = state();
+  int32_t ahead = (int32_t)(micros - (uint32_t)s.micros);
+  s.scheduledPins.emplace(s.micros + (ahead > 0 ? ahead : 0), std::make_pair(pin, value));
+  if (ahead <= 0) advanceMicros(0);
+}
+
+}  // namespace sim
+
+int32_t shimEncoderPosition() { return state().encoder; }
+
+void shimEncoderPins(uint8_t pin1, uint8_t pin2) {
+  State& s = state();
+  s.encoderPins[0] = pin1 % NUM_DIGITAL_PINS;
+  s.encoderPins[1] = pin2 % NUM_DIGITAL_PINS;
+  s.encoderState = (s.digital[s.encoderPins[0]] ? 1 : 0) | (s.digital[s.encoderPins[1]] ? 2 : 0);
+}
+
+//--- time
+unsigned long millis() { return (unsigned long)(state().micros / 1000); }
+unsigned long micros() { return (unsigned long)state().micros; }
+void delay(unsigned long ms) { sim::advanceMicros(ms * 1000); }
+void delayMicroseconds(unsigned int us) { sim::advanceMicros(us); }
+void wdt_reset() { state().watchdogStart = state().micros; }
+
+void set_sleep_mode(uint8_t mode) { state().sleepMode = mode; }
+void sleep_enable() { state().sleepEnabled = true; }
+void sleep_disable() { state().sleepEnabled = false; }
+void sleep_cpu() {
+  State& s = state();
+  if (!s.sleepEnabled) return;  // SE not set: SLEEP is a nop
+  uint32_t asleep = 1000 - s.micros % 1000;  // until the next tick of millis()
+  s.sleepMicros += asleep;
+  s.sleeps++;
+  sim::advanceMicros(asleep);
+}
+void yield() { sim::advanceMicros(4); }
+
+void cli() {
+  state().interruptsEnabled = false;
+  SREG.poke(SREG & 0x7F);
+}
+void sei() {
+  state().interruptsEnabled = true;
+  SREG.poke(SREG | 0x80);
+  dispatchInterrupts();
+}
+
+//--- pins
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) state().digital[pin % NUM_DIGITAL_PINS] = HIGH;
+}
+void digitalWrite(uint8_t pin, uint8_t val) { state().digital[pin % NUM_DIGITAL_PINS] = val; }
+int digitalRead(uint8_t pin) { return state().digital[pin % NUM_DIGITAL_PINS]; }
+
+int analogRead(uint8_t pin) {
+  State& s = state();
+  int v = s.analogSource ? s.analogSource(pin, (uint32_t)s.micros) : s.analog[pin % NUM_DIGITAL_PINS];
+  s.analogReads++;
+  sim::advanceMicros(s.analogReadMicros);
+  return constrain(v, 0, 1023);
+}
+void analogReference(uint8_t) {}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
+  if (interruptNum < NUM_INTERRUPTS) {
+    state().isr[interruptNum] = userFunc;
+    state().isrMode[interruptNum] = mode;
+  }
+}
+void detachInterrupt(uint8_t interruptNum) {
+  if (interruptNum < NUM_INTERRUPTS) state().isr[interruptNum] = nullptr;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+//--- serial
+int Serial_::available() { return (int)state().serialIn.size(); }
+int Serial_::peek() { return state().serialIn.empty() ? -1 : (unsigned char)state().serialIn.front(); }
+int Serial_::read() {
+  State& s = state();
+  if (s.serialIn.empty()) return -1;
+  int c = (unsigned char)s.serialIn.front();
+  s.serialIn.pop_front();
+  return c;
+}
+size_t Serial_::write(uint8_t c) { return write(&c, 1); }
+size_t Serial_::write(const uint8_t* buffer, size_t size) {
+  State& s = state();
+  s.serialOut.append((const char*)buffer, size);
+  if (s.serialEcho) std::cout.write((const char*)buffer, size).flush();
+  if (s.serialMicrosPerByte > 0) sim::advanceMicros(size * s.serialMicrosPerByte);
+  return size;
+}
+
+bool USBDevice_::isSuspended() { return state().usbSuspended; }
+
+//--- Stream
+int Stream::timedRead() {
+  if (available()) return read();
+  sim::advanceMicros(_timeout * 1000);  // nothing arrives: the whole timeout passes
+  return available() ? read() : -1;
+}
+
+int Stream::timedPeek() {
+  if (available()) return peek();
+  sim::advanceMicros(_timeout * 1000);
+  return available() ? peek() : -1;
+}
+
+int Stream::peekNextDigit() {
+  while (true) {
+    int c = timedPeek();
+    if (c < 0 || c == '-' || (c >= '0' && c <= '9') || c == '.') return c;
+    read();
+  }
+}
+
+long Stream::parseInt() {
+  bool isNegative = false;
+  long value = 0;
+  int c = peekNextDigit();
+  if (c < 0) return 0;
+  do {
+    if (c == '-')
+      isNegative = true;
+    else if (c >= '0' && c <= '9')
+      value = value * 10 + c - '0';
+    read();
+    c = timedPeek();
+  } while ((c >= '0' && c <= '9'));
+  return isNegative ? -value : value;
+}
+
+float Stream::parseFloat() {
+  bool isNegative = false;
+  bool isFraction = false;
+  long value = 0;
+  float fraction = 1.0;
+  int c = peekNextDigit();
+  if (c < 0) return 0;
+  do {
+    if (c == '-')
+      isNegative = true;
+    else if (c == '.')
+      isFraction = true;
+    else if (c >= '0' && c <= '9') {
+      value = value * 10 + c - '0';
+      if (isFraction) fraction *= 0.1f;
+    }
+    read();
+    c = timedPeek();
+  } while ((c >= '0' && c <= '9') || (c == '.' && !isFraction));
+  if (isNegative) value = -value;
+  return isFraction ? value * fraction : value;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t index = 0;
+  while (index < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) break;
+    *buffer++ = (char)c;
+    index++;
+  }
+  return index;
+}
+
+//--- Print
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return printNumber(-n, 10) + t;
+  }
+  if (base != 10) n = (uint32_t)n;  // like on the AVR: long has 32 bits
+  return printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base) { return printNumber(n, base); }
+
+size_t Print::print(double number, int digits) {
+  size_t n = 0;
+  if (isnan(number)) return print("nan");
+  if (isinf(number)) return print("inf");
+  if (number > 4294967040.0) return print("ovf");
+  if (number < -4294967040.0) return print("ovf");
+  if (number < 0.0) {
+    n += print('-');
+    number = -number;
+  }
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+  number += rounding;
+  unsigned long intPart = (unsigned long)number;
+  double remainder = number - (double)intPart;
+  n += print(intPart);
+  if (digits > 0) n += print('.');
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int toPrint = (unsigned int)remainder;
+    n += print(toPrint);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+//--- USB
+int USB_SendControl(uint8_t, const void*, int len) { return len; }
+
+int USB_Send(uint8_t ep, const void* data, int len) {
+  State& s = state();
+  if (s.usbSuspended) return -1;  // as the core after the timeout of the remote wakeup
+  uint8_t flags = ep & 0xE0;
+  ep &= 0x07;
+  const uint8_t* d = (const uint8_t*)data;
+  s.usbPending[ep].insert(s.usbPending[ep].end(), d, d + len);
+  if (flags & TRANSFER_RELEASE) {
+    s.usbPackets.push_back(sim::UsbPacket{(uint32_t)s.micros, ep, s.usbPending[ep]});
+    s.usbPending[ep].clear();
+  }
+  return len;
+}
+
+uint8_t USB_Available(uint8_t) {
+  size_t n = state().usbRx.size();
+  return (uint8_t)(n > USB_EP_SIZE ? USB_EP_SIZE : n);
+}
+
+int USB_Recv(uint8_t ep, void* data, int len) {
+  State& s = state();
+  uint8_t* d = (uint8_t*)data;
+  int n = 0;
+  while (n < len && !s.usbRx.empty()) {
+    d[n++] = s.usbRx.front();
+    s.usbRx.pop_front();
+  }
+  (void)ep;
+  return n;
+}
+
+int USB_Recv(uint8_t ep) {
+  uint8_t c;
+  return USB_Recv(ep, &c, 1) == 1 ? c : -1;
+}
+
+bool PluggableUSB_::plug(PluggableUSBModule* node) {
+  // the CDC serial interface uses the interfaces 0, 1 and the endpoints 1..3
+  node->pluggedInterface = 2;
+  node->pluggedEndpoint = 4;
+  return true;
+}
+
+PluggableUSB_& PluggableUSB() {
+  static PluggableUSB_ obj;
+  return obj;
+}
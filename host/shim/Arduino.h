@@ -0,0 +1,112 @@
+// Minimal Arduino core for the host build of the SpaceMouse firmware.
+// It provides just enough of the AVR Arduino API to compile the sources in spacemouse-keys/ unchanged.
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#include "Stream.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEFAULT 1
+#define EXTERNAL 0
+#define INTERNAL 3
+
+// analog pins of the ATmega32U4 (Leonardo / Pro Micro variant)
+#define A0 18
+#define A1 19
+#define A2 20
+#define A3 21
+#define A4 22
+#define A5 23
+#define A6 24
+#define A7 25
+#define A8 26
+#define A9 27
+#define A10 28
+#define A11 29
+#define NUM_DIGITAL_PINS 31
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+// min() and max() are macros on the AVR, templates here to keep std::min() and std::max() usable.
+// decay: with equal types the conditional is an lvalue, the result must not refer to the parameter
+template <class T, class U>
+auto min(T a, U b) -> typename std::decay<decltype(a < b ? a : b)>::type { return a < b ? a : b; }
+template <class T, class U>
+auto max(T a, U b) -> typename std::decay<decltype(a > b ? a : b)>::type { return a > b ? a : b; }
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define digitalPinToInterrupt(p) ((p) == 0 ? 2 : ((p) == 1 ? 3 : ((p) == 2 ? 1 : ((p) == 3 ? 0 : ((p) == 7 ? 4 : -1)))))
+
+#ifndef F_CPU
+#define F_CPU 16000000L
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+inline int toLowerCase(int c) { return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+
+class Serial_ : public Stream {
+ public:
+  void begin(unsigned long) {}
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int availableForWrite() override { return 64; }
+  using Print::write;
+  operator bool() { return true; }
+};
+extern Serial_ Serial;
+
+class USBDevice_ {
+ public:
+  bool isSuspended();
+};
+extern USBDevice_ USBDevice;
+
+#endif  // Arduino_h
@@ -0,0 +1,33 @@
+// EEPROM library for the host build, backed by the simulated EEPROM of the shim
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sim.h"
+
+struct EEPROMClass {
+  uint8_t read(int idx) { return sim::eeprom()[idx]; }
+  void write(int idx, uint8_t val) { sim::eeprom()[idx] = val; }
+  void update(int idx, uint8_t val) {
+    if (read(idx) != val) write(idx, val);
+  }
+  uint16_t length() { return 1024; }
+
+  template <typename T>
+  T& get(int idx, T& t) {
+    memcpy((void*)&t, sim::eeprom() + idx, sizeof(T));
+    return t;
+  }
+  template <typename T>
+  const T& put(int idx, const T& t) {
+    const uint8_t* ptr = (const uint8_t*)&t;
+    for (size_t i = 0; i < sizeof(T); i++) update(idx + (int)i, ptr[i]);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif  // EEPROM_h
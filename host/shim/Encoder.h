@@ -0,0 +1,21 @@
+// Encoder library (Paul Stoffregen) for the host build. The position is set by sim::setEncoder() or follows
+// the pin changes of sim::setInterruptPin() / sim::schedulePin().
+#ifndef Encoder_h_
+#define Encoder_h_
+
+#include <stdint.h>
+
+int32_t shimEncoderPosition();
+void shimEncoderPins(uint8_t pin1, uint8_t pin2);
+
+class Encoder {
+ public:
+  Encoder(uint8_t pin1, uint8_t pin2) { shimEncoderPins(pin1, pin2); }
+  int32_t read() { return shimEncoderPosition() + offset; }
+  void write(int32_t p) { offset = p - shimEncoderPosition(); }
+
+ private:
+  int32_t offset = 0;
+};
+
+#endif  // Encoder_h_
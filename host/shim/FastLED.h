@@ -0,0 +1,65 @@
+// FastLED library for the host build. show() takes the time the WS2811 transmission takes on the AVR,
+// where the interrupts are disabled during the transmission.
+#ifndef __INC_FASTSPI_LED2_H
+#define __INC_FASTSPI_LED2_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sim.h"
+
+struct CRGB {
+  uint8_t r, g, b;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+
+  typedef enum {
+    AntiqueWhite = 0xFAEBD7,
+    Black = 0x000000,
+    DarkBlue = 0x00008B,
+    DarkGrey = 0xA9A9A9,
+    DarkOliveGreen = 0x556B2F,
+    DarkRed = 0x8B0000,
+    Green = 0x008000,
+    Red = 0xFF0000,
+    SkyBlue = 0x87CEEB,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00
+  } HTMLColorCode;
+};
+
+enum EOrder { RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210 };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2811 {};
+
+class CFastLED {
+ public:
+  template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CFastLED& addLeds(CRGB* data, int nLeds) {
+    leds = data;
+    numLeds = nLeds;
+    return *this;
+  }
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  uint8_t getBrightness() { return brightness; }
+  void show() {
+    shows++;
+    sim::advanceMicros(30 * numLeds);  // 24 bit with 1.25 us each per LED
+  }
+  uint32_t showCount() { return shows; }
+  CRGB* leds = nullptr;
+  int numLeds = 0;
+
+ private:
+  uint8_t brightness = 255;
+  uint32_t shows = 0;
+};
+
+extern CFastLED FastLED;
+
+#endif  // __INC_FASTSPI_LED2_H
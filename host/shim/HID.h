@@ -0,0 +1,36 @@
+// HID definitions of the Arduino HID library for the host build
+#ifndef HID_h
+#define HID_h
+
+#include <stdint.h>
+
+#include <Arduino.h>
+#include "PluggableUSB.h"
+
+#define HID_GET_REPORT 0x01
+#define HID_GET_IDLE 0x02
+#define HID_GET_PROTOCOL 0x03
+#define HID_SET_REPORT 0x09
+#define HID_SET_IDLE 0x0A
+#define HID_SET_PROTOCOL 0x0B
+
+#define HID_HID_DESCRIPTOR_TYPE 0x21
+#define HID_REPORT_DESCRIPTOR_TYPE 0x22
+#define HID_PHYSICAL_DESCRIPTOR_TYPE 0x23
+
+#define HID_BOOT_PROTOCOL 0
+#define HID_REPORT_PROTOCOL 1
+
+typedef struct {
+  uint8_t len;
+  uint8_t dtype;
+  uint8_t addr;
+  uint8_t versionL;
+  uint8_t versionH;
+  uint8_t country;
+  uint8_t desctype;
+  uint8_t descLenL;
+  uint8_t descLenH;
+} HIDDescDescriptor;
+
+#endif  // HID_h
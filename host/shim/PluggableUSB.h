@@ -0,0 +1,106 @@
+// PluggableUSB and USB core API for the host build. The data sent to the endpoints is captured by the
+// shim and can be read with sim::usbPackets().
+#ifndef PUSB_h
+#define PUSB_h
+
+#include <stdint.h>
+
+#define USB_EP_SIZE 64
+#define TRANSFER_PGM 0x80
+#define TRANSFER_RELEASE 0x40
+#define TRANSFER_ZERO 0x20
+
+#define EP_TYPE_INTERRUPT_IN 0xC1
+#define EP_TYPE_INTERRUPT_OUT 0xC0
+
+#define USB_ENDPOINT_DIRECTION_MASK 0x80
+#define USB_ENDPOINT_OUT(addr) (lowByte((addr) | 0x00))
+#define USB_ENDPOINT_IN(addr) (lowByte((addr) | 0x80))
+#define USB_ENDPOINT_TYPE_INTERRUPT 0x03
+#define USB_DEVICE_CLASS_HUMAN_INTERFACE 0x03
+
+#define REQUEST_HOSTTODEVICE 0x00
+#define REQUEST_DEVICETOHOST 0x80
+#define REQUEST_STANDARD 0x00
+#define REQUEST_CLASS 0x20
+#define REQUEST_INTERFACE 0x01
+#define REQUEST_DEVICETOHOST_CLASS_INTERFACE (REQUEST_DEVICETOHOST | REQUEST_CLASS | REQUEST_INTERFACE)
+#define REQUEST_HOSTTODEVICE_CLASS_INTERFACE (REQUEST_HOSTTODEVICE | REQUEST_CLASS | REQUEST_INTERFACE)
+#define REQUEST_DEVICETOHOST_STANDARD_INTERFACE (REQUEST_DEVICETOHOST | REQUEST_STANDARD | REQUEST_INTERFACE)
+
+typedef struct {
+  uint8_t bmRequestType;
+  uint8_t bRequest;
+  uint8_t wValueL;
+  uint8_t wValueH;
+  uint16_t wIndex;
+  uint16_t wLength;
+} USBSetup;
+
+typedef struct {
+  uint8_t len;
+  uint8_t dtype;
+  uint8_t number;
+  uint8_t alternate;
+  uint8_t numEndpoints;
+  uint8_t interfaceClass;
+  uint8_t interfaceSubClass;
+  uint8_t protocol;
+  uint8_t iInterface;
+} InterfaceDescriptor;
+
+typedef struct {
+  uint8_t len;
+  uint8_t dtype;
+  uint8_t addr;
+  uint8_t attr;
+  uint16_t packetSize;
+  uint8_t interval;
+} __attribute__((packed)) EndpointDescriptor;
+
+#define D_INTERFACE(_n, _numEndpoints, _class, _subClass, _protocol) \
+  { 9, 4, _n, 0, _numEndpoints, _class, _subClass, _protocol, 0 }
+
+#define D_ENDPOINT(_addr, _attr, _packetSize, _interval) \
+  { 7, 5, _addr, _attr, _packetSize, _interval }
+
+int USB_SendControl(uint8_t flags, const void* d, int len);
+int USB_Send(uint8_t ep, const void* data, int len);
+int USB_Recv(uint8_t ep, void* data, int len);
+int USB_Recv(uint8_t ep);
+uint8_t USB_Available(uint8_t ep);
+
+class PluggableUSBModule {
+ public:
+  PluggableUSBModule(uint8_t numEps, uint8_t numIfs, uint8_t* epType)
+      : numEndpoints(numEps), numInterfaces(numIfs), endpointType(epType) {}
+  virtual ~PluggableUSBModule() {}
+
+ protected:
+  virtual bool setup(USBSetup& setup) = 0;
+  virtual int getInterface(uint8_t* interfaceCount) = 0;
+  virtual int getDescriptor(USBSetup& setup) = 0;
+  virtual uint8_t getShortName(char* name) {
+    name[0] = 'A' + pluggedInterface;
+    return 1;
+  }
+
+  uint8_t pluggedInterface = 0;
+  uint8_t pluggedEndpoint = 0;
+
+  const uint8_t numEndpoints;
+  const uint8_t numInterfaces;
+  const uint8_t* endpointType;
+
+  PluggableUSBModule* next = nullptr;
+
+  friend class PluggableUSB_;
+};
+
+class PluggableUSB_ {
+ public:
+  bool plug(PluggableUSBModule* node);
+};
+PluggableUSB_& PluggableUSB();
+
+#endif  // PUSB_h
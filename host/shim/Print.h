@@ -0,0 +1,55 @@
+// Minimal Print class of the Arduino core for the host build
+#ifndef PRINT_H
+#define PRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class __FlashStringHelper;
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char b, int base = DEC) { return print((unsigned long)b, base); }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println(const __FlashStringHelper* s) { return print(s) + println(); }
+  size_t println(const char* s) { return print(s) + println(); }
+  size_t println(char c) { return print(c) + println(); }
+  size_t println(unsigned char b, int base = DEC) { return print(b, base) + println(); }
+  size_t println(int n, int base = DEC) { return print(n, base) + println(); }
+  size_t println(unsigned int n, int base = DEC) { return print(n, base) + println(); }
+  size_t println(long n, int base = DEC) { return print(n, base) + println(); }
+  size_t println(unsigned long n, int base = DEC) { return print(n, base) + println(); }
+  size_t println(double n, int digits = 2) { return print(n, digits) + println(); }
+  size_t println() { return write("\r\n"); }
+
+ private:
+  size_t printNumber(unsigned long n, uint8_t base);
+};
+
+#endif  // PRINT_H
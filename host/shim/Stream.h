@@ -0,0 +1,30 @@
+// Minimal Stream class of the Arduino core for the host build
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() { return _timeout; }
+
+  long parseInt();
+  float parseFloat();
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+
+ protected:
+  // wait for the next character; on the host the timeout is spent on the virtual clock
+  int timedRead();
+  int timedPeek();
+  int peekNextDigit();
+
+  unsigned long _timeout = 1000;
+};
+
+#endif  // STREAM_H
@@ -0,0 +1,23 @@
+// Interrupt handling for the host build.
+// An ISR is an ordinary function, which is called by the simulated hardware in sim::advanceMicros().
+#ifndef INTERRUPT_H
+#define INTERRUPT_H
+
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#define EE_READY_vect shim_EE_READY_vect
+#define WDT_vect shim_WDT_vect
+#define TIMER1_OVF_vect shim_TIMER1_OVF_vect
+#define ADC_vect shim_ADC_vect
+
+extern "C" void shim_EE_READY_vect(void);
+extern "C" void shim_WDT_vect(void);
+extern "C" void shim_TIMER1_OVF_vect(void);
+extern "C" void shim_ADC_vect(void);
+
+void cli();
+void sei();
+#define interrupts() sei()
+#define noInterrupts() cli()
+
+#endif  // INTERRUPT_H
@@ -0,0 +1,76 @@
+// Simulated I/O registers of the ATmega32U4 for the host build.
+// Only registers used by the firmware are provided. Writing a register may trigger the simulated
+// peripheral (e.g. starting an EEPROM write).
+#ifndef IO_H
+#define IO_H
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+template <typename T>
+class ShimRegister {
+ public:
+  typedef void (*Hook)(T oldValue, T newValue);
+
+  explicit ShimRegister(Hook hook = nullptr) : value(0), onWrite(hook) {}
+  operator T() const { return value; }
+  ShimRegister& operator=(T v) { set(v); return *this; }
+  ShimRegister& operator|=(T v) { set(value | v); return *this; }
+  ShimRegister& operator&=(T v) { set(value & v); return *this; }
+  ShimRegister& operator^=(T v) { set(value ^ v); return *this; }
+  void poke(T v) { value = v; } // hardware side access, without triggering the hook
+
+ private:
+  void set(T v) {
+    T old = value;
+    value = v;
+    if (onWrite) onWrite(old, v);
+  }
+  volatile T value;
+  Hook onWrite;
+};
+
+typedef ShimRegister<uint8_t> ShimReg8;
+typedef ShimRegister<uint16_t> ShimReg16;
+
+// EEPROM
+extern ShimReg8 EECR;
+extern ShimReg16 EEAR;
+extern ShimReg8 EEDR;
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define EEPM0 4
+#define EEPM1 5
+#define E2END 0x3FF
+
+// watchdog timer, only the interrupt mode is simulated (see avr/wdt.h)
+extern ShimReg8 WDTCSR;
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+
+// Timer1 in normal mode: TCNT1 counts with the virtual clock and the prescaler of CS10..CS12 (see advanceMicros()),
+// an overflow sets TOV1 and calls TIMER1_OVF_vect with TOIE1. Writing 1 to TOV1 clears it, as on the hardware.
+extern ShimReg8 TCCR1A;
+extern ShimReg8 TCCR1B;
+extern ShimReg16 TCNT1;
+extern ShimReg8 TIMSK1;
+extern ShimReg8 TIFR1;
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define TOIE1 0
+#define TOV1 0
+
+// status register, only used to save and restore the interrupt state
+extern ShimReg8 SREG;
+
+#endif  // IO_H
@@ -0,0 +1,36 @@
+// Program memory access for the host build: flash and RAM are the same address space here.
+// PROGMEM data and PSTR() strings are placed in sections named .progmem*, so their size can be
+// measured with "size -A" (see progmem_report.py). Every string gets its own section, as with
+// -fdata-sections, so --gc-sections removes the unused ones like the AVR linker does.
+#ifndef PGMSPACE_H
+#define PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM __attribute__((section(".progmem.data")))
+#define PGM_P const char*
+#define PGM_SECTION_(n) ".progmem.str." #n
+#define PGM_SECTION(n) PGM_SECTION_(n)
+#define PSTR(s)                                                                   \
+  (__extension__({                                                                \
+    static const char __c[] __attribute__((section(PGM_SECTION(__COUNTER__)))) = (s); \
+    &__c[0];                                                                      \
+  }))
+
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+
+#endif  // PGMSPACE_H
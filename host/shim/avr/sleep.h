@@ -0,0 +1,22 @@
+// Sleep modes for the host build. sleep_cpu() advances the virtual clock to the next interrupt, which wakes the
+// CPU: the Timer0 overflow of millis() (the next full ms of the virtual clock, on the controller every 1024 us).
+// sim::sleepMicros() counts the time asleep. The mode is stored, but all modes are simulated like SLEEP_MODE_IDLE.
+#ifndef SLEEP_H
+#define SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+#define SLEEP_MODE_PWR_DOWN 2
+#define SLEEP_MODE_PWR_SAVE 3
+#define SLEEP_MODE_STANDBY 6
+#define SLEEP_MODE_EXT_STANDBY 7
+
+void set_sleep_mode(uint8_t mode);
+void sleep_enable();
+void sleep_disable();
+void sleep_cpu();
+#define sleep_mode() (sleep_enable(), sleep_cpu(), sleep_disable())
+
+#endif  // SLEEP_H
@@ -0,0 +1,12 @@
+// Watchdog timer for the host build. wdt_reset() restarts the timeout. In the interrupt mode (WDIE in WDTCSR)
+// WDT_vect is called by sim::advanceMicros() after each timeout without wdt_reset(). The system reset (WDE) is
+// not simulated.
+#ifndef WDT_H
+#define WDT_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+void wdt_reset();
+
+#endif  // WDT_H
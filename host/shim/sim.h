@@ -0,0 +1,87 @@
+// Control interface of the Arduino shim for the host build.
+//
+// The firmware sources are compiled unchanged against the shim. Everything that is hardware on the
+// Pro Micro (clock, ADC, pins, USB, serial, EEPROM) is simulated here and can be scripted by the
+// host programs through this interface.
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+// one USB transfer, collected from USB_Send() until TRANSFER_RELEASE
+struct UsbPacket {
+  uint32_t micros;           // virtual time, when the transfer was released
+  uint8_t endpoint;
+  std::vector<uint8_t> data;
+};
+
+// delivers the ADC value of an analog pin at the given virtual time
+typedef std::function<int(uint8_t pin, uint32_t micros)> AnalogSource;
+
+// Reset clock, inputs, outputs and EEPROM (EEPROM is erased to 0xFF)
+void reset();
+
+// Virtual clock. The clock only moves, when it is advanced by the host program, by delay(),
+// by analogRead() (conversion time) or by yield() in busy waits. Interrupts are dispatched
+// while the clock moves.
+uint32_t now();
+void advanceMicros(uint32_t us);
+
+// Time one analogRead() takes. The default is 13 ADC cycles at 125 kHz.
+void setAnalogReadMicros(uint32_t us);
+
+// Analog inputs: either a constant value per pin or a function of the virtual time
+void setAnalog(uint8_t pin, int value);
+void setAnalogSource(AnalogSource source);
+uint32_t analogReadCount();
+
+// Digital inputs and outputs
+void setDigital(uint8_t pin, int value);
+int getDigital(uint8_t pin);
+
+// Serial (CDC) interface
+void serialInput(const std::string& text);
+size_t serialInputPending();
+std::string takeSerialOutput();
+void setSerialEcho(bool echo); // copy serial output to stdout
+void setSerialMicrosPerByte(uint32_t us); // time Serial.write() takes per byte, default 0 (free)
+
+// USB interface
+std::vector<UsbPacket>& usbPackets();
+void usbReceive(const std::vector<uint8_t>& data); // data for the OUT endpoint (e.g. LED report)
+void setUsbSuspended(bool suspended);  // while suspended, USB_Send() fails with -1 (without the 250 ms timeout)
+
+// Sleep (avr/sleep.h): virtual time spent in sleep_cpu() and the number of sleeps since reset()
+uint64_t sleepMicros();
+uint32_t sleepCount();
+
+// EEPROM content (1024 bytes)
+uint8_t* eeprom();
+uint32_t eepromWriteCount();
+
+// Encoder library position
+void setEncoder(int32_t position);
+
+// Stack of the firmware: runOnStack() runs the function on a stack of stackSize() bytes in the shim, which is painted
+// like the RAM above .bss on the controller, so stackFreeMin() of the firmware works. paintStack() paints it again
+// below the caller, e.g. to measure a debug mode on its own. Without runOnStack() the firmware sees no free stack.
+void runOnStack(const std::function<void()>& body);
+void paintStack();
+uint32_t stackSize();
+
+// Pin change on an interrupt pin, calls the function registered with attachInterrupt(). Changes of the
+// pins of the Encoder library move its position like the interrupts of the library (4 counts per cycle).
+void setInterruptPin(uint8_t pin, int value);
+
+// Pin change at a virtual time: done by setInterruptPin(), when the clock reaches the time (e.g. during
+// analogRead()), so the interrupt routine sees micros() of the edge. Times in the past are done at once.
+void schedulePin(uint8_t pin, int value, uint32_t micros);
+
+}  // namespace sim
+
+#endif  // SIM_H
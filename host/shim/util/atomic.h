@@ -0,0 +1,12 @@
+// Atomic blocks for the host build: interrupts are only dispatched while the virtual clock moves,
+// so a block of code is always atomic.
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <stdint.h>
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (uint8_t _shimAtomicOnce = 1; _shimAtomicOnce; _shimAtomicOnce = 0)
+
+#endif  // ATOMIC_H
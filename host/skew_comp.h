@@ -0,0 +1,5 @@
+// Configuration for kinematics_bench_skew: the default configuration (spacemouse-keys/config.h) with the symmetric
+// sampling (SKEW_COMP), which is off there, so --motion compares all SKEW_MODEs.
+#include "../spacemouse-keys/config.h"
+#undef SKEW_COMP
+#define SKEW_COMP 1
@@ -0,0 +1,7 @@
+// Configuration for sched_bench_scheduler: the default configuration (spacemouse-keys/config.h) with the task
+// scheduler, which is off there, and without the idle mode, which needs the plain loop().
+#include "../spacemouse-keys/config.h"
+#undef TASK_SCHEDULER
+#define TASK_SCHEDULER 1
+#undef IDLE_MODE
+#define IDLE_MODE 0
@@ -0,0 +1,242 @@
+// Check of the EEPROM layout of the parameters (getParametersFromEEPROM(), putParametersToEEPROM()).
+//
+//   eeprom_check
+//
+// Cases with the simulated EEPROM and the background writer:
+// - migration: an EEPROM of layout 1 (MAGIC_NUMBER_V1) is read, converted in background and read again as layout 2,
+// - save during changes: the parameters change while the background writer runs, the EEPROM must hold the values
+//   of the start of the save with a valid CRC,
+// - busy (ENABLE_PROGMODE): >m, >i and >b answer PE_BUSY during a save at once, without waiting for the writer,
+// - corrupted EEPROM: a wrong magic, a newer version, a changed record (CRC), a wrong count of records and a length
+//   not ending at a record are refused, the parameters keep their values,
+// - out of range: a record with a valid CRC, but a value outside the limits (SENS_TX 0), keeps the actual value.
+// The exit code is 1, if a case fails.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include <util/crc16.h>
+
+#include "eepromWriter.h"
+#include "parameterMenu.h"
+#include "sim.h"
+
+extern ParamData par;
+
+static int failures = 0;
+
+// all parameters of two sets equal (FLOAT with the three decimals of the EEPROM)?
+static bool sameParameters(ParamStorage& a, ParamStorage& b) {
+  ParamData pa = par, pb = par;
+  pa.values = &a;
+  pb.values = &b;
+  for (int i = 1; i <= NUM_PARAMS; i++) {
+    for (uint8_t n = 0; n < paramCount(i, par); n++) {
+      if (fabs(readParameter(i, pa, n) - readParameter(i, pb, n)) > 0.0015) {
+        printf("  parameter %d[%u]: %g instead of %g\n", i, n, readParameter(i, pa, n), readParameter(i, pb, n));
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// a message was printed, as text or as token
+static bool logged(const std::string& out, uint8_t id, const char* text) {
+#if LOG_TOKENIZED > 0
+  (void)text;
+  return out.find(std::string() + (char)LOG_TOKEN_MARKER + (char)id) != std::string::npos;
+#else
+  (void)id;
+  return out.find(text) != std::string::npos;
+#endif
+}
+
+static void check(const char* name, bool ok) {
+  printf("%-44s %s\n", name, ok ? "ok" : "FAILED");
+  failures += ok ? 0 : 1;
+}
+
+// values within the limits of each parameter, which differ from the defaults of config.h
+static ParamStorage testValues(uint8_t seed) {
+  ParamStorage values;
+  ParamData p = par;
+  p.values = &values;
+  for (int i = 1; i <= NUM_PARAMS; i++) {
+    bool isFloat = pgm_read_byte(&par.description[i].type) == PARAM_TYPE_FLOAT;
+    double scale = isFloat ? PARAM_FIXED_SCALE : 1.0;
+    long min = lround(paramLimit(i, par, false) * scale);
+    long max = lround(paramLimit(i, par, true) * scale);
+    for (uint8_t n = 0; n < paramCount(i, par); n++) {
+      long value = min + (i * 7 + n * 3 + seed) % (max - min + 1);
+      if (value == lround(readParameter(i, p, n) * scale)) {
+        value = (value < max) ? value + 1 : min;
+      }
+      writeParameter(i, value / scale, p, n);
+    }
+  }
+  return values;
+}
+
+// reads the EEPROM into the defaults of config.h and returns the serial output
+static std::string load() {
+  *par.values = ParamStorage();
+  sim::takeSerialOutput();
+  getParametersFromEEPROM(par);
+  return sim::takeSerialOutput();
+}
+
+#if ENABLE_PROGMODE > 0
+// sends a ProgMode telegram and returns the reply, as loop() calls userInput() until the input is read
+static std::string progCommand(const char* telegram) {
+  double value;
+  sim::takeSerialOutput();
+  sim::serialInput(telegram);
+  while (sim::serialInputPending() > 0) {
+    if (userInput(value) == 10) {
+      executeProgCommand(par);
+    }
+  }
+  return sim::takeSerialOutput();
+}
+#endif
+
+static void save(ParamStorage& values) {
+  *par.values = values;
+  putParametersToEEPROM(par);
+  eepromWriterWait();
+}
+
+static ParamHeader& header() {
+  return *(ParamHeader*)(sim::eeprom() + BASE_ADDRESS_MAGIC);
+}
+
+// the CRC of the records, after the header was changed on purpose
+static void updateCrc() {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t address = BASE_ADDRESS_PAR; address < BASE_ADDRESS_PAR + header().length; address++) {
+    crc = _crc_ccitt_update(crc, sim::eeprom()[address]);
+  }
+  header().crc = crc;
+}
+
+int main() {
+  sim::reset();
+  ParamStorage defaults;
+  ParamStorage a = testValues(0), b = testValues(5);
+
+  // layout 1: magic and the first NUM_PARAMS_V1 parameters packed with BOOL=1, INT=2, FLOAT=4 bytes (float on AVR)
+  int32_t magicV1 = MAGIC_NUMBER_V1;
+  memcpy(sim::eeprom(), &magicV1, sizeof(magicV1));
+  uint8_t* data = sim::eeprom() + BASE_ADDRESS_PAR_V1;
+  ParamData pa = par;
+  pa.values = &a;
+  for (int i = 1; i <= NUM_PARAMS_V1; i++) {
+    uint8_t type = pgm_read_byte(&par.description[i].type);
+    double value = readParameter(i, pa);
+    if (type == PARAM_TYPE_BOOL) {
+      *data++ = (int8_t)value;
+    } else if (type == PARAM_TYPE_INT) {
+      int16_t v = (int16_t)value;
+      memcpy(data, &v, 2);
+      data += 2;
+    } else {
+      float f = value;
+      memcpy(data, &f, 4);
+      data += 4;
+    }
+  }
+  ParamStorage expected = defaults; // the parameters after layout 1 keep their defaults
+  ParamData pe = par;
+  pe.values = &expected;
+  for (int i = 1; i <= NUM_PARAMS_V1; i++) {
+    writeParameter(i, readParameter(i, pa), pe);
+  }
+  std::string out = load();
+  check("layout 1: migrated", logged(out, MSG_MIGRATING, "Migrating EEPROM!") && sameParameters(*par.values, expected));
+  eepromWriterWait();
+  out = load();
+  check("layout 1: read again as layout 2",
+        header().magic == MAGIC_NUMBER && header().version == PARAM_VERSION && out.empty() &&
+            sameParameters(*par.values, expected));
+
+  // save during changes: the background writer has to store the snapshot of the start
+  *par.values = a;
+  putParametersToEEPROM(par);
+  sim::advanceMicros(50000); // some bytes are written
+  for (int k = 0; k < 40 && eepromWriterBusy(); k++) {
+    *par.values = (k % 2) ? a : b;
+    par.values->transX_sensitivity = 1.2345 + k; // FLOAT with four decimals: another length of the record
+    sim::advanceMicros(20000);
+  }
+  eepromWriterWait();
+  out = load();
+  check("save during changes: values of the start", out.empty() && sameParameters(*par.values, a));
+
+  save(b);
+  out = load();
+  check("save: read back", out.empty() && sameParameters(*par.values, b));
+
+#if ENABLE_PROGMODE > 0
+  *par.values = a;
+  putParametersToEEPROM(par);
+  uint32_t start = sim::now();
+  std::string busy = progCommand(">m\r\n");
+  busy += progCommand(">i\r\n");
+  busy += progCommand(">b1=5;*0000\r\n");
+  bool unchanged = sameParameters(*par.values, a);
+  check("busy: >m, >i, >b answer at once",
+        busy == "<m10006\r\n<i10006\r\n<b10006\r\n" && unchanged && eepromWriterBusy() &&
+            sim::now() - start < 10000);
+  eepromWriterWait();
+  check("busy: >m after the save", progCommand(">m\r\n") == "<m" + std::to_string(MAGIC_NUMBER) + "\r\n");
+  out = load();
+  check("busy: save not disturbed", out.empty() && sameParameters(*par.values, a));
+  save(b);
+#endif
+
+  header().magic = 0x12345678;
+  out = load();
+  check("wrong magic: refused", logged(out, MSG_WRONG_MAGIC, "Wrong magic!") && sameParameters(*par.values, defaults));
+
+  save(b);
+  header().version = PARAM_VERSION + 1;
+  out = load();
+  check("newer version: refused",
+        logged(out, MSG_WRONG_VERSION, "Wrong version!") && sameParameters(*par.values, defaults));
+
+  save(b);
+  sim::eeprom()[BASE_ADDRESS_PAR + 3] ^= 0x01;
+  out = load();
+  check("changed record: refused", logged(out, MSG_WRONG_CRC, "Wrong CRC!") && sameParameters(*par.values, defaults));
+
+  save(b);
+  header().count--;
+  out = load();
+  check("wrong count: refused",
+        logged(out, MSG_WRONG_RECORDS, "Wrong records!") && sameParameters(*par.values, defaults));
+
+  save(b);
+  header().length--;
+  updateCrc();
+  out = load();
+  check("length within a record: refused",
+        logged(out, MSG_WRONG_RECORDS, "Wrong records!") && sameParameters(*par.values, defaults));
+
+  save(b);
+  uint16_t address = BASE_ADDRESS_PAR;
+  while (sim::eeprom()[address] != 2) { // record of SENS_TX
+    address += 2 + sim::eeprom()[address + 1];
+  }
+  memset(sim::eeprom() + address + 2, 0, sim::eeprom()[address + 1]);
+  updateCrc();
+  out = load();
+  ParamStorage expectedRange = b;
+  expectedRange.transX_sensitivity = defaults.transX_sensitivity;
+  check("value out of range: keeps the actual value", out.empty() && sameParameters(*par.values, expectedRange));
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+// Encoder wheel at different loop rates: the same turns of the wheel are replayed with the firmware running at
+// a slow and a fast loop rate, the zoom axis (ROTARY_AXIS) and the encoder keys (ROTARY_KEYS) are compared.
+//
+//   encoder_bench [<slow Hz> <fast Hz>]
+//
+// Default 300 and 3000 Hz. The loop rate is set by the conversion time of analogRead() and a pause after each
+// loop(). The quadrature edges come at their own virtual time (sim::schedulePin()), also during a loop pass:
+// rest, 6 detents forward at 10 detents/s, rest, 40 detents backward at 40 detents/s, rest (4 edges per detent,
+// 1 ms / 0.5 ms apart).
+//
+// Reported per rate: the integral of the zoom axis (counts * s) and its peak for each movement, the time the
+// encoder keys are pressed and the number of presses. The exit code is 1, if the integrals differ by more than
+// 5 % or the press times by more than two slow loop passes per press: the behaviour depends on the loop rate.
+// This is the case for the loop based engine (ENCODER_TIMED 0), encoder_bench_timed uses the time based one.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "pipeline.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+extern Frame frame;
+
+#if ROTARY_AXIS > 0 or ROTARY_KEYS > 0
+
+#define START_MICROS 200000UL  // rest before the first movement
+
+struct Movement {
+  uint32_t start;      // µs after the start of the replay
+  int detents;         // < 0: backward
+  uint32_t period;     // µs from detent to detent
+  uint32_t edgeGap;    // µs between the 4 edges of a detent
+};
+
+static const Movement movements[] = {
+    {START_MICROS, 6, 100000, 1000},
+    {START_MICROS + 1100000, -40, 25000, 500},
+};
+static const uint32_t endMicros = START_MICROS + 4300000;  // until the key presses of the spin have ended
+
+struct Result {
+  double integral[2] = {};  // zoom axis per movement, counts * s
+  int peak[2] = {};
+  double pressed[2] = {};   // key A / B in s
+  int presses[2] = {};
+  unsigned long passes = 0;
+};
+
+// edges of all movements: CLK / DT follow 11 -> 01 -> 00 -> 10 -> 11 forward and the reverse backward
+static void scheduleEdges(uint32_t origin) {
+  static const uint8_t cycle[4][2] = {{0, 1}, {0, 0}, {1, 0}, {1, 1}};
+  for (const Movement& m : movements) {
+    int steps = abs(m.detents) * 4;
+    for (int i = 0; i < steps; i++) {
+      // backward: the states of the cycle in reverse order, starting at 10
+      int state = m.detents > 0 ? i % 4 : (2 - i % 4 + 4) % 4;
+      uint32_t t = origin + m.start + (i / 4) * m.period + (i % 4) * m.edgeGap;
+      sim::schedulePin(ENCODER_CLK, cycle[state][0], t);
+      sim::schedulePin(ENCODER_DT, cycle[state][1], t);
+    }
+  }
+}
+
+// the firmware at the given loop rate, one record after each loop()
+static Result run(double hz) {
+  sim::reset();
+  sim::setAnalogSource([](uint8_t, uint32_t) { return 512; });
+  uint32_t period = (uint32_t)(1e6 / hz);
+  sim::setAnalogReadMicros(min(104U, period / 10));  // 8 conversions + pause
+  setup();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  uint32_t origin = sim::now();
+  scheduleEdges(origin);
+  Result r;
+  uint32_t last = origin;
+  bool wasPressed[2] = {};
+  while (sim::now() - origin < endMicros) {
+    uint32_t passStart = sim::now();
+    loop();
+    uint32_t used = sim::now() - passStart;
+    if (used < period) sim::advanceMicros(period - used);
+    uint32_t now = sim::now(), t = now - origin;
+    double dt = (now - last) / 1e6;  // the values hold until the next pass
+    last = now;
+    int movement = t < movements[1].start ? 0 : 1;
+#if ROTARY_AXIS > 0 && ROTARY_AXIS < 7
+    int zoom = frame.velocity[ROTARY_AXIS - 1];
+    r.integral[movement] += zoom * dt;
+    if (abs(zoom) > abs(r.peak[movement])) r.peak[movement] = zoom;
+#endif
+#if ROTARY_KEYS > 0 && ROTARY_KEY_IDX_A < NUMKEYS && ROTARY_KEY_IDX_B < NUMKEYS
+    const int keys[2] = {ROTARY_KEY_IDX_A, ROTARY_KEY_IDX_B};
+    for (int k = 0; k < 2; k++) {
+      bool pressed = frame.keyState[keys[k]] != 0;
+      if (pressed) r.pressed[k] += dt;
+      if (pressed && !wasPressed[k]) r.presses[k]++;
+      wasPressed[k] = pressed;
+    }
+#else
+    (void)wasPressed;
+#endif
+    r.passes++;
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  return r;
+}
+
+int main(int argc, char** argv) {
+  double rates[2] = {300, 3000};
+  if (argc == 3) {
+    rates[0] = atof(argv[1]);
+    rates[1] = atof(argv[2]);
+  }
+  if ((argc != 1 && argc != 3) || rates[0] <= 0 || rates[1] <= 0) {
+    fprintf(stderr, "usage: %s [<slow Hz> <fast Hz>]\n", argv[0]);
+    return 2;
+  }
+#ifdef ENCODER_TIMED
+  printf("ENCODER_TIMED %d, ", ENCODER_TIMED);
+#else
+  printf("loop based engine, ");
+#endif
+  printf("ROTARY_AXIS %d, ROTARY_KEYS %d\n", ROTARY_AXIS, ROTARY_KEYS);
+  Result r[2] = {run(rates[0]), run(rates[1])};
+
+  bool same = true;
+  printf("%-36s %14s %14s\n", "", "slow", "fast");
+  printf("%-36s %14.0f %14.0f\n", "loop rate [Hz]", rates[0], rates[1]);
+  printf("%-36s %14lu %14lu\n", "loop passes", r[0].passes, r[1].passes);
+#if ROTARY_AXIS > 0 && ROTARY_AXIS < 7
+  const char* names[2] = {"6 detents forward", "40 detents backward"};
+  for (int m = 0; m < 2; m++) {
+    printf("%-20s %-15s %14.2f %14.2f\n", names[m], "integral", r[0].integral[m], r[1].integral[m]);
+    printf("%-20s %-15s %14d %14d\n", "", "peak", r[0].peak[m], r[1].peak[m]);
+    double scale = fmax(fabs(r[0].integral[m]), fabs(r[1].integral[m]));
+    if (fabs(r[0].integral[m] - r[1].integral[m]) > 0.05 * scale) same = false;
+  }
+#endif
+#if ROTARY_KEYS > 0 && (ROTARY_KEY_IDX_A >= NUMKEYS || ROTARY_KEY_IDX_B >= NUMKEYS)
+  printf("ROTARY_KEY_IDX_A / ROTARY_KEY_IDX_B >= NUMKEYS: the encoder keys are outside of frame.keyState[], not compared\n");
+#elif ROTARY_KEYS > 0
+  const char* keyNames[2] = {"key A", "key B"};
+  for (int k = 0; k < 2; k++) {
+    printf("%-20s %-15s %14.3f %14.3f\n", keyNames[k], "pressed [s]", r[0].pressed[k], r[1].pressed[k]);
+    printf("%-20s %-15s %14d %14d\n", "", "presses", r[0].presses[k], r[1].presses[k]);
+    int presses = max(max(r[0].presses[k], r[1].presses[k]), 1);
+    if (fabs(r[0].pressed[k] - r[1].pressed[k]) > presses * 2 / rates[0]) same = false;
+  }
+#endif
+  printf("loop rate independent: %s\n", same ? "yes" : "no");
+  return same ? 0 : 1;
+}
+
+#else
+
+int main(int, char** argv) {
+  fprintf(stderr, "%s: the configuration has no encoder wheel (ROTARY_AXIS, ROTARY_KEYS)\n", argv[0]);
+  return 2;
+}
+
+#endif
@@ -0,0 +1,268 @@
+// Jitter and lag of the velocity filter (VEL_FILTER, parameters FILT_EN, FILT_CUT, FILT_BETA).
+//
+//   filter_bench <trace> | --model [--noise <counts>] [-s <id>=<value>[,<value>...]]...
+//
+// <trace>  sensor trace (see trace.h), replayed as with trace_replay
+// --model  movement of the sensor model (see sensor_model.h) instead of a trace: rest, slow TX sine at 0.5 Hz,
+//          TX held slightly deflected, fast RZ twist at 4 Hz, rest (7 s)
+// --noise  standard deviation of the ADC noise of the model in counts, default 0.8 (see sensor_model.h)
+// -s       changes a parameter before the start, as with trace_replay
+//
+// The input is run twice, with FILT_EN 0 and 1, velocity[] is recorded after each loop(). The reference is the
+// unfiltered velocity smoothed over +-20 ms (centered, so without lag). Reported per axis:
+//   jitter  RMS deviation from the reference, where the knob is nearly still: no axis of the reference changes
+//           faster than 200 counts/s for +-100 ms, so the turning points of a movement don't count
+//   lag     delay of the velocity behind the reference, where the axis moves fast (> 20 % of its maximum speed)
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <functional>
+#include <vector>
+
+#include "pipeline.h"
+#include "replay.h"
+#include "sensor_model.h"
+
+void setup();
+void loop();
+
+extern Frame frame;
+
+static const char* const axisName[6] = {"TX", "TY", "TZ", "RX", "RY", "RZ"};
+
+#define SMOOTH_MICROS 20000  // half width of the reference smoothing
+#define MAX_LAG_MICROS 60000
+#define STILL_MICROS 100000  // half width of the still test
+#define STILL_SPEED 200.0    // counts/s
+#define MOVING_SPEED 0.20
+
+struct Run {
+  std::vector<uint32_t> micros;
+  std::vector<int16_t> v[6];
+};
+
+static SensorModel model;
+static std::function<Pose(uint32_t)> motion;  // --model: pose at the time of each conversion
+static uint32_t motionStart;
+
+static int modelAnalog(uint8_t pin, uint32_t micros) {
+  replay::useSample(model.sample(motion(micros - motionStart), micros));
+  return replay::analog(pin, micros);
+}
+
+// rest, slow sine, slightly deflected, fast twist, rest
+static Pose modelPose(uint32_t micros) {
+  static double range[6];
+  if (range[0] == 0) {
+    for (int axis = 0; axis < 6; axis++) range[axis] = model.fullDeflection(axis);
+  }
+  double t = micros / 1e6;
+  if (t < 1.0) return Pose{};
+  if (t < 3.0) return Pose::axis(0, 0.2 * range[0] * sin(2 * M_PI * 0.5 * (t - 1.0)));
+  if (t < 4.0) return Pose::axis(0, 0.1 * range[0]);
+  if (t < 4.5) return Pose{};
+  if (t < 6.0) return Pose::axis(5, 0.2 * range[5] * sin(2 * M_PI * 4.0 * (t - 4.5)));
+  return Pose{};
+}
+
+// setup(), parameters, then the trace or the model with FILT_EN as given
+static bool run(const char* tracePath, const std::vector<const char*>& parameters, int8_t filter, Run& result) {
+  TraceReader trace;
+  uint32_t b = 0, n = 0;
+  TraceSample next = {};
+  bool haveNext = false;
+  if (tracePath) {
+    if (const char* fault = trace.open(tracePath)) {
+      fprintf(stderr, "%s: %s\n", tracePath, fault);
+      return false;
+    }
+    haveNext = trace.next(b, n, next);
+  }
+  sim::reset();
+  replay::install();
+  if (tracePath) {
+    replay::useSample(next);
+  } else {
+    motion = modelPose;
+    motionStart = sim::now();
+    sim::setAnalogSource(modelAnalog);
+  }
+  setup();
+  for (const char* p : parameters) {
+    if (!replay::setParameter(p)) {
+      fprintf(stderr, "invalid parameter or value: %s\n", p);
+      return false;
+    }
+  }
+  par.values->filterEnabled = filter;
+  par.changed = true;
+  replay::mapPins();
+  loop();  // take over the changed parameters
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  uint32_t offset = haveNext ? sim::now() - next.micros : 0;  // trace time -> virtual time
+  if (!tracePath) motionStart = sim::now();
+  while (tracePath ? haveNext : (uint32_t)(sim::now() - motionStart) < 7000000UL) {
+    if (tracePath) {
+      TraceSample current = next;
+      haveNext = trace.next(b, n, next);
+      uint32_t due = current.micros + offset;
+      if ((int32_t)(sim::now() - due) < 0) {
+        sim::advanceMicros(due - sim::now());
+      } else if (haveNext && (int32_t)(sim::now() - (next.micros + offset)) >= 0) {
+        continue;  // loop() is already behind the following sample
+      }
+      replay::useSample(current);
+    }
+    loop();
+    result.micros.push_back(sim::now());
+    for (int j = 0; j < 6; j++) result.v[j].push_back(frame.velocity[j]);
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  return true;
+}
+
+// centered moving average over +-SMOOTH_MICROS
+static std::vector<double> smooth(const Run& r, int axis) {
+  std::vector<double> out(r.micros.size());
+  size_t lo = 0, hi = 0;
+  double sum = 0;
+  for (size_t k = 0; k < r.micros.size(); k++) {
+    while (hi < r.micros.size() && r.micros[hi] <= r.micros[k] + SMOOTH_MICROS) sum += r.v[axis][hi++];
+    while (r.micros[lo] + SMOOTH_MICROS < r.micros[k]) sum -= r.v[axis][lo++];
+    out[k] = sum / (hi - lo);
+  }
+  return out;
+}
+
+struct AxisResult {
+  double jitter;  // counts RMS, < 0: no still part
+  double lag;     // ms, < 0: no moving part
+};
+
+// speed of the reference in counts/s, over +-SMOOTH_MICROS (over single passes it is mostly noise)
+static std::vector<double> speedOf(const Run& r, const std::vector<double>& ref) {
+  std::vector<double> speed(ref.size(), 0.0);
+  size_t lo = 0, hi = 0;
+  for (size_t k = 0; k < ref.size(); k++) {
+    while (hi + 1 < ref.size() && r.micros[hi + 1] <= r.micros[k] + SMOOTH_MICROS) hi++;
+    while (r.micros[lo] + SMOOTH_MICROS < r.micros[k]) lo++;
+    if (hi > lo) speed[k] = fabs(ref[hi] - ref[lo]) / ((r.micros[hi] - r.micros[lo]) / 1e6);
+  }
+  return speed;
+}
+
+// loop passes without a movement faster than limit on any axis within +-STILL_MICROS
+static std::vector<bool> stillPasses(const Run& r, const std::vector<double> (&speed)[6], double limit) {
+  size_t size = r.micros.size();
+  std::vector<bool> still(size, false);
+  std::vector<size_t> fast;  // passes with a faster movement, up to STILL_MICROS ahead
+  size_t lo = 0, hi = 0;
+  for (size_t k = 0; k < size; k++) {
+    while (hi < size && r.micros[hi] <= r.micros[k] + STILL_MICROS) {
+      for (int axis = 0; axis < 6; axis++) {
+        if (speed[axis][hi] >= limit) {
+          fast.push_back(hi);
+          break;
+        }
+      }
+      hi++;
+    }
+    while (lo < fast.size() && r.micros[fast[lo]] + STILL_MICROS < r.micros[k]) lo++;
+    still[k] = lo == fast.size();
+  }
+  return still;
+}
+
+static AxisResult evaluate(const Run& r, int axis, const std::vector<double>& ref, const std::vector<double>& speed,
+                           const std::vector<bool>& still) {
+  size_t size = min(r.micros.size(), ref.size());
+  double maxSpeed = 0;
+  for (size_t k = 0; k < size; k++) maxSpeed = fmax(maxSpeed, speed[k]);
+  AxisResult result = {-1, -1};
+  double squares = 0;
+  long stillCount = 0;
+  for (size_t k = 0; k < size; k++) {
+    if (still[k]) {
+      squares += (r.v[axis][k] - ref[k]) * (r.v[axis][k] - ref[k]);
+      stillCount++;
+    }
+  }
+  if (stillCount > 0) result.jitter = sqrt(squares / stillCount);
+
+  // delay with the smallest squared difference to the reference, in loop passes
+  double period = (r.micros[size - 1] - r.micros[0]) / (double)(size - 1);
+  int maxLag = (int)(MAX_LAG_MICROS / period);
+  double best = -1;
+  for (int lag = 0; lag <= maxLag && maxSpeed > 0; lag++) {
+    double error = 0;
+    long moving = 0;
+    for (size_t k = lag + 1; k + 1 < size; k++) {
+      if (speed[k - lag] > MOVING_SPEED * maxSpeed) {
+        error += (r.v[axis][k] - ref[k - lag]) * (r.v[axis][k] - ref[k - lag]);
+        moving++;
+      }
+    }
+    if (moving > 0 && (best < 0 || error / moving < best)) {
+      best = error / moving;
+      result.lag = lag * period / 1000;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  bool useModel = false;
+  std::vector<const char*> parameters;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      parameters.push_back(argv[++i]);
+    } else if (strcmp(argv[i], "--model") == 0) {
+      useModel = true;
+    } else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+      model.noise = atof(argv[++i]);
+    } else if (argv[i][0] != '-' && !tracePath) {
+      tracePath = argv[i];
+    } else {
+      tracePath = nullptr;
+      useModel = false;
+      break;
+    }
+  }
+  if (!tracePath == !useModel || VEL_FILTER == 0) {
+    fprintf(stderr, "usage: %s <trace> | --model [--noise <counts>] [-s <id>=<value>[,<value>...]]...\n", argv[0]);
+    if (VEL_FILTER == 0) fprintf(stderr, "the configuration has no velocity filter (VEL_FILTER)\n");
+    return 2;
+  }
+
+  Run off, on;
+  if (!run(tracePath, parameters, 0, off) || !run(tracePath, parameters, 1, on)) return 1;
+  std::vector<double> ref[6], speed[6];
+  for (int axis = 0; axis < 6; axis++) {
+    ref[axis] = smooth(off, axis);
+    speed[axis] = speedOf(off, ref[axis]);
+  }
+  std::vector<bool> still = stillPasses(off, speed, STILL_SPEED);
+  size_t stillCount = 0;
+  for (bool s : still) stillCount += s;
+  printf("%s, %zu loop passes (%zu still), FILT_CUT %.3f Hz, FILT_BETA %.3f Hz per 1000 counts/s\n",
+         tracePath ? tracePath : "sensor model", off.micros.size(), stillCount, par.values->filterMinCutoff,
+         par.values->filterBeta);
+  printf("axis   jitter off   jitter on  [counts RMS]    lag off      lag on  [ms]\n");
+  for (int axis = 0; axis < 6; axis++) {
+    AxisResult a = evaluate(off, axis, ref[axis], speed[axis], still);
+    AxisResult b = evaluate(on, axis, ref[axis], speed[axis], still);
+    printf("%-6s", axisName[axis]);
+    for (double v : {a.jitter, b.jitter}) v < 0 ? printf("%12s", "-") : printf("%12.2f", v);
+    printf("%14s", "");
+    for (double v : {a.lag, b.lag}) v < 0 ? printf("%12s", "-") : printf("%12.1f", v);
+    printf("\n");
+  }
+  return 0;
+}
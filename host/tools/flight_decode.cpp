@@ -0,0 +1,271 @@
+// Decodes the dump of the flight recorder (debug mode 73, see spacemouse-keys/flightRecorder.h).
+//
+//   flight_decode <input> [<csv>]
+//   flight_decode --sim jump|hid|manual [<csv>]
+//
+// <input> is either a file with the recorded serial data or the serial device of the SpaceMouse (e.g. /dev/ttyACM0).
+// The device is set to raw mode and "73" is sent, then the dump is read. The frames are printed oldest first, the
+// raw values are calculated backwards from the last frame, velocities are the recorded velocity / 4 times 4.
+// Flags: R HID report sent, D report failed, O offsets changed, C clipped (the raw value follows a step of more than
+// 127 with 127 per frame, or a velocity beyond +/-508), T trigger frame.
+// The optional CSV holds the same values, one line per frame.
+//
+// --sim runs the firmware in the shim (FLIGHT_RECORDER 1) with a scenario and dumps the recorder after it:
+//   jump    the first sensor jumps by 300 for 20 ms, expected trigger: velocity or offset
+//   hid     moving sensors, the host suspends the USB after 300 ms, expected trigger: HID
+//   manual  sensors at rest, no trigger before the dump
+// The exit code is 1, if there is no valid dump or the trigger isn't the expected one.
+#include <Arduino.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "flightRecorder.h"
+#include "parameterMenu.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+extern ParamData par;
+
+// CRC-16/MCRF4XX, as _crc_ccitt_update() on the AVR
+static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+  }
+  return crc;
+}
+
+struct Dump {
+  FlightHeader header;
+  std::vector<FlightRecord> records;
+};
+
+// looks for a complete dump in the serial data, returns 1 = found, 0 = incomplete, -1 = faulty
+static int findDump(const std::string& data, Dump& dump) {
+  size_t start = data.find("FREC");
+  if (start == std::string::npos || data.size() - start < sizeof(FlightHeader)) return 0;
+  memcpy(&dump.header, data.data() + start, sizeof(FlightHeader));
+  const FlightHeader& h = dump.header;
+  if (h.version != FLIGHT_VERSION || h.recordSize != sizeof(FlightRecord)) {
+    fprintf(stderr, "dump version %u, record size %u, expected %u, %zu\n", h.version, h.recordSize, FLIGHT_VERSION,
+            sizeof(FlightRecord));
+    return -1;
+  }
+  size_t len = sizeof(FlightHeader) + h.count * sizeof(FlightRecord);
+  if (data.size() - start < len + 2) return 0;
+  const uint8_t* bytes = (const uint8_t*)data.data() + start;
+  if (crc16(bytes, len) != (uint16_t)(bytes[len] | bytes[len + 1] << 8)) {
+    fprintf(stderr, "CRC fault\n");
+    return -1;
+  }
+  dump.records.resize(h.count);
+  if (h.count > 0) memcpy(dump.records.data(), bytes + sizeof(FlightHeader), h.count * sizeof(FlightRecord));
+  return 1;
+}
+
+static std::string triggerName(uint8_t trigger) {
+  std::string name;
+  if (trigger & FLIGHT_TRIG_VELOCITY) name += " velocity";
+  if (trigger & FLIGHT_TRIG_OFFSET) name += " offset";
+  if (trigger & FLIGHT_TRIG_HID) name += " HID";
+  if (trigger & FLIGHT_TRIG_CHORD) name += " chord";
+  if (trigger & FLIGHT_TRIG_MANUAL) name += " manual";
+  return name.empty() ? " none" : name;
+}
+
+static void printDump(const Dump& dump, FILE* csv) {
+  const FlightHeader& h = dump.header;
+  const int count = h.count;
+  // raw values and times backwards from the last frame
+  std::vector<std::vector<int>> raw(count, std::vector<int>(8));
+  std::vector<long> ms(count);
+  int trigger = -1;
+  for (int k = count - 1; k >= 0; k--) {
+    const FlightRecord& r = dump.records[k];
+    for (int i = 0; i < 8; i++) raw[k][i] = (k == count - 1) ? h.raw[i] : raw[k + 1][i] - dump.records[k + 1].rawDelta[i];
+    ms[k] = (k == count - 1) ? (long)h.millis : ms[k + 1] - dump.records[k + 1].dt;
+    if (r.flags & FLIGHT_REC_TRIGGER) trigger = k;
+  }
+
+  printf("trigger:%s, %d frames, last frame %u at %u ms\n", triggerName(h.trigger).c_str(), count, h.sequence, h.millis);
+  printf("offsets of the last frame:");
+  for (int i = 0; i < 8; i++) printf(" %d", h.offsets[i]);
+  printf("\n");
+  printf("%6s %7s %5s %-31s %-29s %4s\n", "frame", "ms", "flags", "raw", "velocity", "keys");
+  if (csv) {
+    fprintf(csv, "frame,ms,flags");
+    for (int i = 0; i < 8; i++) fprintf(csv, ",raw%d", i);
+    for (int i = 0; i < 6; i++) fprintf(csv, ",velocity%d", i);
+    fprintf(csv, ",keys\n");
+  }
+  for (int k = 0; k < count; k++) {
+    const FlightRecord& r = dump.records[k];
+    char flags[6] = "-----";
+    if (r.flags & FLIGHT_REC_REPORT) flags[0] = 'R';
+    if (r.flags & FLIGHT_REC_DROP) flags[1] = 'D';
+    if (r.flags & FLIGHT_REC_OFFSET) flags[2] = 'O';
+    if (r.flags & FLIGHT_REC_CLIPPED) flags[3] = 'C';
+    if (r.flags & FLIGHT_REC_TRIGGER) flags[4] = 'T';
+    int frame = (trigger >= 0) ? k - trigger : k - count + 1;  // relative to the trigger
+    long t = ms[k] - ((trigger >= 0) ? ms[trigger] : ms[count - 1]);
+    printf("%6d %7ld %5s", frame, t, flags);
+    for (int i = 0; i < 8; i++) printf(" %4d", raw[k][i]);
+    printf(" ");
+    for (int i = 0; i < 6; i++) printf(" %4d", r.velocity[i] * 4);
+    printf(" 0x%02x\n", r.keys);
+    if (csv) {
+      fprintf(csv, "%d,%ld,%u", frame, t, r.flags);
+      for (int i = 0; i < 8; i++) fprintf(csv, ",%d", raw[k][i]);
+      for (int i = 0; i < 6; i++) fprintf(csv, ",%d", r.velocity[i] * 4);
+      fprintf(csv, ",%u\n", r.keys);
+    }
+  }
+}
+
+// reads the dump from a file or from the device (after sending "73")
+static int readDump(const char* path, Dump& dump) {
+  FILE* in = fopen(path, "r+b");
+  if (!in) in = fopen(path, "rb");
+  if (!in) {
+    perror(path);
+    return -1;
+  }
+  bool device = isatty(fileno(in));
+  struct termios saved;
+  if (device) {
+    struct termios raw;
+    tcgetattr(fileno(in), &saved);
+    raw = saved;
+    cfmakeraw(&raw);
+    tcsetattr(fileno(in), TCSANOW, &raw);
+    if (write(fileno(in), "73\r", 3) != 3) perror("start dump");
+  }
+  std::string data;
+  int found = 0;
+  char buffer[4096];
+  while (found == 0) {
+    if (device) {  // the device doesn't end: wait at most 2 s for more data
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(fileno(in), &fds);
+      struct timeval timeout = {2, 0};
+      if (select(fileno(in) + 1, &fds, nullptr, nullptr, &timeout) <= 0) break;
+    }
+    ssize_t got = read(fileno(in), buffer, sizeof(buffer));
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) break;
+    data.append(buffer, got);
+    found = findDump(data, dump);
+  }
+  if (device) tcsetattr(fileno(in), TCSANOW, &saved);
+  fclose(in);
+  return found;
+}
+
+#if FLIGHT_RECORDER > 0
+static uint32_t scenarioStart;
+
+// runs the firmware with a scenario and dumps the recorder, returns the trigger, which is expected
+static int simulate(const std::string& scenario, Dump& dump, uint8_t& expected) {
+  static std::string name;
+  name = scenario;
+  if (scenario == "jump") {
+    expected = FLIGHT_TRIG_VELOCITY | FLIGHT_TRIG_OFFSET;
+  } else if (scenario == "hid") {
+    expected = FLIGHT_TRIG_HID;
+  } else if (scenario == "manual") {
+    expected = FLIGHT_TRIG_MANUAL;
+  } else {
+    return -1;
+  }
+  sim::reset();
+  scenarioStart = 0xFFFFFFFF;
+  sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+    if (us < scenarioStart) return 512;
+    uint32_t t = us - scenarioStart;
+    if (name == "jump") return (pin == par.values->pinList[0] && t >= 300000 && t < 320000) ? 812 : 512;
+    if (name == "hid") return 512 + (int)(200.0 * sin(t / 1e6 * (2.0 + 0.3 * pin)));
+    return 512;
+  });
+  setup();
+  sim::takeSerialOutput();
+  scenarioStart = sim::now();
+
+  while (sim::now() - scenarioStart < 600000) {
+    if (name == "hid" && sim::now() - scenarioStart >= 300000) sim::setUsbSuspended(true);
+    loop();
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  sim::setUsbSuspended(false);
+
+  sim::serialInput("73\r");
+  std::string out;
+  int found = 0;
+  for (uint32_t start = sim::now(); found == 0 && sim::now() - start < 1000000;) {
+    loop();
+    sim::usbPackets().clear();
+    out += sim::takeSerialOutput();
+    found = findDump(out, dump);
+  }
+  return found;
+}
+#endif
+
+int main(int argc, char** argv) {
+  bool simulation = argc > 2 && strcmp(argv[1], "--sim") == 0;
+  int csvArg = simulation ? 3 : 2;
+  if (argc < 2 || argc > csvArg + 1) {
+    fprintf(stderr, "usage: %s <input> [<csv>]\n       %s --sim jump|hid|manual [<csv>]\n", argv[0], argv[0]);
+    return 2;
+  }
+
+  Dump dump;
+  int found;
+  uint8_t expected = 0;
+  if (simulation) {
+#if FLIGHT_RECORDER > 0
+    found = simulate(argv[2], dump, expected);
+    if (found < 0 && expected == 0) {
+      fprintf(stderr, "unknown scenario %s\n", argv[2]);
+      return 2;
+    }
+#else
+    fprintf(stderr, "%s: the configuration has no flight recorder (FLIGHT_RECORDER)\n", argv[0]);
+    return 2;
+#endif
+  } else {
+    found = readDump(argv[1], dump);
+  }
+  if (found <= 0) {
+    fprintf(stderr, "no valid dump\n");
+    return 1;
+  }
+
+  FILE* csv = nullptr;
+  if (argc > csvArg) {
+    csv = fopen(argv[csvArg], "w");
+    if (!csv) {
+      perror(argv[csvArg]);
+      return 1;
+    }
+  }
+  printDump(dump, csv);
+  if (csv) fclose(csv);
+
+  if (simulation && (dump.header.trigger & expected) == 0) {
+    fprintf(stderr, "expected trigger:%s\n", triggerName(expected).c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Runs the firmware for a number of loop() iterations ("frames") against the shim and reports the
+// throughput of the host build and the virtual time per frame.
+//
+//   frames [frames] [--move]
+//
+// --move: the joysticks follow slow sine waves instead of resting in the center.
+//
+// The jitter of the virtual frame time (standard deviation, p99, max) shows blocking parts of loop(), e.g.
+// FastLED.show() of the LED ring (LEDRING): compare frames_c1_test_LED with frames_c2_test_LEDring. For the
+// LED ring the transmissions are counted and how many of them came in the same frame as a HID report.
+// With IDLE_MODE 1 the resting joysticks enter the idle mode after IDLE_AFTER_MS: most passes of loop() only sleep
+// until the next ms, see idle_bench.
+#include <Arduino.h>
+#include <FastLED.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "sim.h"
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+  long frames = 1000000;
+  bool move = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--move") == 0) {
+      move = true;
+    } else {
+      frames = atol(argv[i]);
+    }
+  }
+
+  sim::reset();
+  if (move) {
+    sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+      return 512 + (int)(300.0 * sin(us / 1e6 * (1.0 + 0.3 * pin)));
+    });
+  } else {
+    sim::setAnalogSource([](uint8_t, uint32_t) { return 512; });
+  }
+  setup();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  uint32_t startMicros = sim::now();
+  std::vector<uint32_t> frameMicros(frames);
+  unsigned long usbReports = 0;
+  uint32_t shows = FastLED.showCount(), showsWithReport = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long n = 0; n < frames; n++) {
+    uint32_t frameStart = sim::now();
+    size_t packets = sim::usbPackets().size();
+    uint32_t showsBefore = FastLED.showCount();
+    loop();
+    frameMicros[n] = sim::now() - frameStart;
+    if (FastLED.showCount() != showsBefore && sim::usbPackets().size() != packets) showsWithReport++;
+    if (sim::usbPackets().size() > 1000) {
+      usbReports += sim::usbPackets().size();
+      sim::usbPackets().clear();
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  usbReports += sim::usbPackets().size();
+  shows = FastLED.showCount() - shows;
+
+  double mean = frames > 0 ? (double)(sim::now() - startMicros) / frames : 0, squares = 0;
+  for (uint32_t us : frameMicros) squares += (us - mean) * (us - mean);
+  std::sort(frameMicros.begin(), frameMicros.end());
+  uint32_t p99 = frames > 0 ? frameMicros[(size_t)(0.99 * (frames - 1))] : 0;
+  uint32_t maxFrameMicros = frames > 0 ? frameMicros.back() : 0;
+
+  printf("frames:            %ld\n", frames);
+  printf("host frames/s:     %.0f\n", frames / seconds);
+  printf("virtual us/frame:  %.1f (max %u)\n", mean, maxFrameMicros);
+  printf("frame jitter:      sd %.1f us, p99 %u us, max %u us\n", frames > 0 ? sqrt(squares / frames) : 0.0, p99,
+         maxFrameMicros);
+  printf("USB reports:       %lu\n", usbReports);
+  printf("analogRead calls:  %u\n", sim::analogReadCount());
+  printf("asleep:            %.1f %% of the virtual time\n",
+         sim::now() > startMicros ? 100.0 * sim::sleepMicros() / (sim::now() - startMicros) : 0.0);
+#ifdef LEDRING
+  printf("LED ring shows:    %u (%u in a frame with a HID report)\n", shows, showsWithReport);
+#else
+  (void)showsWithReport;
+#endif
+  return 0;
+}
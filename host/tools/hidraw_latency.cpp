@@ -0,0 +1,180 @@
+// Reads the HID reports of a SpaceMouse from hidraw and measures their timing.
+//
+//   hidraw_latency [<hidraw>] [-n <reports>] [-s <sent.csv>]
+//
+// <hidraw> default: the first /dev/hidraw* with the VID/PID of the SpaceMouse (256f:c631), that is
+//          the virtual SpaceMouse of uhid_device or a real one
+// -n       stops after <reports> reports, default: Ctrl-C
+// -s       the send times written by uhid_device -l: the reports are matched by their content and
+//          order, the latency from the write to /dev/uhid to the read from hidraw is reported
+//
+// For each report ID the interval between the reports and its jitter (standard deviation) are printed.
+// The program needs no firmware, so it is built once.
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+static volatile sig_atomic_t stop = 0;
+
+static void onSignal(int) { stop = 1; }
+
+struct Report {
+  uint64_t nanos;    // CLOCK_MONOTONIC
+  std::string data;  // as hex
+};
+
+static uint64_t monotonicNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// first hidraw device with the VID/PID of the SpaceMouse, via sysfs
+static std::string findSpaceMouse() {
+  std::string found;
+  DIR* dir = opendir("/sys/class/hidraw");
+  if (!dir) return found;
+  while (struct dirent* entry = readdir(dir)) {
+    if (strncmp(entry->d_name, "hidraw", 6) != 0) continue;
+    std::string uevent = std::string("/sys/class/hidraw/") + entry->d_name + "/device/uevent";
+    FILE* f = fopen(uevent.c_str(), "r");
+    if (!f) continue;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+      if (strncmp(line, "HID_ID=", 7) == 0 && strstr(line, ":0000256F:0000C631")) {
+        found = std::string("/dev/") + entry->d_name;
+      }
+    }
+    fclose(f);
+    if (!found.empty()) break;
+  }
+  closedir(dir);
+  return found;
+}
+
+// prints mean, standard deviation, minimum, percentiles and maximum of values in µs
+static void printStatistics(const char* name, std::vector<double> values) {
+  if (values.empty()) return;
+  double sum = 0, squares = 0;
+  for (double v : values) sum += v;
+  double mean = sum / values.size();
+  for (double v : values) squares += (v - mean) * (v - mean);
+  std::sort(values.begin(), values.end());
+  auto percentile = [&](double p) { return values[(size_t)(p * (values.size() - 1))]; };
+  printf("  %-22s n=%-7zu mean %8.1f  jitter(sd) %7.1f  min %8.1f  p50 %8.1f  p99 %8.1f  max %8.1f us\n", name,
+         values.size(), mean, sqrt(squares / values.size()), values.front(), percentile(0.5), percentile(0.99),
+         values.back());
+}
+
+// latency of the received reports: each is matched to the next sent report with the same content
+static void printLatency(const char* path, const std::vector<Report>& received) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return;
+  }
+  std::vector<Report> sent;
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    char* comma = strchr(line, ',');
+    if (!comma) continue;
+    comma[strcspn(comma, "\r\n")] = 0;
+    sent.push_back({strtoull(line, nullptr, 10), comma + 1});
+  }
+  fclose(f);
+
+  const size_t window = 1000;  // reports searched ahead, reports lost by hidraw are skipped
+  std::vector<double> latency;
+  size_t next = 0;
+  unsigned long unmatched = 0;
+  for (const Report& r : received) {
+    size_t i = next;
+    while (i < sent.size() && i < next + window && (sent[i].data != r.data || sent[i].nanos > r.nanos)) i++;
+    if (i < sent.size() && i < next + window) {
+      latency.push_back((r.nanos - sent[i].nanos) / 1e3);
+      next = i + 1;
+    } else {
+      unmatched++;
+    }
+  }
+  printf("latency write /dev/uhid -> read hidraw (%lu reports not found in %s):\n", unmatched, path);
+  printStatistics("all reports", latency);
+}
+
+int main(int argc, char** argv) {
+  std::string path;
+  const char* sentPath = nullptr;
+  unsigned long maxReports = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      maxReports = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      sentPath = argv[++i];
+    } else if (argv[i][0] != '-' && path.empty()) {
+      path = argv[i];
+    } else {
+      fprintf(stderr, "usage: %s [<hidraw>] [-n <reports>] [-s <sent.csv>]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (path.empty()) path = findSpaceMouse();
+  if (path.empty()) {
+    fprintf(stderr, "no SpaceMouse (256f:c631) found in /sys/class/hidraw\n");
+    return 1;
+  }
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    perror(path.c_str());
+    return 1;
+  }
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = onSignal;  // without SA_RESTART, so read() returns
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+  fprintf(stderr, "reading %s, stop with Ctrl-C\n", path.c_str());
+
+  std::vector<Report> received;
+  uint8_t buffer[64];
+  while (!stop && (maxReports == 0 || received.size() < maxReports)) {
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    uint64_t nanos = monotonicNanos();
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) break;
+    Report r{nanos, std::string()};
+    char hex[3];
+    for (ssize_t i = 0; i < got; i++) {
+      snprintf(hex, sizeof(hex), "%02x", buffer[i]);
+      r.data += hex;
+    }
+    received.push_back(r);
+  }
+  close(fd);
+
+  std::map<std::string, uint64_t> last;  // per report ID
+  std::map<std::string, std::vector<double>> intervals;
+  std::vector<double> all;
+  for (size_t i = 0; i < received.size(); i++) {
+    std::string id = "report " + received[i].data.substr(0, 2);
+    if (last.count(id)) intervals[id].push_back((received[i].nanos - last[id]) / 1e3);
+    last[id] = received[i].nanos;
+    if (i > 0) all.push_back((received[i].nanos - received[i - 1].nanos) / 1e3);
+  }
+  printf("%zu reports from %s, interval between reports:\n", received.size(), path.c_str());
+  printStatistics("all reports", all);
+  for (auto& entry : intervals) printStatistics(entry.first.c_str(), entry.second);
+  if (sentPath) printLatency(sentPath, received);
+  return 0;
+}
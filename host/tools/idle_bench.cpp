@@ -0,0 +1,214 @@
+// Idle mode (IDLE_MODE 1) in the host build: time awake, conversions, estimated current and wake-up latency.
+//
+//   idle_bench [--active-ma <mA>] [--idle-ma <mA>]
+//
+// Built with host/idle_mode.h (config.h with IDLE_MODE 1), idle_bench_encoder with host/idle_mode_encoder.h (the
+// encoder wheel of testConfig/d_test_encoder.h). Phases with the virtual clock: moving joysticks, at rest before
+// IDLE_AFTER_MS, at rest in the idle mode and USB suspended. For each phase the conversions per second (8 per whole
+// frame, 1 per motion check in the idle mode), the HID reports and the time awake (not in sleep_cpu()) are counted.
+// The current is estimated from the time awake and asleep with the typical supply current of the ATmega32U4 at
+// 16 MHz and 5 V in the active and the idle mode (without the USB transfers, LEDs and the sensors of the board). In
+// the shim only analogRead() takes time, the calculations of a frame take none: on the unit the whole frames are
+// longer (see debug mode 72), so the idle mode saves more than shown here.
+//
+// Wake-up: 40 times at another phase of the idle mode (and 40 times before the idle mode as reference) all
+// joysticks step by +300, one sensor steps by +300 or, with an encoder wheel, the wheel turns by 4 counts. The
+// latency is the time from the step to the first HID report with the movement. The exit code is 1, if the idle mode
+// doesn't save current, a movement isn't reported within the motion checks until it is seen (1 for all sensors, 8
+// for one sensor), two frames and the report rate, or the sensing doesn't stop while the USB is suspended.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "idleMode.h"
+#include "parameterMenu.h"
+#include "sim.h"
+
+void setup();
+void loop();
+extern ParamData par;
+
+static const uint32_t HID_REPORT_US = 16000; // HIDUPDATERATE_MS of SpaceMouseHID.h
+static const uint32_t FRAME_US = 8 * 104;    // 8 conversions
+static const uint32_t SLEEP_US = 1024;       // longest sleep_cpu(): until the next Timer0 overflow
+static const uint32_t CHECK_US = SLEEP_US + 104; // a motion check: sleep and one conversion
+
+#if IDLE_MODE > 0
+static bool moving = false;
+static uint32_t stepAt = 0; // 0: at rest, else the joysticks are at +300 since this virtual time
+static int stepPin = -1;    // the pin, which steps, -1: all
+
+enum Step { ALL_SENSORS, ONE_SENSOR, ENCODER };
+
+struct Phase {
+  const char* name;
+  uint32_t us;
+  uint32_t conversions;
+  uint32_t reports;
+  uint64_t asleep;
+};
+
+// run loop() for the virtual time and count frames, reports and the time asleep
+static Phase runPhase(const char* name, uint32_t ms) {
+  uint32_t start = sim::now(), reads = sim::analogReadCount();
+  uint64_t asleep = sim::sleepMicros();
+  size_t reports = 0;
+  while (sim::now() - start < ms * 1000) {
+    loop();
+    reports += sim::usbPackets().size();
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  return Phase{name, sim::now() - start, sim::analogReadCount() - reads, (uint32_t)reports,
+               sim::sleepMicros() - asleep};
+}
+
+// a step of the joysticks or a turn of the encoder at rest: virtual time until the first HID report with values,
+// max. 1 s
+static uint32_t wakeUp(Step step) {
+  static int32_t encoder = 0;
+  stepAt = sim::now();
+  stepPin = (step == ONE_SENSOR) ? par.values->pinList[0] : -1;
+  if (step == ENCODER) {
+    stepAt = 0;
+    encoder += 4;
+    sim::setEncoder(encoder);
+  }
+  uint32_t start = sim::now();
+  uint32_t latency = 0;
+  while (latency == 0 && sim::now() - start < 1000000) {
+    loop();
+    for (const sim::UsbPacket& packet : sim::usbPackets()) {
+      bool values = packet.data.size() > 1 && packet.data[0] == 1 &&
+                    std::any_of(packet.data.begin() + 1, packet.data.end(), [](uint8_t b) { return b != 0; });
+      if (values && latency == 0) {
+        latency = packet.micros - start;
+      }
+    }
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  stepAt = 0;
+  stepPin = -1;
+  return latency;
+}
+
+// back to rest until the HID reports end
+static void settle() {
+  uint32_t start = sim::now();
+  while (sim::now() - start < 200000) {
+    loop();
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+}
+
+static void printLatencies(const char* name, std::vector<uint32_t>& latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  printf("%-30s n %zu  p50 %6.2f ms  max %6.2f ms\n", name, latencies.size(),
+         latencies[latencies.size() / 2] / 1000.0, latencies.back() / 1000.0);
+}
+#endif
+
+int main(int argc, char** argv) {
+#if IDLE_MODE > 0
+  double activeMilliAmps = 10.0, idleMilliAmps = 3.5; // typical values of the data sheet, 16 MHz, 5 V
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--active-ma") == 0) {
+      activeMilliAmps = atof(argv[i + 1]);
+    } else if (strcmp(argv[i], "--idle-ma") == 0) {
+      idleMilliAmps = atof(argv[i + 1]);
+    }
+  }
+
+  sim::reset();
+  sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+    if (moving) {
+      return 512 + (int)(300.0 * sin(us / 1e6 * (1.0 + 0.3 * pin)));
+    }
+    return (stepAt != 0 && us >= stepAt && (stepPin < 0 || stepPin == pin)) ? 812 : 512;
+  });
+  setup();
+  sim::takeSerialOutput();
+
+  std::vector<Phase> phases;
+  moving = true;
+  phases.push_back(runPhase("moving", 5000));
+  moving = false;
+  settle();
+  phases.push_back(runPhase("rest", IDLE_AFTER_MS - 400));
+  runPhase("", 400);
+  bool idleReached = isIdle();
+  phases.push_back(runPhase("rest, idle", 10000));
+  sim::setUsbSuspended(true);
+  phases.push_back(runPhase("USB suspended", 5000));
+  sim::setUsbSuspended(false);
+
+  printf("IDLE_AFTER_MS %d, IDLE_PERIOD_MS %d, current %.1f mA active, %.1f mA idle (estimated)\n", IDLE_AFTER_MS,
+         IDLE_PERIOD_MS, activeMilliAmps, idleMilliAmps);
+  printf("%-16s %13s %9s %8s %8s\n", "phase", "conversions/s", "reports/s", "awake", "mA");
+  double milliAmps[4];
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase& p = phases[i];
+    double seconds = p.us / 1e6, awake = 1.0 - (double)p.asleep / p.us;
+    milliAmps[i] = awake * activeMilliAmps + (1.0 - awake) * idleMilliAmps;
+    printf("%-16s %13.0f %9.1f %7.1f%% %8.2f\n", p.name, p.conversions / seconds, p.reports / seconds,
+           100.0 * awake, milliAmps[i]);
+  }
+
+  // wake-up at different phases of the idle frames and, as reference, before the idle mode
+  const Step steps[] = {ALL_SENSORS, ONE_SENSOR, ENCODER};
+  const char* const stepNames[] = {"all sensors", "one sensor", "encoder"};
+  const uint32_t checks[] = {1, 8, 1}; // motion checks until the movement is seen at the latest
+  bool ok = idleReached;
+  for (int k = 0; k < 3; k++) {
+#if ROTARY_AXIS == 0 && ROTARY_KEYS == 0
+    if (steps[k] == ENCODER) continue;
+#endif
+    std::vector<uint32_t> idleLatencies, activeLatencies;
+    bool allIdle = true;
+    for (int n = 0; n < 40; n++) {
+      settle();
+      runPhase("", IDLE_AFTER_MS + n * (IDLE_PERIOD_MS * 1000 / 40) / 1000 + 1); // phase to the whole frames
+      allIdle = allIdle && isIdle();
+      sim::advanceMicros(n * 37 % 1000);  // phase within the ms
+      idleLatencies.push_back(wakeUp(steps[k]));
+      settle();
+      activeLatencies.push_back(wakeUp(steps[k]));
+    }
+    std::string name = std::string("wake-up, idle, ") + stepNames[k];
+    printLatencies(name.c_str(), idleLatencies);
+    name = std::string("wake-up, not idle, ") + stepNames[k];
+    printLatencies(name.c_str(), activeLatencies);
+    ok = ok && allIdle;
+    uint32_t limit = checks[k] * CHECK_US + 2 * FRAME_US + HID_REPORT_US;
+    if (idleLatencies.front() == 0 || idleLatencies.back() > limit) {
+      fprintf(stderr, "wake-up by %s slower than %u us\n", stepNames[k], limit);
+      ok = false;
+    }
+  }
+
+  if (!idleReached) {
+    fprintf(stderr, "the idle mode wasn't entered after IDLE_AFTER_MS\n");
+  }
+  if (milliAmps[2] >= milliAmps[1]) {
+    fprintf(stderr, "the idle mode saves no current\n");
+    ok = false;
+  }
+  if (phases[3].conversions != 0) {
+    fprintf(stderr, "%u conversions while the USB was suspended\n", phases[3].conversions);
+    ok = false;
+  }
+  return ok ? 0 : 1;
+#else
+  (void)argc;
+  fprintf(stderr, "%s: the configuration has no idle mode (IDLE_MODE)\n", argv[0]);
+  return 2;
+#endif
+}
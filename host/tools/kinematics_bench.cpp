@@ -0,0 +1,482 @@
+// Kinematic accuracy benchmark: the sensor model (see sensor_model.h) turns commanded poses of the
+// knob into ADC counts, the firmware runs its complete loop() on them and the HID reports are evaluated.
+//
+//   kinematics_bench [-s <id>=<value>[,<value>...]]... [--as-configured] [--noise <counts>] [--pivot <mm>]
+//                    [--calibrate] [--cost] [--linear-map] [--motion <Hz>]
+//
+// Each axis is swept alone over its full deflection (where the first sensor changes by 330 counts, see
+// SensorModel::fullDeflection()), for every pose loop() runs until a HID report had the chance to follow.
+// Reported per axis:
+//   cross-talk   peak output of the other axes in % of the peak output of the swept axis, and that peak in % of
+//                full scale: a swept axis with a small peak inflates the percentages (HES RX/RY at pivot 8 mm reach
+//                17 % of full scale, their end stop is set by the sensors of TY/TX, which see the sideways shift)
+//   linearity    largest deviation of the swept axis from its straight line fit in % of full scale (350),
+//                only outputs between deadzone and saturation are fitted
+//   resolution   movement per output count (slope of the fit) and the noise: standard deviation of the
+//                output at a held half deflection, also as movement
+//
+// --motion moves each axis sinusoidally with <Hz> over half its full deflection instead of holding poses: every
+// conversion of readAllFromJoystick() sees the knob at its own time, so the sensors are converted at different
+// moments as on the Pro Micro. Reported is the cross-talk during the movement, with SKEW_COMP for each SKEW_MODE.
+//
+// The measurement profile calibrates MINVALS/MAXVALS (and with LIN_TABLE the linearization LINTABLE, as debug
+// mode 20 does) to the model, sets all sensitivities to 2 (full
+// deflection = full scale) and switches off the parts that hide the kinematics: MODFUNC 0 (linear), no
+// drift compensation, no gates, no exclusive mode, no axis switching. --as-configured keeps config.h,
+// -s changes parameters afterwards, as in trace_replay.
+//
+// KIN_MATRIX builds:
+//   --calibrate  runs the guided calibration of the decoupling matrix (debug mode 21) first: the model moves each
+//                axis back and forth, when the firmware asks for it, the sweeps then use the fitted matrix
+//   --cost       times calculateKinematic() with the fixed factors and with the matrix on the centered values of the
+//                sweeps (host CPU, ns per call, the best of 5 rounds) and counts the multiplications of the matrix.
+//                The host divides in hardware, the ATmega32U4 calls the floating point library for the 6 divisions
+//   --exclusive  resistive joysticks: checks on the centered values of the sweeps that the exclusive mode (EXCLUSIVE)
+//                makes the rotations of the matrix zero where it does with the fixed factors, exit code 1 if not
+//                (kinematics_bench_resistive)
+//
+// LIN_TABLE builds:
+//   --linear-map keeps the linear LINTABLE (the two straight lines of map()) for comparison
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "calibration.h"
+#include "kinematics.h"
+#include "pipeline.h"
+
+#include "replay.h"
+#include "sensor_model.h"
+
+void setup();
+void loop();
+
+static const char* const axisName[6] = {"TX", "TY", "TZ", "RX", "RY", "RZ"};
+static double axisRange[6];  // full deflection of the model in mm or degrees
+static const char* const axisUnit[6] = {"mm", "mm", "mm", "deg", "deg", "deg"};
+#if KIN_MATRIX == 0
+static const char* const matrixOptions = "";
+#elif defined(HALLEFFECT)
+static const char* const matrixOptions = " [--calibrate] [--cost]";
+#else
+static const char* const matrixOptions = " [--calibrate] [--cost] [--exclusive]";
+#endif
+
+#define SWEEP_STEPS 61
+#define POSE_MICROS 20000   // time per pose, longer than the HID report interval
+#define NOISE_MICROS 500000 // time of the noise measurement
+#define MOTION_PERIODS 4    // periods of --motion, after one period to settle
+#define FULL_SCALE 350
+
+static SensorModel model;
+static Pose pose;          // actual pose of the knob
+static std::function<Pose(uint32_t)> motion;  // --motion: pose at the time of each conversion
+static int16_t report[6];  // values of the last HID report 1
+
+extern Frame frame;                         // of the sketch: centered[] is the input of kinematicStage() in the last loop()
+static std::vector<std::vector<int>> inputs;  // centered[] of all sweep steps, for --cost
+
+// analogRead() of the firmware: new noise for each pass of readAllFromJoystick(), which reads the first sensor first
+// or, with motion, for each conversion at its time
+static int modelAnalog(uint8_t pin, uint32_t micros) {
+  if (motion) {
+    replay::useSample(model.sample(motion(micros), micros));
+  } else if (pin == par.values->pinList[0]) {
+    replay::useSample(model.sample(pose, micros));
+  }
+  return replay::analog(pin, micros);
+}
+
+static void measurementProfile(bool linearize) {
+  // MINVALS and MAXVALS from the full deflections of all axes, as found by debug mode 20
+  double rest[8], v[8];
+  model.ideal(Pose{}, rest);
+  for (int i = 0; i < 8; i++) {
+    par.values->minVals[i] = -1;
+    par.values->maxVals[i] = 1;
+  }
+  for (int axis = 0; axis < 6; axis++) {
+    for (int sign = -1; sign <= 1; sign += 2) {
+      model.ideal(Pose::axis(axis, sign * axisRange[axis]), v);
+      for (int i = 0; i < 8; i++) {
+        par.values->minVals[i] = min((int)par.values->minVals[i], (int)floor(v[i] - rest[i]));
+        par.values->maxVals[i] = max((int)par.values->maxVals[i], (int)ceil(v[i] - rest[i]));
+      }
+    }
+  }
+#if LIN_TABLE > 0
+  if (linearize) fitLinearTable(par);
+#else
+  (void)linearize;
+#endif
+  // the kinematics sum up 4 (TX, TY, RX, RY) or 8 sensors (TZ, RZ) to +-700 at full deflection
+  par.values->transX_sensitivity = 2.0;
+  par.values->transY_sensitivity = 2.0;
+  par.values->pos_transZ_sensitivity = 2.0;
+  par.values->neg_transZ_sensitivity = 2.0;
+  par.values->rotX_sensitivity = 2.0;
+  par.values->rotY_sensitivity = 2.0;
+  par.values->rotZ_sensitivity = 2.0;
+  par.values->modFunc = 0;
+  par.values->compEnabled = 0;
+  par.values->gate_neg_transZ = 0;
+  par.values->gate_rotX = 0;
+  par.values->gate_rotY = 0;
+  par.values->gate_rotZ = 0;
+  par.values->exclusiveMode = 0;
+  par.values->switchXY = 0;
+  par.values->switchYZ = 0;
+  par.changed = true;
+}
+
+// runs loop() with the pose for the given time, calls sample() after each pass
+template <typename F>
+static void hold(const Pose& held, uint32_t micros, F sample) {
+  pose = held;
+  uint32_t start = sim::now();
+  while ((uint32_t)(sim::now() - start) < micros) {
+    loop();
+    for (const sim::UsbPacket& packet : sim::usbPackets()) {
+      if (packet.data.size() == 13 && packet.data[0] == 1) memcpy(report, &packet.data[1], sizeof(report));
+    }
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+    sample();
+  }
+}
+
+struct AxisResult {
+  double crossTalk[6];  // %
+  double peak;          // largest unsaturated output of the swept axis, % of full scale
+  double linearity;     // % of full scale
+  double slope;         // counts per mm or degree
+  double noise;         // counts
+};
+
+static AxisResult measureAxis(int axis) {
+  AxisResult result = {};
+  std::vector<double> command;
+  std::vector<int16_t> output[6];
+  hold(Pose{}, POSE_MICROS, [] {});
+  for (int step = 0; step < SWEEP_STEPS; step++) {
+    double value = axisRange[axis] * (2.0 * step / (SWEEP_STEPS - 1) - 1.0);
+    hold(Pose::axis(axis, value), POSE_MICROS, [] {});
+    command.push_back(value);
+    for (int j = 0; j < 6; j++) output[j].push_back(report[j]);
+    inputs.push_back(std::vector<int>(frame.centered, frame.centered + 8));
+  }
+
+  // straight line fit of the swept axis between deadzone and saturation
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (size_t k = 0; k < command.size(); k++) {
+    int y = output[axis][k];
+    if (y == 0 || abs(y) >= FULL_SCALE) continue;
+    n++;
+    sx += command[k];
+    sy += y;
+    sxx += command[k] * command[k];
+    sxy += command[k] * y;
+  }
+  double slope = 0, intercept = 0;
+  if (n >= 2 && n * sxx - sx * sx > 0) {
+    slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    intercept = (sy - slope * sx) / n;
+  }
+  result.slope = slope;
+  int peak = 0;
+  for (size_t k = 0; k < command.size(); k++) {
+    int y = output[axis][k];
+    if (abs(y) >= FULL_SCALE) continue;
+    peak = max(peak, abs(y));
+    if (y != 0) result.linearity = fmax(result.linearity, fabs(y - (slope * command[k] + intercept)));
+  }
+  result.linearity *= 100.0 / FULL_SCALE;
+  result.peak = 100.0 * peak / FULL_SCALE;
+
+  // cross-talk: in the part of the sweep, where the swept axis is not saturated
+  for (int j = 0; j < 6; j++) {
+    int leak = 0;
+    for (size_t k = 0; k < command.size(); k++) {
+      if (abs(output[axis][k]) < FULL_SCALE) leak = max(leak, (int)abs(output[j][k]));
+    }
+    result.crossTalk[j] = peak > 0 ? 100.0 * leak / peak : 0;
+  }
+
+  // noise at half deflection, after the reports have followed the pose
+  double sum = 0, squares = 0;
+  long count = 0;
+  hold(Pose::axis(axis, axisRange[axis] / 2), POSE_MICROS, [] {});
+  hold(Pose::axis(axis, axisRange[axis] / 2), NOISE_MICROS, [&] {
+    sum += report[axis];
+    squares += (double)report[axis] * report[axis];
+    count++;
+  });
+  double mean = sum / count;
+  result.noise = sqrt(fmax(0.0, squares / count - mean * mean));
+  return result;
+}
+
+// cross-talk in % of the moved axis, while it moves sinusoidally over half its deflection
+static void measureMotion(int axis, double hz, double* crossTalk) {
+  uint32_t start = sim::now();
+  double amplitude = axisRange[axis] / 2;
+  motion = [=](uint32_t micros) { return Pose::axis(axis, amplitude * sin(2 * M_PI * hz * (micros - start) / 1e6)); };
+  uint32_t period = (uint32_t)(1e6 / hz);
+  int peak[6] = {};
+  hold(Pose{}, period, [] {});
+  hold(Pose{}, MOTION_PERIODS * period, [&] {
+    for (int j = 0; j < 6; j++) peak[j] = max(peak[j], (int)abs(report[j]));
+  });
+  motion = nullptr;
+  hold(Pose{}, POSE_MICROS, [] {});
+  for (int j = 0; j < 6; j++) crossTalk[j] = peak[axis] > 0 ? 100.0 * peak[j] / peak[axis] : 0;
+}
+
+#if KIN_MATRIX > 0
+// debug mode 21: moves the announced axis sinusoidally over its full deflection while the firmware records
+static bool calibrateMatrix() {
+  sim::serialInput("21\r");
+  std::string text;
+  int axis = -1;
+  bool moving = false;
+  uint32_t moveStart = 0;
+  for (uint32_t start = sim::now(); (uint32_t)(sim::now() - start) < 120000000u;) {
+    pose = moving ? Pose::axis(axis, axisRange[axis] * sin(2 * M_PI * (sim::now() - moveStart) / 1e6)) : Pose{};
+    loop();
+    sim::usbPackets().clear();
+    text += sim::takeSerialOutput();
+    if (text.find("Next axis") != std::string::npos) {
+      axis++;
+      moving = false;
+      text.clear();
+    } else if (text.find("move now") != std::string::npos) {
+      moving = true;
+      moveStart = sim::now();
+      text.clear();
+    } else if (text.find("Stop moving") != std::string::npos) {
+      moving = false;
+    }
+    if (text.find("EEPROM") != std::string::npos || text.find("restart") != std::string::npos ||
+        text.find("unchanged") != std::string::npos) {
+      printf("calibration (debug mode 21):\n%s\n", text.substr(text.find("Stop moving")).c_str());
+      return par.values->kinMatrixEnabled == 1;
+    }
+  }
+  return false;
+}
+
+// ns per calculateKinematic() call on the host CPU, one round
+static double costOfKinematic(int8_t matrix) {
+  int8_t enabled = par.values->kinMatrixEnabled;
+  par.values->kinMatrixEnabled = matrix;
+  int values[8];
+  int16_t velocity[6];
+  long checksum = 0, calls = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < 2000; repeat++) {
+    for (const std::vector<int>& input : inputs) {
+      memcpy(values, input.data(), sizeof(values));
+      calculateKinematic(values, velocity, par, micros());
+      checksum += velocity[0] + velocity[5];
+      calls++;
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  par.values->kinMatrixEnabled = enabled;
+  if (checksum == 1) printf(" ");  // keeps the calls
+  return seconds * 1e9 / calls;
+}
+
+#ifndef HALLEFFECT
+// rotations of calculateKinematic() with the fixed factors or the matrix, with or without the exclusive mode
+static void rotationsOf(const std::vector<int>& input, int8_t matrix, int8_t exclusive, int16_t* rotations) {
+  int8_t enabled = par.values->kinMatrixEnabled, mode = par.values->exclusiveMode;
+  par.values->kinMatrixEnabled = matrix;
+  par.values->exclusiveMode = exclusive;
+  int values[8];
+  int16_t velocity[6];
+  memcpy(values, input.data(), sizeof(values));
+  calculateKinematic(values, velocity, par, micros());
+  par.values->kinMatrixEnabled = enabled;
+  par.values->exclusiveMode = mode;
+  memcpy(rotations, &velocity[ROTX], 3 * sizeof(int16_t));
+}
+
+// a z-move of the exclusive mode: at least 3 of the 4 joysticks up (or down) and none the other way
+static bool isZMove(const std::vector<int>& input) {
+  int up = 0, down = 0;
+  for (int i : {AX, BX, CX, DX}) {
+    up += input[i] > 0;
+    down += input[i] < 0;
+  }
+  return (up >= 3 && down == 0) || (down >= 3 && up == 0);
+}
+
+// with EXCLUSIVE the matrix has to zero the rotations of the z-moves, as the fixed factors do, and keep all others
+static bool checkExclusive() {
+  int zMoves = 0, wrong = 0;
+  const int16_t zero[3] = {0, 0, 0};
+  for (const std::vector<int>& input : inputs) {
+    int16_t fixedOn[3], matrixOn[3], matrixOff[3];
+    rotationsOf(input, 0, 1, fixedOn);
+    rotationsOf(input, 1, 1, matrixOn);
+    rotationsOf(input, 1, 0, matrixOff);
+    if (isZMove(input)) {
+      zMoves++;
+      if (memcmp(fixedOn, zero, sizeof(zero)) != 0 || memcmp(matrixOn, zero, sizeof(zero)) != 0) wrong++;
+    } else if (memcmp(matrixOn, matrixOff, sizeof(matrixOn)) != 0) {
+      wrong++;
+    }
+  }
+  printf("\nexclusive mode with the matrix: %d of %zu sweep steps are a z-move, %d wrong\n", zMoves, inputs.size(),
+         wrong);
+  return zMoves > 0 && wrong == 0;
+}
+#endif
+#endif
+
+int main(int argc, char** argv) {
+  bool asConfigured = false, linearize = true;
+#if KIN_MATRIX > 0
+  bool calibrate = false, cost = false;
+#endif
+#if KIN_MATRIX > 0 && !defined(HALLEFFECT)
+  bool exclusive = false;
+#endif
+  double motionHz = 0;
+  const char* parameters[NUM_PARAMS];
+  int numParameters = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc && numParameters < NUM_PARAMS) {
+      parameters[numParameters++] = argv[++i];
+    } else if (strcmp(argv[i], "--as-configured") == 0) {
+      asConfigured = true;
+#if KIN_MATRIX > 0
+    } else if (strcmp(argv[i], "--calibrate") == 0) {
+      calibrate = true;
+    } else if (strcmp(argv[i], "--cost") == 0) {
+      cost = true;
+#ifndef HALLEFFECT
+    } else if (strcmp(argv[i], "--exclusive") == 0) {
+      exclusive = true;
+#endif
+#endif
+    } else if (strcmp(argv[i], "--linear-map") == 0 && LIN_TABLE > 0) {
+      linearize = false;
+    } else if (strcmp(argv[i], "--motion") == 0 && i + 1 < argc) {
+      motionHz = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+      model.noise = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--pivot") == 0 && i + 1 < argc) {
+      model.pivot = atof(argv[++i]);
+    } else {
+      fprintf(stderr,
+              "usage: %s [-s <id>=<value>[,<value>...]]... [--as-configured] [--noise <counts>] [--pivot <mm>]"
+              " [--motion <Hz>]%s%s\n",
+              argv[0], matrixOptions, LIN_TABLE > 0 ? " [--linear-map]" : "");
+      return 2;
+    }
+  }
+  model.calibrate();
+  for (int axis = 0; axis < 6; axis++) axisRange[axis] = model.fullDeflection(axis);
+
+  sim::reset();
+  replay::install();
+  sim::setAnalogSource(modelAnalog);
+  setup(); // calibrates the centers at rest
+  if (!asConfigured) measurementProfile(linearize);
+  for (int i = 0; i < numParameters; i++) {
+    if (!replay::setParameter(parameters[i])) {
+      fprintf(stderr, "invalid parameter or value: %s\n", parameters[i]);
+      return 1;
+    }
+  }
+  replay::mapPins();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+#if KIN_MATRIX > 0
+  if (calibrate && !calibrateMatrix()) {
+    fprintf(stderr, "calibration of the decoupling matrix failed\n");
+    return 1;
+  }
+#endif
+
+#ifdef HALLEFFECT
+  printf("model: hall sensors, magnetic dipoles, pivot %.1f mm, noise %.1f counts\n", model.pivot, model.noise);
+#else
+  printf("model: resistive joysticks, pivot %.1f mm, noise %.1f counts\n", model.pivot, model.noise);
+#endif
+  printf("profile: %s%s%s\n", asConfigured ? "as configured" : "measurement (linear, no compensation/gates/exclusive)",
+         LIN_TABLE > 0 && linearize && !asConfigured ? ", linearization" : "",
+         par.values->kinMatrixEnabled == 1 && KIN_MATRIX > 0 ? ", decoupling matrix" : "");
+  printf("full deflection:");
+  for (int axis = 0; axis < 6; axis++) printf(" %s %.2f %s", axisName[axis], axisRange[axis], axisUnit[axis]);
+  printf("\n\n");
+
+  AxisResult results[6];
+  for (int axis = 0; axis < 6; axis++) results[axis] = measureAxis(axis);
+
+  printf("cross-talk [%% of the swept axis]\nswept ");
+  for (int j = 0; j < 6; j++) printf("%8s", axisName[j]);
+  printf("  peak[%%FS]\n");
+  for (int axis = 0; axis < 6; axis++) {
+    printf("%-6s", axisName[axis]);
+    for (int j = 0; j < 6; j++) printf("%8.1f", results[axis].crossTalk[j]);
+    printf("%11.1f\n", results[axis].peak);
+  }
+  printf("\naxis  linearity[%%FS]  counts/unit  resolution        noise[counts]  noise as movement\n");
+  for (int axis = 0; axis < 6; axis++) {
+    const AxisResult& r = results[axis];
+    double unitPerCount = r.slope != 0 ? 1.0 / fabs(r.slope) : 0;
+    printf("%-6s%14.2f%13.1f%10.4f %-3s/cnt%15.2f%12.4f %s\n", axisName[axis], r.linearity, fabs(r.slope),
+           unitPerCount, axisUnit[axis], r.noise, r.noise * unitPerCount, axisUnit[axis]);
+  }
+  if (motionHz > 0) {
+    int mode = par.values->skewMode, first = SKEW_COMP > 0 ? 0 : mode, last = SKEW_COMP > 0 ? 2 : mode;
+    printf("\ncross-talk during motion, %.1f Hz over half the deflection [%% of the moved axis]\nmoved SKEW_MODE", motionHz);
+    for (int j = 0; j < 6; j++) printf("%8s", axisName[j]);
+    printf("\n");
+    for (int axis = 0; axis < 6; axis++) {
+      for (int m = first; m <= last; m++) {
+        par.values->skewMode = m;
+        par.changed = true;
+        double crossTalk[6];
+        measureMotion(axis, motionHz, crossTalk);
+        printf("%-6s%9d", axisName[axis], m);
+        for (int j = 0; j < 6; j++) printf("%8.1f", crossTalk[j]);
+        printf("\n");
+      }
+    }
+    par.values->skewMode = mode;
+    par.changed = true;
+  }
+#if KIN_MATRIX > 0
+  bool failed = false;
+#ifndef HALLEFFECT
+  if (exclusive && !checkExclusive()) failed = true;
+#endif
+  if (cost) {
+    double fixed = 1e9, matrix = 1e9;
+    for (int round = 0; round < 5; round++) {  // alternating, the best round of each
+      fixed = min(fixed, costOfKinematic(0));
+      matrix = min(matrix, costOfKinematic(1));
+    }
+    int terms = 0;
+    for (uint8_t row = TRANSX; row <= ROTZ; row++) terms += kinematicMatrixTerms(row);
+    printf("\ncalculateKinematic() on the host: fixed factors %.1f ns, matrix %.1f ns per call (%.0f %%)\n", fixed,
+           matrix, 100.0 * matrix / fixed);
+    printf("matrix: %d multiplications of 8 by 16 bit per call (%d when TZ is negative) instead of the sums and 6 "
+           "floating point divisions\n", terms, terms + kinematicMatrixTerms(6));
+  }
+  return failed ? 1 : 0;
+#else
+  return 0;
+#endif
+}
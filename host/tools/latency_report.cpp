@@ -0,0 +1,109 @@
+// Latency statistics of the firmware (debug mode 75, LATENCY_STATS 1) in the host build, checked against the
+// latency, which the shim sees.
+//
+//   latency_report [seconds]
+//
+// The sensors step between the center and +300 every 200 ms. For each step the shim notes the first analogRead()
+// after the step and the first report of the translations and rotations after it with other values than the report
+// before: the time in between is the motion to report latency, as the host would see it (without the USB polling).
+// After 1 s to settle, debug mode 75 clears the statistics. After the given virtual time (default 10 s) debug mode
+// 75 prints the statistics of the firmware, which must not be shorter than those of the shim: the frame starts before
+// the sensors are read. The exit code is 1, if the output is missing or the firmware reports a shorter maximum than
+// the shim.
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "latency.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+static const uint32_t STEP_PERIOD_US = 200000;
+
+int main(int argc, char** argv) {
+#if LATENCY_STATS > 0
+  double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+
+  static uint32_t edge = 0;     // number of the last step, whose first sample is known
+  static uint32_t sampled = 0;  // virtual time of the first sample after the step
+  sim::reset();
+  sim::setAnalogSource([](uint8_t, uint32_t us) {
+    uint32_t n = us / STEP_PERIOD_US;
+    if (n != edge) {
+      edge = n;
+      sampled = us;
+    }
+    return (n % 2 == 1) ? 812 : 512;
+  });
+  setup();
+
+  // 1 s to settle after the zeroing in setup(), then debug mode 75 clears the statistics of the firmware
+  for (uint32_t settle = sim::now(); sim::now() - settle < 1000000;) {
+    loop();
+  }
+  sim::serialInput("75\r");
+  while (sim::serialInputPending() > 0) {
+    loop();
+  }
+  loop();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  std::vector<uint32_t> latencies;
+  std::vector<uint8_t> lastReport;
+  uint32_t countedEdge = edge;
+  uint32_t start = sim::now();
+  while (sim::now() - start < seconds * 1e6) {
+    loop();
+    for (const sim::UsbPacket& packet : sim::usbPackets()) {
+      if (packet.data.empty() || packet.data[0] != 1) {
+        continue;  // keys
+      }
+      if (packet.data != lastReport && edge != countedEdge && packet.micros >= sampled) {
+        latencies.push_back(packet.micros - sampled);
+        countedEdge = edge;
+      }
+      lastReport = packet.data;
+    }
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+
+  sim::serialInput("75\r");
+  std::string out;
+  for (int n = 0; n < 100 && out.find("motion to report") == std::string::npos; n++) {
+    loop();
+    out += sim::takeSerialOutput();
+  }
+  out += sim::takeSerialOutput();
+  printf("%s", out.c_str());
+
+  std::sort(latencies.begin(), latencies.end());
+  uint32_t shimMax = latencies.empty() ? 0 : latencies.back();
+  printf("shim, step -> report us: n %zu p50 %u max %u\n", latencies.size(),
+         latencies.empty() ? 0 : latencies[latencies.size() / 2], shimMax);
+
+  size_t pos = out.find("motion to report");
+  size_t maxPos = (pos == std::string::npos) ? pos : out.find(" max ", pos);
+  if (maxPos == std::string::npos) {
+    fprintf(stderr, "missing: motion to report\n");
+    return 1;
+  }
+  unsigned long firmwareMax = strtoul(out.c_str() + maxPos + 5, nullptr, 10);
+  if (firmwareMax < shimMax) {
+    fprintf(stderr, "the firmware reports a shorter maximum (%lu us) than the shim (%u us)\n", firmwareMax, shimMax);
+    return 1;
+  }
+  return 0;
+#else
+  (void)argc;
+  fprintf(stderr, "%s: the configuration has no latency statistics (LATENCY_STATS)\n", argv[0]);
+  return 2;
+#endif
+}
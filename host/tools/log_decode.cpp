@@ -0,0 +1,141 @@
+// Decodes the serial output of a firmware built with LOG_TOKENIZED 1 (see spacemouse-keys/logMessages.h).
+//
+//   log_decode [<input>]
+//
+// Every token (LOG_TOKEN_MARKER and the number of the message) is replaced by the text of the
+// message, all other bytes are passed through unchanged. The names of the parameters are taken from
+// the parameter table of the firmware, which is linked in full text (see log_fulltext.h).
+//
+// <input> is a file with the recorded serial data, default is stdin. If <input> is the serial device
+// of the SpaceMouse (e.g. /dev/ttyACM0), log_decode works as terminal: the keys are sent to the
+// SpaceMouse and its output is decoded, Ctrl-] ends the terminal.
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "parameterMenu.h"
+
+extern ParamData par;
+
+#define LOG_TEXT(id) id##_T,
+static const char* const messages[] = {LOG_MESSAGES(LOG_TEXT)};
+#undef LOG_TEXT
+
+#define KEY_QUIT 0x1D  // Ctrl-]
+
+class Decoder {
+ public:
+  void feed(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) feed(data[i]);
+    fflush(stdout);
+  }
+
+ private:
+  enum { TEXT, ID, PARAM } state = TEXT;
+  uint8_t id = 0;
+
+  void feed(uint8_t c) {
+    switch (state) {
+      case TEXT:
+        if (c == LOG_TOKEN_MARKER) {
+          state = ID;
+        } else {
+          putchar(c);
+        }
+        break;
+      case ID:
+        id = c;
+        if (id == MSG_PARAM_NAME || id == MSG_PARAM_NAME_PAD) {
+          state = PARAM;
+        } else {
+          if (id < NUM_LOG_MESSAGES) {
+            fputs(messages[id], stdout);
+          } else {
+            printf("<unknown message %u>", id);
+          }
+          state = TEXT;
+        }
+        break;
+      case PARAM:
+        if (c <= NUM_PARAMS) {
+          printf(messages[id], par.description[c].name);
+        } else {
+          printf("<unknown parameter %u>", c);
+        }
+        state = TEXT;
+        break;
+    }
+  }
+};
+
+int main(int argc, char** argv) {
+  int in = STDIN_FILENO;
+  if (argc > 1) {
+    in = open(argv[1], O_RDWR | O_NOCTTY);
+    if (in < 0) in = open(argv[1], O_RDONLY);
+    if (in < 0) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+  Decoder decoder;
+  uint8_t buffer[4096];
+
+  if (!isatty(in) || in == STDIN_FILENO) {
+    for (;;) {
+      ssize_t got = read(in, buffer, sizeof(buffer));
+      if (got < 0 && errno == EINTR) continue;
+      if (got <= 0) break;
+      decoder.feed(buffer, got);
+    }
+    return 0;
+  }
+
+  // terminal: device and keyboard in raw mode
+  struct termios savedDevice, savedKeys, raw;
+  tcgetattr(in, &savedDevice);
+  raw = savedDevice;
+  cfmakeraw(&raw);
+  tcsetattr(in, TCSANOW, &raw);
+  bool keys = isatty(STDIN_FILENO);
+  if (keys) {
+    tcgetattr(STDIN_FILENO, &savedKeys);
+    raw = savedKeys;
+    cfmakeraw(&raw);
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    fprintf(stderr, "connected, quit with Ctrl-]\r\n");
+  }
+
+  struct pollfd fds[2] = {{in, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+  bool running = true;
+  while (running) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t got = read(in, buffer, sizeof(buffer));
+      if (got <= 0) break;
+      decoder.feed(buffer, got);
+    }
+    if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t got = read(STDIN_FILENO, buffer, sizeof(buffer));
+      if (got <= 0) break;
+      uint8_t* quit = (uint8_t*)memchr(buffer, KEY_QUIT, got);
+      if (quit) {
+        got = quit - buffer;
+        running = false;
+      }
+      if (got > 0 && write(in, buffer, got) != got) perror("write");
+    }
+  }
+
+  if (keys) tcsetattr(STDIN_FILENO, TCSANOW, &savedKeys);
+  tcsetattr(in, TCSANOW, &savedDevice);
+  close(in);
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Debug mode 72 (micro-benchmark, MICRO_BENCH 1) in the host build: selects the mode over the serial interface and
+// prints the output of the firmware.
+//
+//   micro_bench --check
+//
+// The cycle counts are AVR-only: the shim counts TCNT1 with the virtual clock, in which only analogRead() takes
+// time, so every calculation would show 0 cycles. Without --check the tool refuses to run (exit code 2), run debug
+// mode 72 on the unit instead. --check runs the benchmark for its side effects and prints the names of the lines
+// without the cycles: all lines must be there, and the HID reports sent during the benchmark may only carry zero
+// values and no keys. The exit code is 1, if a line is missing or a report isn't zero.
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "microBench.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+#if MICRO_BENCH > 0
+  if (argc != 2 || strcmp(argv[1], "--check") != 0) {
+    fprintf(stderr,
+            "%s: the cycle counts of debug mode 72 are AVR-only, the shim has no cycle model of the calculations.\n"
+            "Run debug mode 72 on the unit, or '%s --check' for the lines and the HID reports only.\n",
+            argv[0], argv[0]);
+    return 2;
+  }
+  sim::reset();
+  sim::setAnalogSource([](uint8_t, uint32_t) { return 512; });
+  setup();
+  sim::takeSerialOutput();
+
+  sim::serialInput("72\r");
+  sim::usbPackets().clear();
+  std::string out;
+  size_t reports = 0, nonZero = 0;
+  uint32_t start = sim::now();
+  for (int after = 0; after < 20 && sim::now() - start < 2000000; ) {  // 20 passes after the last line
+    loop();
+    out += sim::takeSerialOutput();
+    for (const sim::UsbPacket& packet : sim::usbPackets()) {
+      reports++;
+      for (size_t i = 1; i < packet.data.size(); i++) {  // behind the report id
+        if (packet.data[i] != 0) {
+          nonZero++;
+          break;
+        }
+      }
+    }
+    sim::usbPackets().clear();
+    if (out.find("EEPROM.update, write") != std::string::npos) after++;
+  }
+  const char* lines[] = {"analogRead", "readAllFromJoystick", "modifierFunction", "FilterAnalogReadOuts",
+                         "calculateKinematic", "send_command, no report", "send_command, report due",
+                         "EEPROM.update, same", "EEPROM.update, write"};
+  bool complete = true;
+  for (const char* line : lines) {
+    bool found = out.find(line) != std::string::npos;
+    printf("%-28s %s\n", line, found ? "ok" : "missing");
+    complete = complete && found;
+  }
+  printf("HID reports: %zu, not zero: %zu\n", reports, nonZero);
+  return complete && nonZero == 0 ? 0 : 1;
+#else
+  (void)argc;
+  fprintf(stderr, "%s: the configuration has no micro-benchmark (MICRO_BENCH)\n", argv[0]);
+  return 2;
+#endif
+}
@@ -0,0 +1,101 @@
+// Fuzzer for the serial interface (debug menu, parameter menu and ProgMode parser).
+//
+//   progmode_fuzz [iterations] [seed]
+//
+// Feeds random telegrams built from the ProgMode alphabet to the firmware and checks after each one,
+// that the firmware returns to loop() and every parameter stays within its limits from paramDescription.
+// Built with clang and -fsanitize=fuzzer (option FUZZER_LIBFUZZER) the same check is used by libFuzzer.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <string>
+
+#include "parameterMenu.h"
+#include "sim.h"
+
+void setup();
+void loop();
+extern ParamData par;
+
+static void init() {
+  static bool done = false;
+  if (!done) {
+    sim::reset();
+    sim::setAnalogSource([](uint8_t, uint32_t) { return 512; });
+    setup();
+    done = true;
+  }
+}
+
+// returns the number of the first parameter out of its limits, 0 if all are valid
+static int checkParameters() {
+  for (int i = 1; i <= NUM_PARAMS; i++) {
+    for (uint8_t n = 0; n < paramCount(i, par); n++) {
+      double value = readParameter(i, par, n);
+      double scale = (pgm_read_byte(&par.description[i].type) == PARAM_TYPE_FLOAT) ? PARAM_FIXED_SCALE : 1.0;
+      double min = paramLimit(i, par, false);
+      double max = paramLimit(i, par, true);
+      if (value < min - 0.5 / scale || value > max + 0.5 / scale) return i;
+    }
+  }
+  return 0;
+}
+
+// runs one telegram, returns false, if the check fails. The input has to be consumed within 60 s virtual time,
+// calcMinMax() (debug mode 20) doesn't read the serial interface for 20 s, calcKinematicMatrix() (21) for 54 s.
+static bool runTelegram(const std::string& telegram) {
+  sim::serialInput(telegram);
+  uint32_t start = sim::now();
+  while (sim::serialInputPending() > 0 && (uint32_t)(sim::now() - start) < 60000000UL) {
+    loop();
+  }
+  loop();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+  return sim::serialInputPending() == 0 && checkParameters() == 0;
+}
+
+#ifdef FUZZER_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  init();
+  if (!runTelegram(std::string((const char*)data, size))) abort();
+  return 0;
+}
+#else
+int main(int argc, char** argv) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 100000;
+  unsigned seed = (argc > 2) ? atoi(argv[2]) : 1;
+  static const char alphabet[] = ">>>>ptdrwlscmnieaxbk0123456789-.=;,*:\r\nqQ\x1b ";
+  std::mt19937 rng(seed);
+
+  init();
+  // the parameter data must be valid from the beginning, otherwise the check is meaningless
+  if (int i = checkParameters()) {
+    printf("parameter %d out of limits after setup()\n", i);
+    return 1;
+  }
+  for (long it = 0; it < iterations; it++) {
+    std::string telegram;
+    int len = 1 + rng() % 24;
+    for (int n = 0; n < len; n++) {
+      telegram += alphabet[rng() % (sizeof(alphabet) - 1)];
+    }
+    telegram += '\r';
+    if (!runTelegram(telegram)) {
+      std::string escaped;
+      for (char c : telegram) {
+        char hex[5];
+        snprintf(hex, sizeof(hex), "\\x%02x", (uint8_t)c);
+        escaped += isprint(c) ? std::string(1, c) : std::string(hex);
+      }
+      printf("iteration %ld: check failed after \"%s\" (parameter %d)\n", it, escaped.c_str(), checkParameters());
+      return 1;
+    }
+  }
+  printf("%ld telegrams, virtual time %.1f s, all parameters within limits\n", iterations, sim::now() / 1e6);
+  return 0;
+}
+#endif
@@ -0,0 +1,68 @@
+// Feeds the samples of a sensor trace (see trace.h) to the firmware of the host build.
+// analogRead() sees the raw values of the actual sample on the pins of PINLIST, with the inversion of
+// INVERTLIST undone, and the keys of KEYLIST are set to the key bits of the sample.
+// Used by trace_replay and uhid_device, each tool is a single translation unit.
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parameterMenu.h"
+#include "sim.h"
+#include "trace.h"
+
+extern ParamData par;
+
+namespace replay {
+
+static TraceSample current;  // sample seen by analogRead() and the keys
+static int8_t sensorOfPin[NUM_DIGITAL_PINS];
+
+// analogRead() of the firmware: find the sensor on that pin and undo the inversion of readAllFromJoystick()
+static int analog(uint8_t pin, uint32_t) {
+  int8_t i = sensorOfPin[pin % NUM_DIGITAL_PINS];
+  if (i < 0) return 0;
+  return (par.values->invertList[i] == 1) ? 1023 - current.raw[i] : current.raw[i];
+}
+
+// call after PINLIST changed
+static void mapPins() {
+  memset(sensorOfPin, -1, sizeof(sensorOfPin));
+  for (int i = 0; i < 8; i++) sensorOfPin[par.values->pinList[i] % NUM_DIGITAL_PINS] = i;
+}
+
+// makes the sample visible to analogRead() and digitalRead()
+static void useSample(const TraceSample& sample) {
+  current = sample;
+#if NUMKEYS > 0
+  for (int i = 0; i < NUMKEYS; i++) {
+    sim::setDigital(par.values->keyList[i], (current.keys & (1u << i)) ? LOW : HIGH);
+  }
+#endif
+}
+
+static void install() {
+  sim::setAnalogSource(analog);
+  mapPins();
+}
+
+// -s <id>=<value>[,<value>...], returns false if the parameter or a value is invalid
+static bool setParameter(const char* arg) {
+  char* p;
+  long id = strtol(arg, &p, 10);
+  if (*p != '=' || id < 1 || id > NUM_PARAMS) return false;
+  for (uint8_t n = 0; n < paramCount(id, par); n++) {
+    char* end;
+    double v = strtod(p + 1, &end);
+    if (end == p + 1 || !writeParameter(id, v, par, n)) return false;
+    p = end;
+    if (*p != ',') break;
+  }
+  return *p == 0;
+}
+
+}  // namespace replay
+
+#endif  // REPLAY_H
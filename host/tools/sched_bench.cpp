@@ -0,0 +1,144 @@
+// Sensing rate of the firmware in the different debug modes. Without the task scheduler the serial output of a
+// debug mode slows down the whole loop(), with TASK_SCHEDULER 1 the sensing stays on the grid of SENSE_PERIOD_US.
+//
+//   sched_bench [<seconds>] [--serial <us per byte>]
+//
+// Each debug mode is selected over the serial interface and runs <seconds> (default 2) of virtual time, the first
+// 200 ms after the selection are not evaluated. The sensors follow slow sine waves (as frames --move).
+// Serial.write() takes 10 us per byte (USB CDC of the Pro Micro, about 100 kByte/s), --serial changes it.
+// A sensing pass is recognized by its conversions (8, SKEW_MODE 2: 16).
+//
+// Reported per debug mode: sensing passes per second, standard deviation and maximum of the time between passes,
+// serial output and HID reports. The exit code is 1, if the rate of a mode differs by more than 5 % from the rate
+// without debug output (-1). sched_bench_scheduler is built with host/task_scheduler.h (config.h + TASK_SCHEDULER 1),
+// it also prints the task statistics of debug mode 71 and exits with 1, if a task missed its deadline or overran
+// its budget.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "parameterMenu.h"
+#include "scheduler.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+extern ParamData par;
+
+#define SETTLE_MICROS 200000UL
+
+static std::vector<uint32_t> passStarts;  // virtual time of the first conversion of each sensing pass
+static uint32_t conversions = 0;
+static unsigned readsPerPass = 8;
+
+struct Result {
+  double rate;       // passes/s
+  double sd;         // of the time between passes, us
+  uint32_t maxGap;   // us
+  double serial;     // bytes/s
+  size_t reports;
+  std::string output;
+};
+
+static Result runMode(int mode, double seconds) {
+  char command[16];
+  snprintf(command, sizeof(command), "%d\r", mode);
+  sim::serialInput(command);
+  uint32_t start = sim::now();
+  while (sim::now() - start < SETTLE_MICROS) loop();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+  passStarts.clear();
+
+  Result r = {};
+  uint32_t from = sim::now(), duration = (uint32_t)(seconds * 1e6);
+  size_t bytes = 0;
+  while (sim::now() - from < duration) {
+    loop();
+    std::string out = sim::takeSerialOutput();
+    bytes += out.size();
+    r.output += out;
+    r.reports += sim::usbPackets().size();
+    sim::usbPackets().clear();
+  }
+  double elapsed = (sim::now() - from) / 1e6;
+  r.rate = passStarts.size() / elapsed;
+  r.serial = bytes / elapsed;
+  double mean = 0, squares = 0;
+  for (size_t i = 1; i < passStarts.size(); i++) mean += passStarts[i] - passStarts[i - 1];
+  if (passStarts.size() > 1) mean /= passStarts.size() - 1;
+  for (size_t i = 1; i < passStarts.size(); i++) {
+    uint32_t gap = passStarts[i] - passStarts[i - 1];
+    squares += (gap - mean) * (gap - mean);
+    if (gap > r.maxGap) r.maxGap = gap;
+  }
+  if (passStarts.size() > 1) r.sd = sqrt(squares / (passStarts.size() - 1));
+  return r;
+}
+
+int main(int argc, char** argv) {
+  double seconds = 2.0;
+  uint32_t serialMicros = 10;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc) {
+      serialMicros = atoi(argv[++i]);
+    } else if (argv[i][0] != '-' && atof(argv[i]) > 0) {
+      seconds = atof(argv[i]);
+    } else {
+      fprintf(stderr, "usage: %s [<seconds>] [--serial <us per byte>]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  sim::reset();
+  sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+    if (conversions++ % readsPerPass == 0) passStarts.push_back(us);
+    return 512 + (int)(300.0 * sin(us / 1e6 * (1.0 + 0.3 * pin)));  // slow movement as frames --move
+  });
+  setup();
+#if SKEW_COMP > 0
+  if (par.values->skewMode == 2) readsPerPass = 16;
+#endif
+  sim::setSerialMicrosPerByte(serialMicros);
+  conversions = 0;
+
+  const int modes[] = {-1, 1, 2, 3, 31, 4, 5, 6, 61, 7, 40, 71};
+  printf("TASK_SCHEDULER %d", TASK_SCHEDULER);
+#if TASK_SCHEDULER > 0
+  printf(", SENSE_PERIOD_US %d", SENSE_PERIOD_US);
+#endif
+  printf(", Serial.write() %u us per byte, %.1f s per mode\n", serialMicros, seconds);
+  printf("%6s %12s %10s %10s %14s %12s\n", "mode", "passes/s", "sd [us]", "max [us]", "serial [B/s]", "HID reports");
+  bool fixed = true;
+  double reference = 0;
+  std::string stats;
+  for (int mode : modes) {
+    if (mode == 71 && TASK_SCHEDULER == 0) continue;
+    Result r = runMode(mode, seconds);
+    if (mode == -1) reference = r.rate;
+    if (fabs(r.rate - reference) > 0.05 * reference) fixed = false;
+    printf("%6d %12.1f %10.1f %10u %14.0f %12zu\n", mode, r.rate, r.sd, r.maxGap, r.serial, r.reports);
+    if (mode == 71) stats = r.output;
+  }
+  bool clean = true;
+  if (!stats.empty()) {
+    // the last statistics of debug mode 71
+    size_t last = stats.rfind("task 0:");
+    stats = stats.substr(last == std::string::npos ? 0 : last);
+    printf("\n%s", stats.c_str());
+    for (const char* counter : {"misses ", "overruns "}) {
+      for (size_t at = stats.find(counter); at != std::string::npos; at = stats.find(counter, at + 1)) {
+        if (atoi(stats.c_str() + at + strlen(counter)) != 0) clean = false;
+      }
+    }
+    printf("no deadline misses and overruns: %s\n", clean ? "yes" : "no");
+  }
+  printf("sensing rate independent of the debug mode: %s\n", fixed ? "yes" : "no");
+  return fixed && clean ? 0 : 1;
+}
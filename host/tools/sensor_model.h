@@ -0,0 +1,187 @@
+// Physical model of the SpaceMouse sensors for the host build: turns a 6-DOF pose of the knob into the
+// ADC counts of the eight sensors, as they appear in rawReads[] after INVERTLIST.
+//
+// Hall effect (HALLEFFECT): four magnets on the knob at S, E, N, W, magnetized along z, above the board.
+// Each magnet sits between two hall sensors, which measure Bz of all four magnets (point dipoles):
+//
+//         N                 sensors on the board (z = 0), magnets at z = gap:
+//       7   6               - S magnet between HES0 (west) and HES1 (east)
+//         |                 - E magnet between HES2 (south) and HES3 (north)
+//    8    |    3            - N magnet between HES7 (west) and HES6 (east)
+// W-- ----T---- --E         - W magnet between HES9 (south) and HES8 (north)
+//    9    |    2
+//         |                 a closer magnet gives a smaller value (see the table in kinematics.cpp)
+//       0   1
+//         S
+//
+// Resistive joysticks: four 2-axis joysticks at A = S, B = W, C = N, D = E. The X axis of a joystick follows
+// the vertical movement of its attachment point, the Y axis the tangential (counter-clockwise) movement.
+//
+// Rotations turn around the pivot of the knob, pivot mm above the magnets / attachment points, so tilting
+// also moves the magnets sideways. The counts get gaussian noise and are quantized to 0..1023.
+#ifndef SENSOR_MODEL_H
+#define SENSOR_MODEL_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include <random>
+
+#include "kinematics.h"
+#include "trace.h"
+
+struct Pose {
+  double t[3];  // translation x (east), y (north), z (up) in mm
+  double r[3];  // rotation around x, y, z in degrees (right hand)
+
+  // movement along a single axis: 0..2 translation x, y, z, 3..5 rotation around x, y, z
+  static Pose axis(int axis, double value) {
+    Pose pose = {};
+    if (axis < 3) {
+      pose.t[axis] = value;
+    } else {
+      pose.r[axis - 3] = value;
+    }
+    return pose;
+  }
+};
+
+struct SensorModel {
+  // geometry in mm
+  double radius = 14.0;  // magnets / attachment points from the center
+  double offset = 3.5;   // hall sensors left and right of the magnet
+  double gap = 4.0;      // magnets above the hall sensors
+  double pivot = 8.0;    // pivot of the rotations above the magnets
+  double noise = 0.8;    // standard deviation of the ADC noise in counts
+  double counts = 330;   // change of the strongest sensor at full deflection, cf. MINVALS
+  double fullZ = 1.0;    // mm the knob can be pressed down
+  std::mt19937 random{1};
+
+  SensorModel() { calibrate(); }
+
+  // gain so that pressing the knob fullZ down changes the strongest sensor by counts
+  void calibrate() {
+    gain = 1.0;
+    Pose rest = {}, down = {};
+    down.t[2] = -fullZ;
+    double a[8], b[8];
+    ideal(rest, a);
+    ideal(down, b);
+    double maxDelta = 0;
+    for (int i = 0; i < 8; i++) maxDelta = fmax(maxDelta, fabs(b[i] - a[i]));
+    gain = counts / maxDelta;
+    ideal(rest, center);
+  }
+
+  // movement along the axis (mm or degrees), at which the first sensor changes by counts in one of
+  // the directions: the mechanical end stop of the model
+  double fullDeflection(int axis) const {
+    double rest[8], plus[8], minus[8];
+    ideal(Pose{}, rest);
+    double low = 0, high = axis < 3 ? 10.0 : 45.0;
+    for (int n = 0; n < 50; n++) {
+      double a = (low + high) / 2, change = 0;
+      ideal(Pose::axis(axis, a), plus);
+      ideal(Pose::axis(axis, -a), minus);
+      for (int i = 0; i < 8; i++) change = fmax(change, fmax(fabs(plus[i] - rest[i]), fabs(minus[i] - rest[i])));
+      (change > counts ? high : low) = a;
+    }
+    return low;
+  }
+
+  // ADC counts with noise and quantization, as TraceSample for replay::useSample()
+  TraceSample sample(const Pose& pose, uint32_t micros = 0) {
+    double v[8];
+    ideal(pose, v);
+    std::normal_distribution<double> gauss(0.0, noise);
+    TraceSample s;
+    s.micros = micros;
+    s.keys = 0;
+    for (int i = 0; i < 8; i++) {
+      double adc = 512 + v[i] - center[i] + (noise > 0 ? gauss(random) : 0.0);
+      s.raw[i] = (int16_t)fmin(1023.0, fmax(0.0, round(adc)));
+    }
+    return s;
+  }
+
+  // noiseless, unquantized values relative to an arbitrary zero
+  void ideal(const Pose& pose, double* value) const {
+    double rot[3][3];
+    rotation(pose, rot);
+#ifdef HALLEFFECT
+    // magnets S, E, N, W and the sensors left / right of them
+    static const double dir[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    static const int sensor[4][2] = {{HES0, HES1}, {HES2, HES3}, {HES6, HES7}, {HES8, HES9}};
+    double magnet[4][3], moment[4][3];
+    for (int m = 0; m < 4; m++) {
+      double p[3] = {radius * dir[m][0], radius * dir[m][1], gap};
+      transform(pose, rot, p, magnet[m]);
+      double z[3] = {0, 0, 1};
+      for (int k = 0; k < 3; k++) moment[m][k] = rot[k][0] * z[0] + rot[k][1] * z[1] + rot[k][2] * z[2];
+    }
+    for (int m = 0; m < 4; m++) {
+      for (int side = 0; side < 2; side++) {
+        // side 0 is clockwise of the magnet (e.g. HES0 west of the S magnet), side 1 counter-clockwise
+        double sign = side == 0 ? -1 : 1;
+        double s[3] = {radius * dir[m][0] - sign * offset * dir[m][1], radius * dir[m][1] + sign * offset * dir[m][0],
+                       0};
+        double bz = 0;
+        for (int n = 0; n < 4; n++) bz += dipoleBz(magnet[n], moment[n], s);
+        value[sensor[m][side]] = -gain * bz;  // stronger field -> smaller value
+      }
+    }
+#else
+    // joysticks A = S, B = W, C = N, D = E: X vertical, Y tangential (counter-clockwise)
+    static const double dir[4][2] = {{0, -1}, {-1, 0}, {0, 1}, {1, 0}};
+    static const int axis[4][2] = {{AX, AY}, {BX, BY}, {CX, CY}, {DX, DY}};
+    for (int j = 0; j < 4; j++) {
+      double p[3] = {radius * dir[j][0], radius * dir[j][1], 0};
+      double q[3];
+      transform(pose, rot, p, q);
+      double tangential = -(q[0] - p[0]) * dir[j][1] + (q[1] - p[1]) * dir[j][0];
+      value[axis[j][0]] = gain * (q[2] - p[2]);
+      value[axis[j][1]] = gain * tangential;
+    }
+#endif
+  }
+
+ private:
+  double gain = 1.0;
+  double center[8] = {};
+
+  static void rotation(const Pose& pose, double m[3][3]) {
+    double a = pose.r[0] * M_PI / 180, b = pose.r[1] * M_PI / 180, c = pose.r[2] * M_PI / 180;
+    double ca = cos(a), sa = sin(a), cb = cos(b), sb = sin(b), cc = cos(c), sc = sin(c);
+    // R = Rz(c) * Ry(b) * Rx(a)
+    m[0][0] = cc * cb;
+    m[0][1] = cc * sb * sa - sc * ca;
+    m[0][2] = cc * sb * ca + sc * sa;
+    m[1][0] = sc * cb;
+    m[1][1] = sc * sb * sa + cc * ca;
+    m[1][2] = sc * sb * ca - cc * sa;
+    m[2][0] = -sb;
+    m[2][1] = cb * sa;
+    m[2][2] = cb * ca;
+  }
+
+  // point p of the knob at rest -> position in the pose (rotation around the pivot, then translation)
+  void transform(const Pose& pose, const double rot[3][3], const double* p, double* out) const {
+    double pivotZ = p[2] + pivot;  // all points of a model are in one plane
+    double rel[3] = {p[0], p[1], p[2] - pivotZ};
+    for (int k = 0; k < 3; k++) {
+      out[k] = rot[k][0] * rel[0] + rot[k][1] * rel[1] + rot[k][2] * rel[2] + pose.t[k];
+    }
+    out[2] += pivotZ;
+  }
+
+  // z component of the field of a point dipole at position with moment at the point s (arbitrary units)
+  static double dipoleBz(const double* position, const double* moment, const double* s) {
+    double r[3] = {s[0] - position[0], s[1] - position[1], s[2] - position[2]};
+    double d2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+    double d = sqrt(d2);
+    double mr = (moment[0] * r[0] + moment[1] * r[1] + moment[2] * r[2]) / d2;
+    return (3 * mr * r[2] - moment[2]) / (d2 * d);
+  }
+};
+
+#endif  // SENSOR_MODEL_H
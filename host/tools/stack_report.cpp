@@ -0,0 +1,147 @@
+// Stack high-water mark of the firmware in the host build, for each debug mode and ProgMode.
+//
+//   stack_report
+//
+// The firmware runs on the painted stack of the shim (sim::runOnStack()) with slowly moving sensors. Each step
+// selects a debug mode over the serial interface (or sends ProgMode commands) and runs loop() for the given virtual
+// time. Before each step the stack below the tool is painted again, after it stackFreeMin() of the firmware shows the
+// deepest stack of the step: setup(), loop() with all stages, the interrupt routines, the shim and the C library
+// (e.g. vsnprintf() for sprintf()). The bytes are x86-64 bytes: pointers, int and return addresses are larger than
+// on the AVR, the numbers compare configurations and debug modes. They are no measure of the AVR stack and can't be
+// compared with the free RAM of the ATmega32U4: the AVR value is read on the unit with debug mode 74 or ProgMode >f
+// (STACK_MONITOR 1).
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "parameterMenu.h"
+#include "sim.h"
+#include "stackMonitor.h"
+
+void setup();
+void loop();
+
+extern uint8_t __heap_start[];
+
+struct Step {
+  const char* name;
+  const char* input;      // serial input at the start of the step
+  uint32_t ms;            // virtual time of the step
+  bool text;              // text output with sprintf() (DEBUG_TEXT), vsnprintf() of the C library dominates
+  bool compiled;          // the configuration has the mode, otherwise its input would select other debug modes
+};
+
+#if PARAM_IN_EEPROM > 0
+static const bool menu = true;
+#else
+static const bool menu = false;
+#endif
+#if ENABLE_PROGMODE > 0
+static const bool progMode = true;
+#else
+static const bool progMode = false;
+#endif
+
+// the calibrations 11 and 20 run until they are done, the menu 30 lists and prints all parameters, steps without
+// their mode in the configuration are printed as "-"
+static const Step steps[] = {
+    {"-1 off", "-1\r", 300, false, true},
+    {"0 menu", "0\r", 300, false, true},
+    {"1 raw", "1\r", 300, true, true},
+    {"2 centered", "2\r", 300, true, true},
+    {"3 deadzone", "3\r", 300, true, true},
+    {"31 offsets", "31\r", 300, true, true},
+    {"4 velocity", "4\r", 300, true, true},
+    {"5 3 and 4", "5\r", 300, true, true},
+    {"6 kill keys", "6\r", 300, true, true},
+    {"61 exclusive", "61\r", 300, true, true},
+    {"7 frequency", "7\r", 1300, false, true},
+    {"8 keys", "8\r", 300, false, true},
+    {"9 encoder", "9\r", 300, false, true},
+    {"11 zeroing", "11\r", 2500, false, true},
+    {"20 min/max", "20\r", 23000, false, true},
+    {"30 parameters", "30\r1\r7\rq", 1000, false, menu},
+    {"40 telemetry", "40\r", 300, false, true},
+    {"71 tasks", "71\r", 1300, false, true},
+    {"72 micro-bench", "72\r", 300, false, true},
+    {"73 flight dump", "73\r", 300, false, true},
+    {"74 free stack", "74\r", 300, false, true},
+    {"75 latency", "75\r", 300, false, true},
+    {"ProgMode", "-1\r>a\r>p1\r>d\r>r\r>n\r>f\r>h\r", 300, false, progMode},
+};
+
+static const int numSteps = sizeof(steps) / sizeof(steps[0]);
+static int used[numSteps];
+static int setupUsed;
+
+// bytes of the stack below the frame of the caller, which the firmware has used since the last paint
+static int usedBelow(const uint8_t* frame) {
+  return (int)(frame - (__heap_start + stackFreeMin()));
+}
+
+static void __attribute__((noinline)) runSteps() {
+  const uint8_t* frame = (const uint8_t*)__builtin_frame_address(0);
+  sim::paintStack();
+  setup();
+  setupUsed = usedBelow(frame);
+  sim::takeSerialOutput();
+
+  for (int s = 0; s < numSteps; s++) {
+    if (!steps[s].compiled) {
+      continue;
+    }
+    sim::paintStack();
+    sim::serialInput(steps[s].input);
+    uint32_t start = sim::now();
+    while (sim::now() - start < steps[s].ms * 1000) {
+      loop();
+      sim::usbPackets().clear();
+      sim::takeSerialOutput();
+    }
+    used[s] = usedBelow(frame);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // the dynamic linker binds the symbols of the C and C++ library at the first call (also inside libstdc++),
+  // on the stack of the firmware: start again with all symbols bound
+  if (getenv("LD_BIND_NOW") == nullptr) {
+    setenv("LD_BIND_NOW", "1", 1);
+    execv("/proc/self/exe", argv);
+  }
+  sim::reset();
+  // slow triangle waves instead of the sine waves of frames --move: sin() of the C library needs a large stack,
+  // which would count as stack of the firmware
+  sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+    int phase = (int)((us / 1000 * (10 + 3 * pin) / 10) % 2400);  // 2.4 s period at pin 0
+    return 212 + ((phase < 1200) ? phase : 2400 - phase) / 2;
+  });
+  sim::runOnStack(runSteps);
+
+  printf("stack of the firmware on the host (x86-64), bytes below the tool, not the AVR stack\n");
+  printf("%-16s %6s\n", "step", "bytes");
+  printf("%-16s %6d\n", "setup", setupUsed);
+  int peak = setupUsed, peakStep = -1;
+  int peakNoText = setupUsed, peakNoTextStep = -1;
+  for (int s = 0; s < numSteps; s++) {
+    if (!steps[s].compiled) {
+      printf("%-16s %6s\n", steps[s].name, "-");
+      continue;
+    }
+    printf("%-16s %6d%s\n", steps[s].name, used[s], steps[s].text ? "  (sprintf)" : "");
+    if (used[s] > peak) {
+      peak = used[s];
+      peakStep = s;
+    }
+    if (!steps[s].text && used[s] > peakNoText) {
+      peakNoText = used[s];
+      peakNoTextStep = s;
+    }
+  }
+  printf("virtual time %u ms\n", sim::now() / 1000);
+  printf("peak %d bytes in %s\n", peak, peakStep < 0 ? "setup" : steps[peakStep].name);
+  printf("peak without sprintf() %d bytes in %s\n", peakNoText,
+         peakNoTextStep < 0 ? "setup" : steps[peakNoTextStep].name);
+  return 0;
+}
@@ -0,0 +1,123 @@
+// Cost of the single stages of the pipeline (see pipeline.h) on the host CPU.
+//
+//   stage_bench [<frames>]
+//
+// The firmware runs its complete loop() with slowly moving sensors (as frames --move) and the frame of each pass is
+// recorded after readStage() (default 2000 frames). Then each stage runs alone on the recorded frames: the input of a
+// stage is the output of the stages before it, calculated once with the recorded frames. Reported per stage: ns per
+// call on the host CPU (without the copy of the frame), the share of the calculation after readStage() and a checksum
+// of the velocities and HID keys after the last stage, which has to be the same for both variants of a configuration. The
+// conversions of readStage() take 8 * 104 us of virtual time on the Pro Micro and are not timed.
+// The tools read the parameters from ParamStorage (PARAM_CONST 0), stage_bench_const_<config> is built for the
+// configurations without parameter menu and ProgMode as on the controller, with the parameters as constants.
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "parameterMenu.h"
+#include "pipeline.h"
+#include "sim.h"
+
+void setup();
+void loop();
+
+extern Frame frame;
+extern ParamData par;
+extern int centerPoints[8];
+
+struct Stage {
+  const char* name;
+  std::function<void(Frame&)> run;
+};
+
+// ns per call of a stage on copies of the given frames, the time of the copies is subtracted
+static double cost(const std::vector<Frame>& inputs, const std::function<void(Frame&)>& run) {
+  const int repeats = 200;
+  Frame work;
+  long checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    for (const Frame& input : inputs) {
+      work = input;
+      checksum += work.velocity[0];
+    }
+  }
+  double copies = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    for (const Frame& input : inputs) {
+      work = input;
+      run(work);
+      checksum += work.velocity[0];
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (checksum == 1) printf(" ");  // keeps the calls
+  return fmax(seconds - copies, 0) * 1e9 / ((double)repeats * inputs.size());
+}
+
+int main(int argc, char** argv) {
+  long count = 2000;
+  if (argc == 2) count = atol(argv[1]);
+  if (argc > 2 || count <= 0) {
+    fprintf(stderr, "usage: %s [<frames>]\n", argv[0]);
+    return 2;
+  }
+
+  sim::reset();
+  sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+    return 512 + (int)(300.0 * sin(us / 1e6 * (1.0 + 0.3 * pin)));  // slow movement as frames --move
+  });
+  setup();
+  sim::takeSerialOutput();
+
+  // the recorded frames after readStage(): raw values, key values and the time of the frame
+  std::vector<Frame> recorded;
+  for (long i = 0; i < count; i++) {
+    loop();
+    Frame f = frame;
+    for (int j = 0; j < 8; j++) f.offsets[j] = f.centered[j] = 0;
+    for (int j = 0; j < 6; j++) f.velocity[j] = 0;
+    recorded.push_back(f);
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+
+  const Stage stages[] = {
+      {"centerStage", [](Frame& f) { centerStage(f, centerPoints, true, par); }},
+      {"filterStage", [](Frame& f) { filterStage(f, par); }},
+      {"kinematicStage", [](Frame& f) { kinematicStage(f, par); }},
+      {"keyStage", [](Frame& f) { keyStage(f); }},
+      {"zeroHotkeyStage", [](Frame& f) { zeroHotkeyStage(f, centerPoints); }},
+      {"killKeyStage", [](Frame& f) { killKeyStage(f); }},
+      {"axisStage", [](Frame& f) { axisStage(f, par); }},
+  };
+  const int numStages = sizeof(stages) / sizeof(stages[0]);
+  double ns[numStages], total = 0;
+  std::vector<Frame> inputs = recorded;
+  for (int s = 0; s < numStages; s++) {
+    ns[s] = cost(inputs, stages[s].run);
+    total += ns[s];
+    for (Frame& f : inputs) stages[s].run(f);  // the input of the next stage
+  }
+
+  printf("%ld frames, %d stages after readStage(), PARAM_CONST %d\n", count, numStages, PARAM_CONST);
+  printf("%-18s %12s %8s\n", "stage", "ns/call", "share");
+  for (int s = 0; s < numStages; s++) {
+    printf("%-18s %12.1f %7.1f%%\n", stages[s].name, ns[s], total > 0 ? 100.0 * ns[s] / total : 0.0);
+  }
+  printf("%-18s %12.1f\n", "total", total);
+
+  unsigned long checksum = 0;
+  for (const Frame& f : inputs) {
+    for (int j = 0; j < 6; j++) checksum = checksum * 31 + (uint16_t)f.velocity[j];
+    for (int j = 0; j < NUMKEYS; j++) checksum = checksum * 31 + f.hidKeys[j];
+  }
+  printf("checksum           %12lu\n", checksum);
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Decodes the binary telemetry of debug mode 40 (see spacemouse-keys/telemetry.h) into a sensor trace.
+//
+//   telemetry_decode <input> <trace> [<csv>]
+//
+// <input> is either a file with the recorded serial data or the serial device of the SpaceMouse
+// (e.g. /dev/ttyACM0). The device is set to raw mode, "40" is sent to start the telemetry and the
+// recording runs until Ctrl-C, then ESC is sent to stop the telemetry again.
+//
+// The trace (see trace.h) gets the raw values and keys, so it can be replayed with trace_replay, and
+// the results of the firmware as extra columns:
+//   extra 0        loopCount
+//   extra 1..8     centered[] after the deadzone
+//   extra 9..16    offsets[] of the drift compensation
+//   extra 17..22   velocity[]
+// The optional CSV holds the same values, one line per frame.
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "telemetry.h"
+#include "trace.h"
+
+#define EXTRA_COLUMNS 23
+
+static volatile sig_atomic_t stop = 0;
+
+static void onSignal(int) { stop = 1; }
+
+// CRC-16/MCRF4XX, as _crc_ccitt_update() on the AVR
+static uint16_t crc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+  }
+  return crc;
+}
+
+// decodes a COBS frame without the terminating 0x00, returns the decoded length or -1
+static int cobsDecode(const uint8_t* data, size_t len, uint8_t* out, size_t size) {
+  size_t in = 0, n = 0;
+  while (in < len) {
+    uint8_t code = data[in++];
+    if (code == 0 || in + code - 1 > len || n + code > size + 1) return -1;
+    for (uint8_t i = 1; i < code; i++) out[n++] = data[in++];
+    if (in < len && code != 0xFF) { // the last and full groups have no 0x00 behind them
+      if (n >= size) return -1;
+      out[n++] = 0;
+    }
+  }
+  return (int)n;
+}
+
+struct Stats {
+  unsigned long frames = 0;
+  unsigned long faulty = 0;          // wrong length, COBS or CRC fault
+  std::map<uint16_t, unsigned long> gaps;  // distribution of loopCount differences
+};
+
+static void handleFrame(const uint8_t* encoded, size_t len, TraceWriter& trace, FILE* csv, Stats& stats) {
+  static bool first = true;
+  static uint16_t lastLoop;
+  uint8_t data[sizeof(TelemetryFrame) + 2];
+  int n = cobsDecode(encoded, len, data, sizeof(data));
+  if (n != (int)(sizeof(TelemetryFrame) + 2) || crc16(data, sizeof(TelemetryFrame)) !=
+                                                    (uint16_t)(data[sizeof(TelemetryFrame)] | data[n - 1] << 8)) {
+    stats.faulty++;
+    return;
+  }
+  TelemetryFrame f;
+  memcpy(&f, data, sizeof(f));
+  if (f.type != TELEMETRY_FRAME_TYPE) {
+    stats.faulty++;
+    return;
+  }
+  if (!first) stats.gaps[(uint16_t)(f.loopCount - lastLoop)]++;
+  first = false;
+  lastLoop = f.loopCount;
+  stats.frames++;
+
+  TraceSample s;
+  s.micros = f.micros;
+  for (int i = 0; i < 8; i++) s.raw[i] = f.raw[i];
+  s.keys = f.keys;
+  int16_t extra[EXTRA_COLUMNS];
+  extra[0] = (int16_t)f.loopCount;
+  for (int i = 0; i < 8; i++) {
+    extra[1 + i] = f.centered[i];
+    extra[9 + i] = f.offsets[i];
+  }
+  for (int i = 0; i < 6; i++) extra[17 + i] = f.velocity[i];
+  trace.add(s, extra);
+
+  if (csv) {
+    fprintf(csv, "%u,%u", f.micros, f.loopCount);
+    for (int i = 0; i < 8; i++) fprintf(csv, ",%d", f.raw[i]);
+    for (int i = 1; i < EXTRA_COLUMNS; i++) fprintf(csv, ",%d", extra[i]);
+    fprintf(csv, ",%u\n", f.keys);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <input> <trace> [<csv>]\n", argv[0]);
+    return 2;
+  }
+  FILE* in = fopen(argv[1], "r+b");
+  if (!in) in = fopen(argv[1], "rb");
+  if (!in) {
+    perror(argv[1]);
+    return 1;
+  }
+  bool device = isatty(fileno(in));
+  struct termios saved;
+  if (device) {
+    struct termios raw;
+    tcgetattr(fileno(in), &saved);
+    raw = saved;
+    cfmakeraw(&raw);
+    tcsetattr(fileno(in), TCSANOW, &raw);
+    signal(SIGINT, onSignal);
+    if (write(fileno(in), "40\r", 3) != 3) perror("start telemetry");
+    fprintf(stderr, "recording, stop with Ctrl-C\n");
+  }
+
+  static TraceWriter trace;
+  if (!trace.open(argv[2], NUMKEYS, 0, EXTRA_COLUMNS)) {
+    perror(argv[2]);
+    return 1;
+  }
+  FILE* csv = nullptr;
+  if (argc > 3) {
+    csv = fopen(argv[3], "w");
+    if (!csv) {
+      perror(argv[3]);
+      return 1;
+    }
+    fprintf(csv, "micros,loop");
+    for (int i = 0; i < 8; i++) fprintf(csv, ",raw%d", i);
+    for (int i = 0; i < 8; i++) fprintf(csv, ",centered%d", i);
+    for (int i = 0; i < 8; i++) fprintf(csv, ",offset%d", i);
+    for (int i = 0; i < 6; i++) fprintf(csv, ",velocity%d", i);
+    fprintf(csv, ",keys\n");
+  }
+
+  Stats stats;
+  uint8_t frame[TELEMETRY_MAX_ENCODED];
+  size_t len = 0;
+  bool overflow = false;
+  uint8_t buffer[4096];
+  while (!stop) {
+    ssize_t got = read(fileno(in), buffer, sizeof(buffer));
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) break;
+    for (ssize_t i = 0; i < got; i++) {
+      if (buffer[i] == 0) {
+        // text output (e.g. the echo of the debug mode) before the first frame is skipped as faulty frame
+        if (len > 0 && !overflow) handleFrame(frame, len, trace, csv, stats);
+        if (overflow) stats.faulty++;
+        len = 0;
+        overflow = false;
+      } else if (len < sizeof(frame)) {
+        frame[len++] = buffer[i];
+      } else {
+        overflow = true;
+      }
+    }
+  }
+
+  if (device) {
+    if (write(fileno(in), "\x1b", 1) != 1) perror("stop telemetry");
+    tcsetattr(fileno(in), TCSANOW, &saved);
+  }
+  fclose(in);
+  if (csv) fclose(csv);
+  if (!trace.close()) {
+    fprintf(stderr, "writing %s failed\n", argv[2]);
+    return 1;
+  }
+  printf("%lu frames, %lu faulty frames\n", stats.frames, stats.faulty);
+  for (auto& gap : stats.gaps) printf("  loop passes between frames %u: %lu times\n", gap.first, gap.second);
+  return 0;
+}
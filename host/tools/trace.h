@@ -0,0 +1,198 @@
+// Sensor trace format (*.smtrace) and its reader/writer for the host tools.
+//
+// A trace is a recording of the inputs of loop(): the eight raw joystick values as in rawReads[]
+// (after the inversion by INVERTLIST, as shown by debug mode 1), the key states and a timestamp
+// per sample. The file is little endian and can be memory-mapped as it is:
+//
+//   TraceHeader                       64 bytes
+//   block 0 .. blockCount-1           sizeof(TraceBlockHead) + (11 + extraColumns) * blockSamples * int16
+//
+// Each block holds blockSamples samples in columns, so one signal (e.g. sensor 3) is contiguous
+// in memory. Only the last block is partially filled.
+//
+//   TraceBlockHead  {samples, reserved}
+//   int16 time[2][blockSamples]       timestamp in microseconds, low and high 16 bit
+//   int16 raw[8][blockSamples]        raw ADC values 0..1023 (rawReads[])
+//   int16 keys[blockSamples]          bit i = key i pressed
+//   int16 extra[extraColumns][blockSamples]   optional, e.g. the results of the firmware recorded by
+//                                             telemetry_decode (see there), ignored by trace_replay
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TRACE_MAGIC "SMTRACE"
+#define TRACE_VERSION 1
+#define TRACE_CHANNELS 8
+#define TRACE_COLUMNS (TRACE_CHANNELS + 3) // time low, time high, raw[8], keys
+#define TRACE_COLUMN_RAW 2
+#define TRACE_COLUMN_KEYS (TRACE_COLUMNS - 1)
+#define TRACE_BLOCK_SAMPLES 4096
+#define TRACE_MAX_EXTRA 32
+
+struct TraceHeader {
+  char magic[8];            // TRACE_MAGIC, zero terminated
+  uint16_t version;         // TRACE_VERSION
+  uint16_t headerSize;      // sizeof(TraceHeader)
+  uint16_t channels;        // TRACE_CHANNELS
+  uint16_t numKeys;         // number of valid bits in keys
+  uint32_t blockSamples;    // samples per block
+  uint32_t blockCount;      // number of blocks in the file
+  uint64_t sampleCount;     // number of samples in all blocks
+  uint32_t periodMicros;    // nominal sample period, informative only
+  uint16_t extraColumns;    // number of optional columns after keys
+  uint8_t reserved[26];
+};
+static_assert(sizeof(TraceHeader) == 64, "TraceHeader must be 64 bytes");
+
+struct TraceBlockHead {
+  uint32_t samples;         // valid samples in this block
+  uint32_t reserved;
+};
+
+// one sample, as handed to the writer and returned by the reader
+struct TraceSample {
+  uint32_t micros;
+  int16_t raw[TRACE_CHANNELS];
+  uint16_t keys;
+};
+
+inline size_t traceBlockSize(uint32_t blockSamples, uint16_t extraColumns) {
+  return sizeof(TraceBlockHead) + (size_t)(TRACE_COLUMNS + extraColumns) * blockSamples * sizeof(int16_t);
+}
+
+// Writes a trace sample by sample. The header is completed by close().
+class TraceWriter {
+ public:
+  bool open(const char* path, uint16_t numKeys, uint32_t periodMicros, uint16_t extraColumns = 0) {
+    if (extraColumns > TRACE_MAX_EXTRA) return false;
+    file = fopen(path, "wb");
+    if (!file) return false;
+    memset(&header, 0, sizeof(header));
+    memset(&block, 0, sizeof(block));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.headerSize = sizeof(TraceHeader);
+    header.channels = TRACE_CHANNELS;
+    header.numKeys = numKeys;
+    header.blockSamples = TRACE_BLOCK_SAMPLES;
+    header.periodMicros = periodMicros;
+    header.extraColumns = extraColumns;
+    fwrite(&header, sizeof(header), 1, file);
+    return true;
+  }
+
+  // extra: header.extraColumns values or nullptr
+  void add(const TraceSample& s, const int16_t* extra = nullptr) {
+    if (block.samples == TRACE_BLOCK_SAMPLES) flush();
+    uint32_t n = block.samples++;
+    columns[0][n] = (int16_t)(s.micros & 0xFFFF);
+    columns[1][n] = (int16_t)(s.micros >> 16);
+    for (int c = 0; c < TRACE_CHANNELS; c++) columns[TRACE_COLUMN_RAW + c][n] = s.raw[c];
+    columns[TRACE_COLUMN_KEYS][n] = (int16_t)s.keys;
+    for (int c = 0; c < header.extraColumns; c++) columns[TRACE_COLUMNS + c][n] = extra ? extra[c] : 0;
+    header.sampleCount++;
+  }
+
+  bool close() {
+    if (!file) return false;
+    if (block.samples > 0) flush();
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    bool ok = (ferror(file) == 0);
+    fclose(file);
+    file = nullptr;
+    return ok;
+  }
+
+ private:
+  void flush() {
+    // unused rows of a partial block are written as zeros, so every block has the same size
+    int numColumns = TRACE_COLUMNS + header.extraColumns;
+    for (uint32_t n = block.samples; n < TRACE_BLOCK_SAMPLES; n++) {
+      for (int c = 0; c < numColumns; c++) columns[c][n] = 0;
+    }
+    fwrite(&block, sizeof(block), 1, file);
+    fwrite(columns, sizeof(columns[0]), numColumns, file);
+    header.blockCount++;
+    block.samples = 0;
+  }
+
+  FILE* file = nullptr;
+  TraceHeader header;
+  TraceBlockHead block;
+  int16_t columns[TRACE_COLUMNS + TRACE_MAX_EXTRA][TRACE_BLOCK_SAMPLES];
+};
+
+// Maps a trace into memory and gives access to its blocks and samples.
+class TraceReader {
+ public:
+  ~TraceReader() {
+    if (map) munmap(map, mapSize);
+  }
+
+  // returns nullptr on success or a description of the fault
+  const char* open(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return "cannot open file";
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+      ::close(fd);
+      return "file too short";
+    }
+    mapSize = st.st_size;
+    void* m = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return "cannot map file";
+    map = (uint8_t*)m;
+    header = (const TraceHeader*)map;
+    if (memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) return "wrong magic";
+    if (header->version != TRACE_VERSION || header->channels != TRACE_CHANNELS) return "unsupported version";
+    if (header->blockSamples == 0 ||
+        header->headerSize + (size_t)header->blockCount * traceBlockSize(header->blockSamples, header->extraColumns) >
+            mapSize) {
+      return "file truncated";
+    }
+    return nullptr;
+  }
+
+  const TraceHeader& info() const { return *header; }
+
+  const TraceBlockHead& blockHead(uint32_t b) const { return *(const TraceBlockHead*)blockBase(b); }
+
+  // column 0, 1 = time, TRACE_COLUMN_RAW.. = raw values, TRACE_COLUMN_KEYS = keys, TRACE_COLUMNS.. = extra
+  const int16_t* column(uint32_t b, int c) const {
+    return (const int16_t*)(blockBase(b) + sizeof(TraceBlockHead)) + (size_t)c * header->blockSamples;
+  }
+
+  // Iterates over all samples: start with b = n = 0.
+  bool next(uint32_t& b, uint32_t& n, TraceSample& s) const {
+    while (b < header->blockCount && n >= blockHead(b).samples) {
+      b++;
+      n = 0;
+    }
+    if (b >= header->blockCount) return false;
+    s.micros = (uint16_t)column(b, 0)[n] | ((uint32_t)(uint16_t)column(b, 1)[n] << 16);
+    for (int c = 0; c < TRACE_CHANNELS; c++) s.raw[c] = column(b, TRACE_COLUMN_RAW + c)[n];
+    s.keys = (uint16_t)column(b, TRACE_COLUMN_KEYS)[n];
+    n++;
+    return true;
+  }
+
+ private:
+  const uint8_t* blockBase(uint32_t b) const {
+    return map + header->headerSize + (size_t)b * traceBlockSize(header->blockSamples, header->extraColumns);
+  }
+
+  uint8_t* map = nullptr;
+  size_t mapSize = 0;
+  const TraceHeader* header = nullptr;
+};
+
+#endif  // TRACE_H
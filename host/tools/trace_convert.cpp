@@ -0,0 +1,106 @@
+// Converts a serial log of debug mode 1 into a sensor trace (see trace.h).
+//
+//   trace_convert <log> <trace> [period_us]
+//
+// Every line of debug mode 1 ("AX:  512 AY:  510 ... K0:1, K1:1, ") is one sample. The log has no
+// timestamps, the samples are placed period_us apart (default DEBUGDELAY = 100 ms). Debug mode 1
+// only prints every DEBUGDELAY ms, for real sessions reduce DEBUGDELAY in config.h while recording.
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "trace.h"
+
+// parses one line of debug mode 1, returns false if it isn't one
+static bool parseLine(const std::string& line, TraceSample& s, int& numKeys) {
+  const char* p = line.c_str();
+  for (int c = 0; c < TRACE_CHANNELS; c++) {
+    while (*p == ' ') p++;
+    if (!isalpha((unsigned char)p[0]) || !isalnum((unsigned char)p[1]) || p[2] != ':') return false;
+    char* end;
+    long v = strtol(p + 3, &end, 10);
+    if (end == p + 3) return false;
+    s.raw[c] = (int16_t)v;
+    p = end;
+  }
+  s.keys = 0;
+  numKeys = 0;
+  while (*p == ' ') p++;
+  while (p[0] == 'K' && isdigit((unsigned char)p[1])) {
+    char* end;
+    long i = strtol(p + 1, &end, 10);
+    if (*end != ':') return false;
+    long v = strtol(end + 1, &end, 10);
+    if (i < 16 && v == 0) s.keys |= 1u << i; // pulled to ground = pressed
+    numKeys = i + 1;
+    p = end;
+    while (*p == ',' || *p == ' ') p++;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <log> <trace> [period_us]\n", argv[0]);
+    return 2;
+  }
+  uint32_t period = (argc > 3) ? strtoul(argv[3], nullptr, 10) : 100000;
+  FILE* in = fopen(argv[1], "rb");
+  if (!in) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  static TraceWriter writer;
+  std::string line;
+  std::string text;
+  int c;
+  while ((c = fgetc(in)) != EOF) text += (char)c;
+  fclose(in);
+
+  int numKeys = 0;
+  bool opened = false;
+  uint32_t micros = 0;
+  unsigned long samples = 0;
+  unsigned long skipped = 0;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find_first_of("\r\n", pos);
+    if (end == std::string::npos) end = text.size();
+    line = text.substr(pos, end - pos);
+    pos = end + 1;
+    if (line.empty()) continue;
+
+    TraceSample s;
+    int keys;
+    if (!parseLine(line, s, keys)) {
+      skipped++;
+      continue;
+    }
+    if (!opened) {
+      numKeys = keys;
+      if (!writer.open(argv[2], numKeys, period)) {
+        perror(argv[2]);
+        return 1;
+      }
+      opened = true;
+    }
+    s.micros = micros;
+    micros += period;
+    writer.add(s);
+    samples++;
+  }
+  if (!opened) {
+    fprintf(stderr, "no lines of debug mode 1 found in %s\n", argv[1]);
+    return 1;
+  }
+  if (!writer.close()) {
+    fprintf(stderr, "writing %s failed\n", argv[2]);
+    return 1;
+  }
+  printf("%lu samples, %d keys, %lu other lines skipped\n", samples, numKeys, skipped);
+  return 0;
+}
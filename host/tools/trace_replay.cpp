@@ -0,0 +1,112 @@
+// Replays a sensor trace (see trace.h) through the firmware and writes the HID reports it sends.
+//
+//   trace_replay <trace> [-o <reports.csv>] [-s <id>=<value>[,<value>...]]...
+//
+// The firmware starts with the parameters from config.h. -s changes parameter <id> before the
+// replay, array parameters take their elements separated by ','. Every sample is fed to loop() via
+// analogRead() and digitalRead() at its time in the trace: the virtual clock is advanced to the
+// sample, if loop() is faster than the trace. If loop() is slower, the samples it missed are
+// dropped, as they would be on the Pro Micro.
+//
+// Output (default stdout): one line per HID report
+//   <micros>,1,<x>,<y>,<z>,<rx>,<ry>,<rz>    translation and rotation
+//   <micros>,3,<buttons as hex>              keys
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "replay.h"
+
+void setup();
+void loop();
+
+static void writeReport(FILE* out, const sim::UsbPacket& packet) {
+  const std::vector<uint8_t>& d = packet.data;
+  if (d.empty()) return;
+  fprintf(out, "%u,%u", packet.micros, d[0]);
+  if (d[0] == 1) {
+    for (size_t i = 1; i + 1 < d.size(); i += 2) fprintf(out, ",%d", (int16_t)(d[i] | (d[i + 1] << 8)));
+  } else {
+    fprintf(out, ",");
+    for (size_t i = d.size() - 1; i >= 1; i--) fprintf(out, "%02x", d[i]);
+  }
+  fprintf(out, "\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace> [-o <reports.csv>] [-s <id>=<value>[,<value>...]]...\n", argv[0]);
+    return 2;
+  }
+  TraceReader trace;
+  if (const char* fault = trace.open(argv[1])) {
+    fprintf(stderr, "%s: %s\n", argv[1], fault);
+    return 1;
+  }
+
+  // setup() calibrates the centers with the first sample
+  uint32_t b = 0, n = 0;
+  TraceSample next;
+  bool haveNext = trace.next(b, n, next);
+  TraceSample current = next;
+  sim::reset();
+  replay::useSample(next);
+  replay::install();
+  setup();
+
+  FILE* out = stdout;
+  for (int i = 2; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out = fopen(argv[++i], "w");
+      if (!out) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      if (!replay::setParameter(argv[++i])) {
+        fprintf(stderr, "invalid parameter or value: %s\n", argv[i]);
+        return 1;
+      }
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  replay::mapPins();
+  loop(); // take over the changed parameters
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  auto start = std::chrono::steady_clock::now();
+  uint32_t offset = haveNext ? sim::now() - next.micros : 0; // trace time -> virtual time
+  uint32_t first = next.micros;
+  uint64_t samples = 0, dropped = 0, reports = 0;
+  while (haveNext) {
+    current = next;
+    haveNext = trace.next(b, n, next);
+    samples++;
+    uint32_t due = current.micros + offset;
+    if ((int32_t)(sim::now() - due) < 0) {
+      sim::advanceMicros(due - sim::now());
+    } else if (haveNext && (int32_t)(sim::now() - (next.micros + offset)) >= 0) {
+      dropped++; // loop() is already behind the following sample
+      continue;
+    }
+    replay::useSample(current);
+    loop();
+    for (const sim::UsbPacket& packet : sim::usbPackets()) writeReport(out, packet);
+    reports += sim::usbPackets().size();
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (out != stdout) fclose(out);
+
+  double traceSeconds = (current.micros - first) / 1e6;
+  fprintf(stderr, "%llu samples (%llu dropped), %llu HID reports, %.1f s trace in %.2f s host time\n",
+          (unsigned long long)samples, (unsigned long long)dropped, (unsigned long long)reports, traceSeconds,
+          seconds);
+  return 0;
+}
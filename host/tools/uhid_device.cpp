@@ -0,0 +1,244 @@
+// Virtual SpaceMouse: registers the HID report descriptor of the firmware with the Linux kernel via
+// /dev/uhid and runs the firmware of the host build in real time. Every HID report the firmware sends
+// is passed to the kernel, so spacenavd, hidraw readers or applications see a real SpaceMouse.
+//
+//   uhid_device [<trace>] [-s <id>=<value>[,<value>...]]... [-t <seconds>] [-l <sent.csv>] [--uhid <path>]
+//
+// <trace>  sensor trace (see trace.h) to replay, without it the joysticks follow slow sine waves
+// -s       changes a parameter before the start, as with trace_replay
+// -t       stops after <seconds>, default: at the end of the trace or with Ctrl-C
+// -l       writes the send time of every report: <CLOCK_MONOTONIC ns>,<report as hex>, for hidraw_latency -s
+// --uhid   other device than /dev/uhid (e.g. a file, to look at the events)
+//
+// The virtual clock of the shim is kept in step with CLOCK_MONOTONIC: after each loop() the program
+// sleeps until the real time has reached the virtual time, so the reports come at the rate of the
+// Pro Micro. Output reports of the host (LED) are passed to the firmware. Writing to /dev/uhid needs
+// root rights or a udev rule.
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/uhid.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SpaceMouseHID.h"
+#include "replay.h"
+
+#define SPACEMOUSE_VID 0x256F  // as in boards.txt
+#define SPACEMOUSE_PID 0xC631
+
+void setup();
+void loop();
+
+static volatile sig_atomic_t stop = 0;
+
+static void onSignal(int) { stop = 1; }
+
+static uint64_t monotonicNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void sleepUntil(uint64_t nanos) {
+  struct timespec ts;
+  ts.tv_sec = nanos / 1000000000u;
+  ts.tv_nsec = nanos % 1000000000u;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && !stop) {
+  }
+}
+
+static bool sendEvent(int fd, const struct uhid_event& ev) {
+  if (write(fd, &ev, sizeof(ev)) == (ssize_t)sizeof(ev)) return true;
+  perror("write uhid");
+  return false;
+}
+
+static bool create(int fd) {
+  struct uhid_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.type = UHID_CREATE2;
+  snprintf((char*)ev.u.create2.name, sizeof(ev.u.create2.name), "SpaceMouse host build");
+  snprintf((char*)ev.u.create2.phys, sizeof(ev.u.create2.phys), "uhid_device");
+  static_assert(sizeof(SpaceMouseReportDescriptor) <= sizeof(ev.u.create2.rd_data), "descriptor too long");
+  memcpy(ev.u.create2.rd_data, SpaceMouseReportDescriptor, sizeof(SpaceMouseReportDescriptor));
+  ev.u.create2.rd_size = sizeof(SpaceMouseReportDescriptor);
+  ev.u.create2.bus = BUS_USB;
+  ev.u.create2.vendor = SPACEMOUSE_VID;
+  ev.u.create2.product = SPACEMOUSE_PID;
+  return sendEvent(fd, ev);
+}
+
+// handles the events of the kernel, returns the number of output reports passed to the firmware
+static unsigned handleEvents(int fd) {
+  unsigned outputs = 0;
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+    struct uhid_event ev;
+    if (read(fd, &ev, sizeof(ev)) <= 0) break;
+    struct uhid_event reply;
+    memset(&reply, 0, sizeof(reply));
+    switch (ev.type) {
+      case UHID_OUTPUT: // e.g. LED report, with the report ID as first byte like on the OUT endpoint
+        sim::usbReceive(std::vector<uint8_t>(ev.u.output.data, ev.u.output.data + ev.u.output.size));
+        outputs++;
+        break;
+      case UHID_GET_REPORT: // the firmware has no feature reports
+        reply.type = UHID_GET_REPORT_REPLY;
+        reply.u.get_report_reply.id = ev.u.get_report.id;
+        reply.u.get_report_reply.err = EIO;
+        sendEvent(fd, reply);
+        break;
+      case UHID_SET_REPORT:
+        sim::usbReceive(std::vector<uint8_t>(ev.u.set_report.data, ev.u.set_report.data + ev.u.set_report.size));
+        reply.type = UHID_SET_REPORT_REPLY;
+        reply.u.set_report_reply.id = ev.u.set_report.id;
+        sendEvent(fd, reply);
+        outputs++;
+        break;
+      default: // UHID_START, UHID_STOP, UHID_OPEN, UHID_CLOSE
+        break;
+    }
+  }
+  return outputs;
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  const char* uhidPath = "/dev/uhid";
+  const char* logPath = nullptr;
+  const char* parameters[NUM_PARAMS];
+  int numParameters = 0;
+  double seconds = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc && numParameters < NUM_PARAMS) {
+      parameters[numParameters++] = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      logPath = argv[++i];
+    } else if (strcmp(argv[i], "--uhid") == 0 && i + 1 < argc) {
+      uhidPath = argv[++i];
+    } else if (argv[i][0] != '-' && !tracePath) {
+      tracePath = argv[i];
+    } else {
+      fprintf(stderr,
+              "usage: %s [<trace>] [-s <id>=<value>[,<value>...]]... [-t <seconds>] [-l <sent.csv>] "
+              "[--uhid <path>]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  TraceReader trace;
+  uint32_t b = 0, n = 0;
+  TraceSample next;
+  bool haveNext = false;
+  if (tracePath) {
+    if (const char* fault = trace.open(tracePath)) {
+      fprintf(stderr, "%s: %s\n", tracePath, fault);
+      return 1;
+    }
+    haveNext = trace.next(b, n, next);
+  }
+
+  sim::reset();
+  if (tracePath) {
+    replay::useSample(next);
+    replay::install();
+  } else {
+    sim::setAnalogSource([](uint8_t pin, uint32_t us) {
+      return 512 + (int)(300.0 * sin(us / 1e6 * (1.0 + 0.3 * pin)));
+    });
+  }
+  setup();
+  for (int i = 0; i < numParameters; i++) {
+    if (!replay::setParameter(parameters[i])) {
+      fprintf(stderr, "invalid parameter or value: %s\n", parameters[i]);
+      return 1;
+    }
+  }
+  if (tracePath) replay::mapPins();
+  sim::takeSerialOutput();
+  sim::usbPackets().clear();
+
+  FILE* log = nullptr;
+  if (logPath && !(log = fopen(logPath, "w"))) {
+    perror(logPath);
+    return 1;
+  }
+  int fd = open(uhidPath, O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    perror(uhidPath);
+    return 1;
+  }
+  if (!create(fd)) return 1;
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  fprintf(stderr, "virtual SpaceMouse %04x:%04x created, stop with Ctrl-C\n", SPACEMOUSE_VID, SPACEMOUSE_PID);
+
+  uint32_t startMicros = sim::now();
+  uint32_t offset = haveNext ? startMicros - next.micros : 0;  // trace time -> virtual time
+  uint64_t startNanos = monotonicNanos();
+  uint64_t reports = 0, outputs = 0, late = 0;
+  while (!stop) {
+    uint32_t elapsed = sim::now() - startMicros;
+    if (seconds > 0 && elapsed >= seconds * 1e6) break;
+    if (tracePath) {
+      if (!haveNext) break; // end of the trace
+      // the latest sample that is due, the ones before are missed by the firmware as in trace_replay
+      if ((int32_t)(sim::now() - (next.micros + offset)) >= 0) {
+        TraceSample current;
+        do {
+          current = next;
+          haveNext = trace.next(b, n, next);
+        } while (haveNext && (int32_t)(sim::now() - (next.micros + offset)) >= 0);
+        replay::useSample(current);
+      }
+    }
+    outputs += handleEvents(fd);
+
+    loop();
+
+    // the virtual clock has run while loop() read the sensors, send the reports at that time
+    uint64_t due = startNanos + (uint64_t)(sim::now() - startMicros) * 1000u;
+    if (monotonicNanos() > due) {
+      late++;
+    } else {
+      sleepUntil(due);
+    }
+    for (const sim::UsbPacket& packet : sim::usbPackets()) {
+      struct uhid_event ev;
+      memset(&ev, 0, sizeof(ev));
+      ev.type = UHID_INPUT2;
+      ev.u.input2.size = packet.data.size();
+      memcpy(ev.u.input2.data, packet.data.data(), packet.data.size());
+      uint64_t sent = monotonicNanos();
+      if (!sendEvent(fd, ev)) stop = 1;
+      if (log) {
+        fprintf(log, "%llu,", (unsigned long long)sent);
+        for (uint8_t byte : packet.data) fprintf(log, "%02x", byte);
+        fprintf(log, "\n");
+      }
+      reports++;
+    }
+    sim::usbPackets().clear();
+    sim::takeSerialOutput();
+  }
+
+  struct uhid_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.type = UHID_DESTROY;
+  sendEvent(fd, ev);
+  close(fd);
+  if (log) fclose(log);
+  fprintf(stderr, "%.1f s, %llu reports sent, %llu output reports received, %llu loop passes late\n",
+          (sim::now() - startMicros) / 1e6, (unsigned long long)reports, (unsigned long long)outputs,
+          (unsigned long long)late);
+  return 0;
+}
@@ -20,6 +20,8 @@ SpaceMouseHID_::SpaceMouseHID_() : PluggableUSBModule(2, 1, endpointTypes) {
   PluggableUSB().plug(this);
   nextState = ST_INIT; // init state machine with init state
   ledState = false;
+  sendFailed = false;
+  sentReportId = 0;
 }
 
 
@@ -170,14 +172,29 @@ bool SpaceMouseHID_::getLEDState() {
 }
 
 
-bool SpaceMouseHID_::send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x, int16_t y, int16_t z, uint8_t *keys, int debug) {
-  unsigned long now = millis();
+/// @brief Check, if the last call of send_command() couldn't send its report, e.g. while the host is suspended
+/// @return true, if USB_Send() failed
+bool SpaceMouseHID_::getSendFailed() {
+  return sendFailed;
+}
+
+
+/// @brief Get the report, which the last call of send_command() has handed to the endpoint
+/// @return report id: 1 = translations and rotations, 3 = keys, 0 = no report or it couldn't be sent
+uint8_t SpaceMouseHID_::getSentReportId() {
+  return sendFailed ? 0 : sentReportId;
+}
+
+
+bool SpaceMouseHID_::send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x, int16_t y, int16_t z, uint8_t *keys, int debug, unsigned long now) {
   bool hasSentNewData = false; // this value will be returned
+  sendFailed = false;
+  sentReportId = 0;
 
 #if (NUMKEYS > 0)
   static uint8_t keyData[4];	   // key data to be sent via HID
   static uint8_t prevKeyData[4]; // previous key data
-  prepareKeyBytes(keys, keyData, debug);		   // sort the bytes from keys into the bits in keyData
+  prepareKeyBytes(keys, keyData, debug, now);		   // sort the bytes from keys into the bits in keyData
 #endif
 
 #ifdef ADV_HID_JIGGLE
@@ -228,7 +245,8 @@ bool SpaceMouseHID_::send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x,
         jiggleValues(trans, toggleValue); // jiggle the non-zero values, if toggleValue is true
                                             // the toggleValue is toggled after sending the rotations, down below
 #endif
-        SendReport(1, trans, 12); // send new translational values
+        if (SendReport(1, trans, 12) < 0) {sendFailed = true;} // send new translational values
+        sentReportId = 1;
         lastHIDsentRep += HIDUPDATERATE_MS;
         hasSentNewData = true; // return value
 
@@ -253,7 +271,8 @@ bool SpaceMouseHID_::send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x,
     case ST_SENDKEYS:
       // report the keys, if the 8 ms since the last report have past
       if (IsNewHidReportDue(now)) {
-        SendReport(3, keyData, 4);
+        if (SendReport(3, keyData, 4) < 0) {sendFailed = true;}
+        sentReportId = 3;
         lastHIDsentRep += HIDUPDATERATE_MS;
         memcpy(prevKeyData, keyData, 4);		// copy actual keyData to previous keyData
         hasSentNewData = true;					// return value
@@ -303,19 +322,12 @@ bool SpaceMouseHID_::jiggleValues(uint8_t val[6], bool lastBit) {
 
 
 
-void SpaceMouseHID_::prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int /*debug*/)
+#if (NUMKEYS > 0)
+void SpaceMouseHID_::prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int /*debug*/, unsigned long now)
 {
   // Обнуляем выход
   for (int i = 0; i < 4; i++) keyData[i] = 0;
 
-  // Защита индексов Fn
-  #ifndef KEY_FN1_IDX
-  #  define KEY_FN1_IDX 255
-  #endif
-  #ifndef KEY_FN2_IDX
-  #  define KEY_FN2_IDX 255
-  #endif
-
   // Быстрые хелперы
   auto isFnIdx = [](int i)->bool {
     return (i == KEY_FN1_IDX) || (i == KEY_FN2_IDX);
@@ -328,8 +340,6 @@ void SpaceMouseHID_::prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int /*debu
   const bool fn1Now = (KEY_FN1_IDX < NUMKEYS) ? (keys[KEY_FN1_IDX] != 0) : false;
   const bool fn2Now = (KEY_FN2_IDX < NUMKEYS) ? (keys[KEY_FN2_IDX] != 0) : false;
 
-  unsigned long now = millis();
-
   // Карты отображения (из config.h)
   static const uint8_t baseMap[NUMHIDKEYS] = BUTTONLIST;
   #ifdef BUTTONLIST_FN1
@@ -485,6 +495,7 @@ void SpaceMouseHID_::prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int /*debu
     keyData[bn / 8] |= (uint8_t)(1u << (bn % 8));
   }
 }
+#endif // NUMKEYS > 0
 
 
 
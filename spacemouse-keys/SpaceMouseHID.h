@@ -17,6 +17,33 @@ This code is based on https://forum.arduino.cc/t/solved-unable-to-receive-hid-re
 
 #include "PluggableUSB.h"
 #include "HID.h"
+#include "config.h"
+
+// Defaults for configs without Fn keys and combo timing (see config.h)
+#ifndef KEY_FN1_IDX
+#define KEY_FN1_IDX 255 // no Fn1 key
+#endif
+#ifndef KEY_FN2_IDX
+#define KEY_FN2_IDX 255 // no Fn2 key
+#endif
+#ifndef FN_COMBO_WINDOW_MS
+#define FN_COMBO_WINDOW_MS 180
+#endif
+#ifndef FN_STICKY_MS
+#define FN_STICKY_MS 140
+#endif
+#ifndef FN_SOLO_DELAY_MS
+#define FN_SOLO_DELAY_MS 40
+#endif
+#ifndef FN_ZERO_HOLD_MS
+#define FN_ZERO_HOLD_MS 2000
+#endif
+#ifndef FN_ZERO_SAMPLES
+#define FN_ZERO_SAMPLES 800
+#endif
+#ifndef FN_ZERO_COOLDOWN_MS
+#define FN_ZERO_COOLDOWN_MS 2000
+#endif
 
 #define SPACEMOUSE_D_HIDREPORT(length) \
     {                                  \
@@ -116,7 +143,12 @@ public:
     void printAllReports();
     bool updateLEDState();
     bool getLEDState();
-    bool send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x, int16_t y, int16_t z, uint8_t *keys, int debug);
+    bool getSendFailed();
+    uint8_t getSentReportId();
+    bool send_command(int16_t rx, int16_t ry, int16_t rz, int16_t x, int16_t y, int16_t z, uint8_t *keys, int debug, unsigned long now);
+#if (NUMKEYS > 0)
+    void prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int debug, unsigned long now); // public for the micro-benchmark
+#endif
 
 private:
     bool IsNewHidReportDue(unsigned long now);
@@ -126,7 +158,6 @@ private:
 #if (NUMKEYS > 0)
     // Array with the bitnumbers, which should assign keys to buttons
     uint8_t bitNumber[NUMHIDKEYS] = BUTTONLIST;
-    void prepareKeyBytes(uint8_t *keys, uint8_t *keyData, int debug);
 #endif
     uint8_t countTransZeros = 10; // count how many times, the zero data has been sent
     uint8_t countRotZeros = 10;
@@ -134,6 +165,8 @@ private:
     unsigned long lastHIDsentRep; // time from millis(), when the last HID report was sent
 
     bool ledState;
+    bool sendFailed; // the last report of send_command() couldn't be sent
+    uint8_t sentReportId; // report id of the last report of send_command(), 0 = none
 
 protected:
     uint8_t endpointTypes[2];
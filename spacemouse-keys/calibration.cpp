@@ -4,6 +4,8 @@
 #include "calibration.h"
 #include "kinematics.h"
 #include "config.h"
+#include "logMessages.h"
+#include "scheduler.h"
 
 // a dead zone above the following value will be warned
 #define DEADZONEWARNING 10
@@ -20,8 +22,10 @@
   #define CENTERPOINTWARNINGMAX (800)
 #endif
 
+#if DEBUG_TEXT_OUTPUT > 0
 // hold characters to plot them
 char debugOutputBuffer[20];
+#endif
 
 /// @brief Prints an array to the Serial, in order to copy the output again to C-Code. Example output: {-519, -521, -512, -2, -519, -482, -508, -1}
 /// @param arr array to print
@@ -44,24 +48,118 @@ char const *axisNames[] = {"H0:", "H1:", "H2:", "H3:", "H6:", "H7:", "H8:", "H9:
 #endif
 char const *velNames[] = {"TX:", "TY:", "TZ:", "RX:", "RY:", "RZ:"}; // 6
 
+#if DEBUG_TEXT_OUTPUT > 0
+/// @brief Print one value of a debug line, e.g. "H0:  512 "
+/// @param name name of the value from axisNames or velNames
+/// @param value the value
+static void printDebugValue(char const *name, int value) {
+  sprintf(debugOutputBuffer,"%2.2s: %4d ", name, value);
+  Serial.print(debugOutputBuffer);
+}
+
+/// @brief Print one key of a debug line, e.g. "K0:1, "
+/// @param i number of the key
+/// @param value state of the key
+static void printDebugKey(uint8_t i, int value) {
+  Serial.print("K");
+  Serial.print(i);
+  Serial.print(":");
+  Serial.print(value);
+  Serial.print(", ");
+}
+
+#if TASK_SCHEDULER > 0
+// With the task scheduler a debug line is not printed within the sensing: debugLine() copies the values and
+// printDebugOutput() prints one value per call in the remaining time, so the sensing keeps its grid.
+#define DEBUG_LINE_IDLE 0xFF
+static int16_t debugValues[8 + 6];          // the sensors, then the velocities
+static int16_t debugKeys[NUMKEYS > 0 ? NUMKEYS : 1];
+static uint8_t debugSensors;                // 0 or 8
+static uint8_t debugVelocities;             // 0 or 6
+static uint8_t debugNumKeys;                // 0 or NUMKEYS
+static uint8_t debugNext = DEBUG_LINE_IDLE; // next part of the line to print
+
+/// @brief Print the next part of the debug line: a value, the separator, a key or the end of the line.
+/// Called by a task for the remaining time (TASK_SCHEDULER 1).
+void printDebugOutput() {
+  if (debugNext == DEBUG_LINE_IDLE) {
+    return;
+  }
+  uint8_t i = debugNext++;
+  if (i < debugSensors) {
+    printDebugValue(axisNames[i], debugValues[i]);
+    return;
+  }
+  i -= debugSensors;
+  if (debugSensors > 0 && debugVelocities > 0) {
+    if (i == 0) {
+      Serial.print(" || ");
+      return;
+    }
+    i--;
+  }
+  if (i < debugVelocities) {
+    printDebugValue(velNames[i], debugValues[debugSensors + i]);
+    return;
+  }
+  i -= debugVelocities;
+  if (i < debugNumKeys) {
+    printDebugKey(i, debugKeys[i]);
+    return;
+  }
+  Serial.print(DEBUG_LINE_END);
+  debugNext = DEBUG_LINE_IDLE;
+}
+#endif
+
+/// @brief Print a debug line with the sensors, the velocities and the keys, each of them is optional.
+/// With the task scheduler the values are only copied for printDebugOutput(), a line still being printed is kept.
+/// @param sensors pointer to 8 sensor values or nullptr
+/// @param velocity pointer to 6 velocities or nullptr
+/// @param keyVals pointer to NUMKEYS read keys or nullptr
+/// @param keyOut pointer to NUMKEYS debounced keys or nullptr
+static void debugLine(int *sensors, int16_t *velocity, int *keyVals, uint8_t *keyOut) {
+#if TASK_SCHEDULER > 0
+  if (debugNext != DEBUG_LINE_IDLE) {
+    return;
+  }
+  debugSensors = sensors ? 8 : 0;
+  debugVelocities = velocity ? 6 : 0;
+  debugNumKeys = (keyVals || keyOut) ? NUMKEYS : 0;
+  for (uint8_t i = 0; i < debugSensors; i++) {
+    debugValues[i] = sensors[i];
+  }
+  for (uint8_t i = 0; i < debugVelocities; i++) {
+    debugValues[debugSensors + i] = velocity[i];
+  }
+  for (uint8_t i = 0; i < debugNumKeys; i++) {
+    debugKeys[i] = keyVals ? keyVals[i] : keyOut[i];
+  }
+  debugNext = 0;
+#else
+  for (uint8_t i = 0; sensors && i < 8; i++) {
+    printDebugValue(axisNames[i], sensors[i]);
+  }
+  if (sensors && velocity) {
+    Serial.print(" || ");
+  }
+  for (uint8_t i = 0; velocity && i < 6; i++) {
+    printDebugValue(velNames[i], velocity[i]);
+  }
+  for (uint8_t i = 0; (keyVals || keyOut) && i < NUMKEYS; i++) {
+    printDebugKey(i, keyVals ? keyVals[i] : keyOut[i]);
+  }
+  Serial.print(DEBUG_LINE_END);
+#endif
+}
+
 /// @brief Report raw readings from the ADC followed by the key-inputs.
 /// @param rawReads pointer to raw-values array
 /// @param keyVals pointer to keyVals array
 void debugOutput1(int* rawReads, int* keyVals) {
   if (isDebugOutputDue()) {
     // Report back 0-1023 raw ADC 10-bit values if enabled
-    for (int i = 0; i < 8; i++) {
-      sprintf(debugOutputBuffer,"%2.2s: %4d ", axisNames[i],rawReads[i] );
-      Serial.print(debugOutputBuffer);
-    }
-    for (int i = 0; i < NUMKEYS; i++) {
-      Serial.print("K");
-      Serial.print(i);
-      Serial.print(":");
-      Serial.print(keyVals[i]);
-      Serial.print(", ");
-    }
-    Serial.print(DEBUG_LINE_END); 
+    debugLine(rawReads, nullptr, keyVals, nullptr);
   }
 }
 
@@ -69,11 +167,7 @@ void debugOutput1(int* rawReads, int* keyVals) {
 /// @param centered pointer to centered array
 void debugOutput2(int* centered) {
   if (isDebugOutputDue()) {
-    for (int i = 0; i < 8; i++) {
-      sprintf(debugOutputBuffer,"%2.2s: %4d ", axisNames[i],centered[i] );
-      Serial.print(debugOutputBuffer);
-    }
-    Serial.print(DEBUG_LINE_END); 
+    debugLine(centered, nullptr, nullptr, nullptr);
   }
 }
 
@@ -82,18 +176,7 @@ void debugOutput2(int* centered) {
 /// @param keyOut pointer to keyOut array
 void debugOutput4(int16_t* velocity, uint8_t* keyOut) {
   if (isDebugOutputDue()) {
-    for (int i = 0; i < 6; i++) {
-      sprintf(debugOutputBuffer,"%2.2s: %4d ", velNames[i],velocity[i] );
-      Serial.print(debugOutputBuffer);
-    }
-    for (int i = 0; i < NUMKEYS; i++) {
-      Serial.print("K");
-      Serial.print(i);
-      Serial.print(":");
-      Serial.print(keyOut[i]);
-      Serial.print(", ");
-    }
-    Serial.print(DEBUG_LINE_END); 
+    debugLine(nullptr, velocity, nullptr, keyOut);
   }
 }
 
@@ -102,18 +185,10 @@ void debugOutput4(int16_t* velocity, uint8_t* keyOut) {
 /// @param velocity pointer to array of 6 velocities
 void debugOutput5(int* centered, int16_t* velocity) {
   if (isDebugOutputDue()) {
-    for (int i = 0; i < 8; i++) {
-      sprintf(debugOutputBuffer,"%2.2s: %4d ", axisNames[i],centered[i] );
-      Serial.print(debugOutputBuffer);
-    }
-    Serial.print(" || ");
-    for (int i = 0; i < 6; i++) {
-      sprintf(debugOutputBuffer,"%2.2s: %4d ", velNames[i],velocity[i] );
-      Serial.print(debugOutputBuffer);
-    }
-    Serial.print(DEBUG_LINE_END); 
+    debugLine(centered, velocity, nullptr, nullptr);
   }
 }
+#endif // DEBUG_TEXT_OUTPUT
 
 
 #ifndef HALLEFFECT
@@ -125,10 +200,59 @@ void debugOutput5(int* centered, int16_t* velocity) {
 #define MINMAX_MAXWARNING (+100)
 #endif
 
+#if LIN_TABLE > 0
+/// @brief Fits LINTABLE to MINVALS and MAXVALS. The field of a magnet falls with the third power of the distance, so
+/// the value of a sensor is c(u) = K * (1 - (1 + u)^-3), when the magnet moves by u = -a..+a (relative to its distance
+/// at rest) away from the sensor. The side of the bigger values (MINVALS normally) is the near side. The ratio of the
+/// near and the far side gives a, the table then holds the movement u / a at k/LIN_SEGMENTS of MINVALS and MAXVALS.
+/// Sensors with (nearly) symmetric values get a linear table.
+/// @param par parameters with the min/max values, which get the new table
+void fitLinearTable(ParamData& par) {
+  for (uint8_t i = 0; i < 8; i++) {
+    float low  = -par.values->minVals[i];
+    float high = par.values->maxVals[i];
+    bool  mirrored = (high > low);                 // magnet the other way round: bigger values when it comes closer
+    float ratio = mirrored ? high / max(low, 1.0f) : low / max(high, 1.0f);
+    float a = 0;
+    if (low > 0 && high > 0 && ratio > 1.02) {
+      // (1 - a)^-3 - 1 = ratio * (1 - (1 + a)^-3), by bisection
+      float lower = 0, upper = 0.95;
+      for (uint8_t n = 0; n < 24; n++) {
+        a = (lower + upper) / 2;
+        if (pow(1 - a, -3) - 1 > ratio * (1 - pow(1 + a, -3))) {
+          upper = a;
+        } else {
+          lower = a;
+        }
+      }
+    }
+    float near = pow(1 - a, -3) - 1;               // c / K at the end of the near side
+    float far  = 1 - pow(1 + a, -3);               // and of the far side
+    for (uint8_t side = 0; side < 2; side++) {
+      for (uint8_t k = 1; k < LIN_SEGMENTS; k++) {
+        float p = (float)k / LIN_SEGMENTS;
+        float y = p;
+        if (a > 0) {
+          if ((side == 0) != mirrored) {
+            y = (1 - pow(1 + p * near, -1.0 / 3)) / a;
+          } else {
+            y = (pow(1 - p * far, -1.0 / 3) - 1) / a;
+          }
+        }
+        par.values->linTable[(i * 2 + side) * (LIN_SEGMENTS - 1) + k - 1] = constrain(round(y * 1000), 0, 1000);
+      }
+    }
+  }
+}
+#endif
+
 /// @brief This function records the minimum and maximum movement of the joysticks: After initialization, move the mouse for 20s and see the printed output.
+/// The result is applied to the parameters MINVALS and MAXVALS at once and saved to the EEPROM (if enabled).
+/// With LIN_TABLE the linearization LINTABLE is fitted to the new values, too.
 /// @param centered pointer to the array with the centered joystick values
+/// @param par parameters, which get the new min/max values
 /// @return returns 0 if calculations are done, else 1 while collecting data and 2 while calculating
-int calcMinMax(int* centered) {    // report internal state as function-result to inform calling loop()
+int calcMinMax(int* centered, ParamData& par) {    // report internal state as function-result to inform calling loop()
   // Variables and function to get the min and maximum value of the centered values
   static int minMaxCalcState = 0;  // little state machine -> setup in 0 -> measure in 1 -> output in 2 ->  ends with 0
   static int minValue[8];          // Array to store the minimum values
@@ -144,7 +268,7 @@ int calcMinMax(int* centered) {    // report internal state as function-result t
     }
     startTime = millis(); // Record the current time
     minMaxCalcState = 1;  // next State: measure!
-    Serial.println(F("Start moving the SpaceMouse around for 20s!"));
+    logPrintln(MSG_MINMAX_START);
 
   } else if (minMaxCalcState == 1) {
     if (millis() - startTime < 20000) {
@@ -155,13 +279,13 @@ int calcMinMax(int* centered) {    // report internal state as function-result t
       }
     } else {
       // 15s are over. go to next state and report via console
-      Serial.println(F("\r\n\r\nStop moving. These are the results for the config.h"));
+      logPrintln(MSG_MINMAX_STOP);
       minMaxCalcState = 2;
     }
 
   } else if (minMaxCalcState == 2) {
-    Serial.print(F("#define MINVALS ")); printArray(minValue, 8);
-    Serial.print(F("#define MAXVALS ")); printArray(maxValue, 8);
+    logPrint(MSG_DEFINE_MINVALS); printArray(minValue, 8);
+    logPrint(MSG_DEFINE_MAXVALS); printArray(maxValue, 8);
     #ifdef HALLEFFECT
       // Calculate and print the ranges for each HALL sensor
       int range[8];
@@ -172,29 +296,58 @@ int calcMinMax(int* centered) {    // report internal state as function-result t
         //if(minValue[i] < min) {min = minValue[i];}
         range[i] = maxValue[i] - minValue[i];
       }
-      Serial.print(F("Ranges are: ")); printArray(range, 8);
+      logPrint(MSG_RANGES); printArray(range, 8);
 
       //int centerPoint = (max - min) / 2;
       //Serial.print(F("Centerpoint: ")); Serial.print(centerPoint);
     #endif
     for(int i = 0; i < 8; i++){
       if(minValue[i] > MINMAX_MINWARNING){
-        Serial.print(F("minValue["));
+        logPrint(MSG_MINVALUE);
         Serial.print(i);
         Serial.print("] ");
         Serial.print(axisNames[i]);
-        Serial.print(F(" is small: "));
+        logPrint(MSG_IS_SMALL);
         Serial.println(minValue[i]);
       }
       if(maxValue[i] < MINMAX_MAXWARNING){
-        Serial.print(F("maxValue["));
+        logPrint(MSG_MAXVALUE);
         Serial.print(i);
         Serial.print("] ");
         Serial.print(axisNames[i]);
-        Serial.print(F(" is small: "));
+        logPrint(MSG_IS_SMALL);
         Serial.println(maxValue[i]);
       }
     }
+
+    // apply the result, so no new firmware is needed (a running save writes its snapshot)
+    for (int i = 0; i < 8; i++) {
+      par.values->minVals[i] = constrain(minValue[i], -1023, 0);
+      par.values->maxVals[i] = constrain(maxValue[i], 0, 1023);
+    }
+    #if LIN_TABLE > 0
+    fitLinearTable(par);
+    logPrint(MSG_DEFINE_LINTABLE);
+    for (uint8_t i = 0; i < LIN_TABLE_COUNT; i++) {
+      Serial.print(par.values->linTable[i]);
+      if (i % (2 * (LIN_SEGMENTS - 1)) < 2 * (LIN_SEGMENTS - 1) - 1) {
+        Serial.print(", ");
+      } else {
+        Serial.println(i < LIN_TABLE_COUNT - 1 ? ", \\" : "}");
+      }
+    }
+    #endif
+    par.changed = true;
+    #if PARAM_IN_EEPROM > 0
+    putParametersToEEPROM(par);
+    #if LIN_TABLE > 0
+    logPrintln(MSG_LINTABLE_SAVED);
+    #else
+    logPrintln(MSG_MINMAX_SAVED);
+    #endif
+    #else
+    logPrintln(MSG_MINMAX_APPLIED);
+    #endif
     minMaxCalcState = 0;  //SNo: signal end of run and prepare state-machine for next use
 
   }else{
@@ -204,6 +357,153 @@ int calcMinMax(int* centered) {    // report internal state as function-result t
   return minMaxCalcState;
 }
 
+#if KIN_MATRIX > 0
+// index of the element [i][k] (k <= i) of a symmetric 8x8 matrix stored as lower triangle
+#define LOWER(i, k) ((i) * ((i) + 1) / 2 + (k))
+
+// an axis needs more movement than 50 loop passes at a quarter of the range (target 350 / 4)
+#define KINMAT_MIN_ENERGY (50.0 * 87.5 * 87.5)
+
+/// @brief Solves the normal equations of the least squares fit: gram * row^T = cross^T for each of the 6 rows,
+/// by Cholesky decomposition of gram in place. A small ridge keeps sensors without movement at factor 0.
+/// @param gram sum of centered * centered^T, lower triangle, overwritten
+/// @param rows sums of target * centered^T, overwritten with the rows of the matrix
+/// @return false, if gram is not positive definite
+static bool solveKinematicMatrix(float* gram, float rows[6][8]) {
+  float trace = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    trace += gram[LOWER(i, i)];
+  }
+  for (uint8_t i = 0; i < 8; i++) {
+    gram[LOWER(i, i)] += trace * 1e-4;
+  }
+  // gram = L * L^T
+  for (uint8_t j = 0; j < 8; j++) {
+    float d = gram[LOWER(j, j)];
+    for (uint8_t k = 0; k < j; k++) {
+      d -= gram[LOWER(j, k)] * gram[LOWER(j, k)];
+    }
+    if (d <= 0) {
+      return false;
+    }
+    d = sqrt(d);
+    gram[LOWER(j, j)] = d;
+    for (uint8_t i = j + 1; i < 8; i++) {
+      float sum = gram[LOWER(i, j)];
+      for (uint8_t k = 0; k < j; k++) {
+        sum -= gram[LOWER(i, k)] * gram[LOWER(j, k)];
+      }
+      gram[LOWER(i, j)] = sum / d;
+    }
+  }
+  for (uint8_t r = 0; r < 6; r++) {
+    float* x = rows[r];
+    for (uint8_t i = 0; i < 8; i++) {       // L * y = row
+      for (uint8_t k = 0; k < i; k++) {
+        x[i] -= gram[LOWER(i, k)] * x[k];
+      }
+      x[i] /= gram[LOWER(i, i)];
+    }
+    for (int8_t i = 7; i >= 0; i--) {       // L^T * x = y
+      for (uint8_t k = i + 1; k < 8; k++) {
+        x[i] -= gram[LOWER(k, i)] * x[k];
+      }
+      x[i] /= gram[LOWER(i, i)];
+    }
+  }
+  return true;
+}
+
+/// @brief Guided calibration of the decoupling matrix (debug mode 21): for each axis TX..RZ the user moves the knob
+/// only along or around this axis, back and forth over the full range. The target of the moved axis is the result of
+/// the fixed factors of _calculateKinematicSensors(), the targets of the other axes are 0. The least squares fit of the
+/// 6x8 matrix from the centered values to the targets is applied to KINMATRIX at once and saved to the EEPROM (if enabled).
+/// @param centered pointer to the array with the centered values after FilterAnalogReadOuts()
+/// @param par parameters, which get the new matrix
+/// @return returns 0 if the calibration is done, else 1
+int calcKinematicMatrix(int* centered, ParamData& par) {
+  static int8_t        axis = -1;     // axis of the actual step, -1: not started
+  static bool          recording;     // false: pause before the axis, true: recording
+  static unsigned long stepStart;
+  static float         gram[36];      // sum of centered * centered^T, lower triangle
+  static float         cross[6][8];   // sum of target * centered^T, after the fit: rows of the matrix
+  static float         energy[6];     // sum of target^2 of the moved axis
+
+  if (axis < 0) {
+    memset(gram, 0, sizeof(gram));
+    memset(cross, 0, sizeof(cross));
+    memset(energy, 0, sizeof(energy));
+    logPrintln(MSG_KINMAT_START);
+    axis = 0;
+  } else if (!recording) {
+    if (millis() - stepStart >= KINMAT_PAUSE_MS) {
+      logPrintln(MSG_KINMAT_MOVE);
+      recording = true;
+      stepStart = millis();
+    }
+    return 1;
+  } else if (millis() - stepStart < KINMAT_RECORD_MS) {
+    int16_t target[6];
+    _calculateKinematicSensors(centered, target, false);
+    for (uint8_t i = 0; i < 8; i++) {
+      for (uint8_t k = 0; k <= i; k++) {
+        gram[LOWER(i, k)] += (float)centered[i] * centered[k];
+      }
+      cross[axis][i] += (float)target[axis] * centered[i];
+    }
+    energy[axis] += (float)target[axis] * target[axis];
+    return 1;
+  } else {
+    axis++;
+  }
+
+  if (axis < 6) {                     // announce the next axis
+    logPrint(MSG_KINMAT_AXIS);
+    Serial.write(velNames[axis], 3);
+    Serial.print(' ');
+    recording = false;
+    stepStart = millis();
+    return 1;
+  }
+
+  // all axes recorded: fit, print and apply the matrix
+  axis = -1;
+  logPrintln(MSG_KINMAT_STOP);
+  bool valid = true;
+  for (uint8_t j = 0; j < 6; j++) {
+    if (energy[j] < KINMAT_MIN_ENERGY) {
+      valid = false;
+    }
+  }
+  if (!valid || !solveKinematicMatrix(gram, cross)) {
+    logPrintln(MSG_KINMAT_FAILED);
+    return 0;
+  }
+
+  logPrint(MSG_DEFINE_KINMAT);
+  for (uint8_t j = 0; j < 6; j++) {
+    for (uint8_t i = 0; i < 8; i++) {
+      int16_t factor = constrain(round(cross[j][i] * 1024.0), -9999, 9999);
+      par.values->kinMatrix[j * 8 + i] = factor;
+      Serial.print(factor);
+      if (i < 7) {
+        Serial.print(", ");
+      }
+    }
+    Serial.println(j < 5 ? ", \\" : "}");
+  }
+  par.values->kinMatrixEnabled = 1;
+  par.changed = true;
+  #if PARAM_IN_EEPROM > 0
+  putParametersToEEPROM(par);
+  logPrintln(MSG_KINMAT_SAVED);
+  #else
+  logPrintln(MSG_MINMAX_APPLIED);
+  #endif
+  return 0;
+}
+#endif // KIN_MATRIX
+
 /// @brief Check, if a new debug output shall be generated. This is used in order to generate a debug line only every DEBUGDELAY ms, see config.h
 /// @return true, if debug message is due
 bool isDebugOutputDue() {
@@ -224,9 +524,9 @@ void updateFrequencyReport() {
   // increase iterations counter
   iterationsPerSecond++;
   if (millis() - lastFrequencyUpdate > 1000) {  // if one second has past: report frequency
-    Serial.print(F("Frequency: "));
+    logPrint(MSG_FREQUENCY);
     Serial.print(iterationsPerSecond);
-    Serial.println(F(" Hz"));
+    logPrintln(MSG_HZ);
     lastFrequencyUpdate = millis(); // reset timer
     iterationsPerSecond = 0;        // reset iteration counter
   }
@@ -242,9 +542,9 @@ bool busyZeroing(int *centerPoints, uint16_t numIterations, boolean debugFlag){
 
   if (debugFlag == true){
     #ifndef HALLEFFECT
-      Serial.println(F("Zeroing Joysticks..."));
+      logPrintln(MSG_ZEROING_JOY);
     #else
-      Serial.println(F("Zeroing HALL Sensors..."));
+      logPrintln(MSG_ZEROING_HALL);
     #endif
   }
 
@@ -282,7 +582,7 @@ bool busyZeroing(int *centerPoints, uint16_t numIterations, boolean debugFlag){
 
   // report everything, if with debugFlag
   if (debugFlag){
-    Serial.println(F("##  Min - Mean- Max -> Dead Zone"));
+    logPrintln(MSG_ZERO_HEADER);
     for (int i = 0; i < 8; i++){
       Serial.print(axisNames[i]);
       Serial.print(" ");
@@ -296,17 +596,17 @@ bool busyZeroing(int *centerPoints, uint16_t numIterations, boolean debugFlag){
       Serial.print(" ");
       if (deadZone[i] > DEADZONEWARNING){
         noWarningsOccured = false;
-        Serial.print(F(" Moved axis?"));
+        logPrint(MSG_MOVED_AXIS);
       }
       if (centerPoints[i] < CENTERPOINTWARNINGMIN || centerPoints[i] > CENTERPOINTWARNINGMAX){
         noWarningsOccured = false;
-        Serial.print(F(" Axis not centered?"));
+        logPrint(MSG_NOT_CENTERED);
       }
       Serial.println("");
     }
-    Serial.println(F("Using mean as zero position."));
-    Serial.print(F("Suggestion for config.h: "));
-    Serial.print(F("#define DEADZONE "));
+    logPrintln(MSG_USING_MEAN);
+    logPrint(MSG_SUGGESTION);
+    logPrint(MSG_DEFINE_DEADZONE);
     Serial.println(maxDeadZone);
   }
   return noWarningsOccured;
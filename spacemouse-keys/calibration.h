@@ -1,13 +1,38 @@
 // Header for calibration specific functions and variables
 #include "parameterMenu.h"
 
+// configs without the switch: text output of the debug modes is compiled in
+#ifndef DEBUG_TEXT_OUTPUT
+#define DEBUG_TEXT_OUTPUT 1
+#endif
+
+#if DEBUG_TEXT_OUTPUT > 0
 void debugOutput1(int* rawReads, int* keyVals);
 void debugOutput2(int* centered);
 void debugOutput4(int16_t* velocity, uint8_t* keyOut);
 void debugOutput5(int* centered, int16_t* velocity);
+void printDebugOutput(); // TASK_SCHEDULER 1: the next part of the debug line
+#else
+// text output compiled out: the debug modes stay silent
+inline void debugOutput1(int*, int*) {}
+inline void debugOutput2(int*) {}
+inline void debugOutput4(int16_t*, uint8_t*) {}
+inline void debugOutput5(int*, int16_t*) {}
+inline void printDebugOutput() {}
+#endif
 
 void printArray(int arr[], int size);
-int  calcMinMax(int* centered);
+int  calcMinMax(int* centered, ParamData& par);
+#if LIN_TABLE > 0
+void fitLinearTable(ParamData& par);
+#endif
+
+#if KIN_MATRIX > 0
+// guided calibration of the decoupling matrix in debug mode 21: per axis a pause, then the recording
+#define KINMAT_PAUSE_MS  3000
+#define KINMAT_RECORD_MS 6000
+int  calcKinematicMatrix(int* centered, ParamData& par);
+#endif
 
 bool isDebugOutputDue();
 
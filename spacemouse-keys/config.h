@@ -39,6 +39,7 @@ Debug Modes:
 
 2:  Report centered joystick values. Values should be approximately -500 to +500, jitter around 0 at idle.
 20: semi-automatic min-max calibration.
+21: guided calibration of the decoupling matrix, see KIN_MATRIX
 
 3:  Report centered joystick values. Filtered for deadzone. Approximately -350 to +350, locked to zero at idle, modified with a function.
 
@@ -47,6 +48,11 @@ Debug Modes:
 6:  Report velocity and keys after possible kill-key feature
 61: Report velocity and keys after kill-switch or ExclusiveMode
 7:  Report the frequency of the loop() -> how often is the loop() called in one second?
+71: Report run time, budget, deadline misses and overruns of each task, if TASK_SCHEDULER > 0
+72: Micro-benchmark: CPU cycles of analogRead, readAllFromJoystick, modifiers, kinematics, HID and EEPROM, if MICRO_BENCH > 0
+73: Dump the flight recorder (binary) and arm it again, if FLIGHT_RECORDER > 0
+74: Report the minimum free stack since the start, if STACK_MONITOR > 0
+75: Report the latency of the HID reports (p50, p99, max) since the last query, if LATENCY_STATS > 0
 8:  Report the bits and bytes send as button codes
 9:  Report details about the encoder wheel, if ROTARY_AXIS > 0 or ROTARY_KEYS>0
 */
@@ -76,6 +82,49 @@ Debug Modes:
 #define MINVALS {-335, -323, -379, -305, -388, -305, -381, -422}
 #define MAXVALS {118, 123, 144, 143, 113, 161, 103, 135}
 
+/* Optional: linearization
+============================ */
+// The field of the magnets falls with the third power of the distance, so the hall sensors change much more, when a
+// magnet comes closer, than when it moves away (see MINVALS and MAXVALS). With LIN_TABLE 1 each sensor gets a table,
+// that maps its values to the movement. Debug mode 20 fits the table to the min/max values and prints it as LINTABLE.
+// Off by default: the tables take 64 bytes of RAM and flash for the fit.
+#define LIN_TABLE 0
+
+/* Optional: decoupling matrix
+================================ */
+// The magnets and springs of each unit differ, so the fixed factors of the kinematics let translations leak into
+// rotations (which is covered by the gates and the exclusive mode). With KIN_MATRIX 1 debug mode 21 asks to move each
+// axis alone, fits a 6x8 matrix by least squares and stores it as KINMATRIX with KINMAT_EN 1 in the EEPROM.
+// Paste the printed result here to keep it without EEPROM. Off by default: the matrix takes 96 bytes of RAM in the
+// parameters, and the calibration needs flash.
+#define KIN_MATRIX 0
+#define KINMAT_EN  0
+
+/* Optional: sampling skew
+============================= */
+// The eight sensors are converted one after the other, the last one about 0.7 ms after the first. During fast
+// movements the kinematics combine values of different moments, which gives ghost movements on other axes.
+// With SKEW_COMP 1 the order of the conversions is symmetric, so all sensors represent the same instant:
+// SKEW_MODE 1: the order alternates with each loop pass, the result is the mean of this and the previous pass
+//              (no extra conversions, half a pass older)
+// SKEW_MODE 2: forward and backward in the same pass (twice the conversions, the loop gets slower)
+// SKEW_MODE 0: one after the other, as before
+// Off by default: the loop rates with SKEW_COMP 1 weren't measured on the Pro Micro, SKEW_MODE 2 alone doubles the
+// 832 us of the conversions. Compare the modes with host/tools/kinematics_bench (kinematics_bench_skew --motion).
+#define SKEW_COMP 0
+#define SKEW_MODE 0
+
+/* Optional: velocity filter
+============================== */
+// Low pass of the velocities with a cutoff, that rises with the speed (one euro filter): heavy smoothing, when the
+// knob is (nearly) still, almost no lag on fast moves. Check jitter and lag with host/tools/filter_bench.
+// FILT_CUT:  cutoff in Hz at rest
+// FILT_BETA: increase of the cutoff in Hz per 1000 counts/s of the velocity
+#define VEL_FILTER 1
+#define FILT_EN    0
+#define FILT_CUT   1.0
+#define FILT_BETA  4.0
+
 /* Fourth calibration: Sensitivity
 =================================== */
 #define SENS_TX     0.55   // << консоль param::2
@@ -218,6 +267,15 @@ Debug Modes:
 #define ENCODER_CLK 2
 #define ENCODER_DT 3
 
+// ENCODER_TIMED 0 (default): the Encoder library is used, RAXIS_ECH and ROTARY_KEY_STRENGTH count loop passes.
+// ENCODER_TIMED 1: the edges of the encoder are timed in an interrupt (both pins must be interrupt pins: 0, 1, 2,
+// 3 or 7), zooming and key presses do not depend on the loop rate. A count presses the key for ROTARY_KEY_MS, and
+// RAXIS_ECH changes its meaning: it is the time constant of the fading in ms, the axis falls to 37 % after RAXIS_ECH
+// ms and to 5 % after 3 * RAXIS_ECH. The 200 passes below fade linearly to 0 in ~180 ms at ~0.9 ms per pass: the
+// same zoom per count is RAXIS_ECH 90, the same end of the fading RAXIS_ECH 60 (host/encoder_timed.h uses 100).
+// Check with host/tools/encoder_bench.
+#define ENCODER_TIMED 0
+
 #define ROTARY_AXIS 0
 #define RAXIS_ECH 200
 #define RAXIS_STR 200
@@ -226,6 +284,7 @@ Debug Modes:
 #define ROTARY_KEY_IDX_A 2
 #define ROTARY_KEY_IDX_B 3
 #define ROTARY_KEY_STRENGTH 19
+#define ROTARY_KEY_MS 17
 
 /* LED support
 =============== */
@@ -236,12 +295,64 @@ Debug Modes:
 #define LEDclockOffset 0
 #define LEDUPDATERATE_MS 150
 
+/* Task scheduler
+================== */
+// 0 = loop() runs all stages one after another, as fast as possible: the loop rate depends on the debug mode.
+// 1 = loop() runs a fixed task table (scheduler.h): the sensing every SENSE_PERIOD_US, the HID report and the LEDs
+//     after it, the serial menu and ProgMode in the remaining time. Debug mode 71 shows the statistics of the tasks.
+//     8 conversions take 832 us: SENSE_PERIOD_US below ~1100 isn't possible, with SKEW_MODE 2 use at least 2000.
+#define TASK_SCHEDULER 0
+#define SENSE_PERIOD_US 1250
+
 /* Advanced debug output settings
 ================================= */
 #define DEBUGDELAY 100
 #define DEBUG_LINE_END "\r"
 //define DEBUG_LINE_END "\r\n"
 
+// Text output of the debug modes 1, 2, 3, 31, 4, 5, 6 and 61. Set to 0 to save flash (no sprintf()).
+#define DEBUG_TEXT_OUTPUT 1
+
+// Binary telemetry in debug mode 40: every TELEM_DEC-th loop pass is sent as COBS framed packet with raw,
+// centered, offset, velocity and key values, see telemetry.h. Decode it with host/tools/telemetry_decode.
+// The diagnostics below (telemetry, micro-benchmark, flight recorder, stack monitor, latency statistics) are off by
+// default: they cost flash and RAM, which weren't measured with avr-size. Switch them on to examine a unit.
+#define ENABLE_TELEMETRY 0
+#define TELEM_DEC 1
+
+// Micro-benchmark in debug mode 72: the CPU cycles of the primitives, measured with Timer1 (see microBench.h).
+#define MICRO_BENCH 0
+
+// Flight recorder: the last FLIGHT_FRAMES frames (17 bytes RAM each) in a ring buffer, frozen FLIGHT_POST_FRAMES
+// frames after a trigger: velocity spike (FLIGHT_VEL_STEP), step of a drift offset (FLIGHT_OFFSET_STEP), failed HID
+// report or the keys of FLIGHT_CHORD. Debug mode 73 dumps it, decode it with host/tools/flight_decode.
+#define FLIGHT_RECORDER 0
+#define FLIGHT_FRAMES 48
+#define FLIGHT_POST_FRAMES 12
+#define FLIGHT_VEL_STEP 200
+#define FLIGHT_OFFSET_STEP 10
+#define FLIGHT_CHORD 0
+
+// Stack monitor: the free RAM is painted at the start, debug mode 74 and ProgMode >f report the minimum free stack
+// since then (see stackMonitor.h).
+#define STACK_MONITOR 0
+
+// Latency statistics: age of the samples in the HID reports and the time from a change of the velocities to their
+// report, as histograms (168 bytes RAM). Debug mode 75 and ProgMode >h report p50, p99 and max (see latency.h).
+#define LATENCY_STATS 0
+
+// Idle mode (only with TASK_SCHEDULER 0): after IDLE_AFTER_MS without velocity and keys the whole frames run every
+// IDLE_PERIOD_MS or at once on a movement, in between each ~1 ms only one sensor, the keys and the encoder are checked
+// and the CPU sleeps until the next interrupt. While the USB is suspended the sensing stops (see idleMode.h).
+// Off by default, set to 1 to save current at rest.
+#define IDLE_MODE 0
+#define IDLE_AFTER_MS 3000
+#define IDLE_PERIOD_MS 20
+
+// Menu and diagnostic texts (see logMessages.h): 0 = plain text, 1 = only numbered tokens are sent, the texts
+// and parameter names are removed from the flash. Read the output with host/tools/log_decode.
+#define LOG_TOKENIZED 0
+
 /* Advanced USB HID settings
 ============================= */
 // #define ADV_HID_REL
@@ -0,0 +1,102 @@
+// File for the background EEPROM writer
+//
+// Writing one byte to the EEPROM takes approx. 3.3 ms. Writing a whole parameter set with EEPROM.put() or clearing
+// the EEPROM with EEPROM.update() therefore stalls the loop() for hundreds of milliseconds up to several seconds.
+// This writer uses the EEPROM-ready interrupt instead: each time the EEPROM is ready, the next changed byte is
+// written and the loop() continues to read the sensors and send HID reports in the meantime.
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "eepromWriter.h"
+
+// phases of a write job, see eepromWriter.h
+enum EepromWriterPhases {
+  EW_IDLE,       // nothing to do
+  EW_INVALIDATE, // overwrite the head with 0xFF
+  EW_BODY,       // write the body
+  EW_PUBLISH     // write the head
+};
+
+static volatile uint8_t  ewPhase = EW_IDLE;
+static volatile uint16_t ewAddress;   // next address to check
+static volatile uint16_t ewEnd;       // end of the actual phase
+static uint16_t          ewHeadStart;
+static uint16_t          ewBodyStart;
+static uint16_t          ewBodyEnd;
+static EepromSource      ewSource;
+
+/// @brief Start to write a new job in the background. A running job is restarted with the new job.
+/// @param headStart first address of the head, which is invalidated first and published last
+/// @param bodyStart first address of the body (= end of the head)
+/// @param bodyEnd   end of the body (first address not written)
+/// @param source    function delivering the byte to store for each address
+void eepromWriterStart(uint16_t headStart, uint16_t bodyStart, uint16_t bodyEnd, EepromSource source) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ewHeadStart = headStart;
+    ewBodyStart = bodyStart;
+    ewBodyEnd   = bodyEnd;
+    ewSource    = source;
+    ewAddress   = headStart;
+    ewEnd       = bodyStart;
+    ewPhase     = EW_INVALIDATE;
+    EECR |= _BV(EERIE); // the interrupt is called as soon as the EEPROM is ready
+  }
+}
+
+/// @brief Stop a running job at once, e.g. before its source changes. A byte already being written is completed by
+/// the EEPROM. The head of a stopped job may be invalid, so start a new job afterwards.
+void eepromWriterStop() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ewPhase = EW_IDLE;
+    EECR &= ~_BV(EERIE);
+  }
+}
+
+/// @brief Check if the writer is still working on a job
+/// @return true, while bytes are to be written
+bool eepromWriterBusy() {
+  return ewPhase != EW_IDLE;
+}
+
+/// @brief Block until the writer has finished. Call this before accessing the EEPROM directly.
+void eepromWriterWait() {
+  while (eepromWriterBusy()) {
+    yield();
+  }
+}
+
+/// @brief EEPROM-ready interrupt: write the next changed byte of the job
+ISR(EE_READY_vect) {
+  for (uint8_t n = 0; n < EEPROM_SCAN_PER_IRQ; n++) {
+    if (ewAddress >= ewEnd) { // phase done -> next phase
+      if (ewPhase == EW_INVALIDATE) {
+        ewPhase   = EW_BODY;
+        ewAddress = ewBodyStart;
+        ewEnd     = ewBodyEnd;
+      } else if (ewPhase == EW_BODY) {
+        ewPhase   = EW_PUBLISH;
+        ewAddress = ewHeadStart;
+        ewEnd     = ewBodyStart;
+      } else {                // job done
+        ewPhase = EW_IDLE;
+        EECR &= ~_BV(EERIE);
+        return;
+      }
+      continue;
+    }
+
+    uint16_t address = ewAddress;
+    uint8_t  value   = (ewPhase == EW_INVALIDATE) ? 0xFF : ewSource(address);
+    ewAddress = address + 1;
+
+    EEAR = address;           // read the actual content
+    EECR |= _BV(EERE);
+    if (EEDR != value) {      // write only if changed
+      EEDR = value;
+      EECR |= _BV(EEMPE);
+      EECR |= _BV(EEPE);
+      return;                 // the next byte is handled, when the EEPROM is ready again
+    }
+  }
+}
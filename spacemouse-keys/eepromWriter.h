@@ -0,0 +1,23 @@
+// Header for the background EEPROM writer
+// The writer commits one byte per EEPROM-ready interrupt, so saving parameters does not block the loop().
+#ifndef EEPROMWRITER_H
+  #define EEPROMWRITER_H
+
+  #include <Arduino.h>
+
+  // how many unchanged bytes are compared in one interrupt, before the next byte is handled in the next interrupt
+  #define EEPROM_SCAN_PER_IRQ 8
+
+  // delivers the byte, which shall be stored at the given EEPROM address
+  typedef uint8_t (*EepromSource)(uint16_t address);
+
+  // A write job consists of a head [headStart, bodyStart) and a body [bodyStart, bodyEnd):
+  // 1. the head (e.g. the magic number) is set to 0xFF first to invalidate the content,
+  // 2. the body (e.g. the parameters) is written,
+  // 3. the head is written last, to publish the new content.
+  // Only bytes that differ from the EEPROM content are written.
+  void eepromWriterStart(uint16_t headStart, uint16_t bodyStart, uint16_t bodyEnd, EepromSource source);
+  void eepromWriterStop();
+  bool eepromWriterBusy();
+  void eepromWriterWait();
+#endif
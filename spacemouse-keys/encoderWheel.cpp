@@ -12,7 +12,184 @@
 
 #if ROTARY_AXIS > 0 or ROTARY_KEYS > 0
   #include "encoderWheel.h"
+  #include "logMessages.h"
 
+  // configurations without the time based engine count the echo and the key press in loop passes
+  #ifndef ENCODER_TIMED
+    #define ENCODER_TIMED 0
+  #endif
+  #ifndef ROTARY_KEY_MS
+    #define ROTARY_KEY_MS 17
+  #endif
+
+#if ENCODER_TIMED > 0
+  /*
+   * Time based engine: the edges of the encoder are decoded in an interrupt, which also takes their time.
+   * The speed of the wheel is estimated from the time of the last full quadrature cycle (4 edges, for
+   * wheels with detents the time from one detent to the next), after the last edge it fades exponentially
+   * with the time constant RAXIS_ECH in ms. The key presses last ROTARY_KEY_MS per count.
+   * Nothing depends on the number of loop passes, so zooming and key presses are the same at any loop rate.
+   */
+  #include <avr/pgmspace.h>
+  #include <util/atomic.h>
+
+  static_assert(digitalPinToInterrupt(ENCODER_CLK) >= 0 && digitalPinToInterrupt(ENCODER_DT) >= 0,
+                "ENCODER_TIMED needs interrupt pins for ENCODER_CLK and ENCODER_DT");
+
+  #define EDGE_RING 8    // times of the last edges, power of two
+  #define EDGE_CYCLE 4   // edges of one quadrature cycle
+
+  // counts for the old state (bits 0, 1) and the new state (bits 2, 3) of CLK and DT, as in the Encoder library
+  static const int8_t quadratureStep[16] PROGMEM = {0, 1, -1, 2, -1, 0, -2, 1, 1, -2, 0, -1, 2, -1, 1, 0};
+
+  // written by encoderEdge()
+  static volatile int32_t encoderPosition;
+  static volatile uint32_t edgeMicros[EDGE_RING];
+  static volatile uint8_t edgeIndex;      // latest edge in edgeMicros
+  static volatile uint8_t edgeRun;        // intervals in the same direction before the latest edge, up to EDGE_CYCLE
+  static volatile int8_t edgeDirection;   // of the latest edge, 0: no edge yet
+  static uint8_t encoderState;            // CLK and DT at the latest edge
+
+  float simpull;             // calculated velocity of the encoder wheel
+
+  static int32_t keyPosition;    // position already turned into key presses
+  static int32_t keyMicros;      // remaining press time, > 0 key A, < 0 key B
+  static uint32_t keyLastMicros;
+
+  /// @brief Interrupt of both encoder pins: counts the edge and takes its time
+  static void encoderEdge() {
+    uint32_t now = micros();
+    uint8_t state = encoderState | (digitalRead(ENCODER_CLK) ? 4 : 0) | (digitalRead(ENCODER_DT) ? 8 : 0);
+    encoderState = state >> 2;
+    int8_t step = (int8_t)pgm_read_byte(&quadratureStep[state]);
+    if (step == 0) return;
+    encoderPosition += step;
+    int8_t direction = step > 0 ? 1 : -1;
+    if (direction != edgeDirection) {
+      // the intervals before a reversal (e.g. a bouncing contact) say nothing about the speed
+      edgeDirection = direction;
+      edgeRun = 0;
+    } else if (edgeRun < EDGE_CYCLE) {
+      edgeRun++;
+    }
+    edgeIndex = (edgeIndex + 1) & (EDGE_RING - 1);
+    edgeMicros[edgeIndex] = now;
+  }
+
+  void initEncoderWheel(){
+    pinMode(ENCODER_CLK, INPUT_PULLUP);
+    pinMode(ENCODER_DT, INPUT_PULLUP);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      encoderState = (digitalRead(ENCODER_CLK) ? 1 : 0) | (digitalRead(ENCODER_DT) ? 2 : 0);
+      edgeDirection = 0;
+      keyPosition = encoderPosition;
+    }
+    keyMicros = 0;
+    keyLastMicros = micros();
+    attachInterrupt(digitalPinToInterrupt(ENCODER_CLK), encoderEdge, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_DT), encoderEdge, CHANGE);
+  }
+
+  /// @brief Position of the encoder wheel in counts, e.g. for the idle mode
+  int32_t readEncoderWheel(){
+    int32_t position;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      position = encoderPosition;
+    }
+    return position;
+  }
+
+  /// @brief Speed of the wheel from the time of the last edges, fading exponentially after the latest edge
+  /// @param tauMillis  time constant of the fading in ms (RAXIS_ECH), at least 1 ms
+  /// @return counts per second, negative for the other direction
+  static float encoderSpeed(int16_t tauMillis) {
+    uint32_t latest, first;
+    uint8_t run;
+    int8_t direction;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      latest = edgeMicros[edgeIndex];
+      run = edgeRun;
+      first = edgeMicros[(edgeIndex - run) & (EDGE_RING - 1)];
+      direction = edgeDirection;
+    }
+    if (direction == 0) return 0;
+    uint32_t tau = tauMillis > 1 ? (uint32_t)tauMillis * 1000 : 1000;
+    uint32_t elapsed = micros() - latest;
+    if (elapsed > 8 * tau) return 0; // faded out (exp(-8) < 0.0004)
+    uint32_t span = latest - first;
+    if (run == 0 || span > tau) {
+      // first edge after a rest: one count within the fading time
+      run = 1;
+      span = tau;
+    }
+    return direction * (run * 1e6f / span) * expf(-(float)elapsed / tau);
+  }
+
+  /// @brief Calculate the encoder wheel and update the result in the velocity array
+  /// @param velocity   Array with the velocity, which gets updated at position ROTARY_AXIS-1
+  /// @param debugOut   Generate a debug output if true
+  /// @param par        struct of parameters used by the system at runtime
+  void calcEncoderWheel(int16_t *velocity, bool debugOut, ParamData& par){
+    // counts per ms times RAXIS_STR: like the counts per loop pass of the loop based engine at about 1 kHz
+    float speed = encoderSpeed(par.values->rotAxisEchos);
+    simpull = speed * par.values->rotAxisSimStrength / 1000;
+    // the ROTARY_AXIS definition is one above the array definition used for the velocity array (see calibration.h)
+    velocity[ROTARY_AXIS - 1] = velocity[ROTARY_AXIS - 1] + simpull;
+
+    if(debugOut){
+      // create debug output
+      int32_t position;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        position = encoderPosition;
+      }
+      logPrint(MSG_ENC_VAL);
+      Serial.print(position);
+      logPrint(MSG_ENC_SPEED);
+      Serial.print(speed);
+      logPrint(MSG_ENC_SIMPULL);
+      Serial.println(simpull);
+    }
+  }
+
+  /// @brief Read out the encoder and treat as keystroke: each count presses the key for ROTARY_KEY_MS
+  /// @param keyState  overwrite some keys with encoder movement
+  /// @param debugOut  Generate a debug output if true
+  void calcEncoderAsKey(uint8_t keyState[NUMKEYS], bool debugOut){
+    int32_t position;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      position = encoderPosition;
+    }
+    uint32_t now = micros();
+    uint32_t gap = now - keyLastMicros;
+    int32_t elapsed = gap < 1000000UL ? (int32_t)gap : 1000000L;
+    keyLastMicros = now;
+    // the press time runs down first, so a new press lasts ROTARY_KEY_MS from this pass on
+    if (keyMicros > 0) {
+      keyMicros = keyMicros > elapsed ? keyMicros - elapsed : 0;
+    } else if (keyMicros < 0) {
+      keyMicros = -keyMicros > elapsed ? keyMicros + elapsed : 0;
+    }
+    if (position != keyPosition) {
+      keyMicros += (position - keyPosition) * (ROTARY_KEY_MS * 1000L);
+      keyPosition = position;
+
+      if(debugOut){
+          // create debug output
+          logPrint(MSG_ENC_VAL);
+          Serial.println(position);
+      }
+    }
+
+    if(keyMicros > 0){
+        keyState[ROTARY_KEY_IDX_A] = 1;
+    }else if (keyMicros < 0){
+        keyState[ROTARY_KEY_IDX_B] = 1;
+    }else{
+        keyState[ROTARY_KEY_IDX_A] = 0;
+        keyState[ROTARY_KEY_IDX_B] = 0;
+    }
+  }
+#else
   // Include Encoder library by Paul Stoffregen
   #include <Encoder.h>
   
@@ -27,6 +204,12 @@
   void initEncoderWheel(){
     // Read initial value from encoder
     newEncoderValue = myEncoder.read();
+    previousEncoderValue = newEncoderValue;
+  }
+
+  /// @brief Position of the encoder wheel in counts, e.g. for the idle mode
+  int32_t readEncoderWheel(){
+    return myEncoder.read();
   }
   
   /// @brief Calculate the encoder wheel and update the result in the velocity array
@@ -63,11 +246,11 @@
   
     if(debugOut){
       // create debug output
-      Serial.print(F("Enc Val: "));
+      logPrint(MSG_ENC_VAL);
       Serial.print(newEncoderValue);
-      Serial.print(F(", factor: "));
+      logPrint(MSG_ENC_FACTOR);
       Serial.print(factor);
-      Serial.print(F(", simpull: "));
+      logPrint(MSG_ENC_SIMPULL);
       Serial.println(simpull);
     }
   }
@@ -103,4 +286,5 @@
         keyState[ROTARY_KEY_IDX_B] = 0;
     }
   }
+#endif // ENCODER_TIMED
 #endif // whole file is only implemented #if ROTARY_AXIS > 0 or ROTARY_KEYS > 0
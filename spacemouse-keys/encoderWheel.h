@@ -3,5 +3,6 @@
 #include "parameterMenu.h"
 
 void initEncoderWheel();
+int32_t readEncoderWheel();
 void calcEncoderWheel(int16_t* velocity, bool debugOut, ParamData& par);
 void calcEncoderAsKey(uint8_t keyState[NUMKEYS], bool debugOut);
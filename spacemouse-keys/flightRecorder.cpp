@@ -0,0 +1,168 @@
+// File for the flight recorder (debug mode 73), see flightRecorder.h
+//
+// Each frame is stored after its HID report in 17 bytes: the change of the raw values since the previous frame, the
+// velocities / 4, the keys, the time since the previous frame and flags. The absolute raw values and offsets are
+// only kept for the newest frame and sent in the header of the dump. A step of more than 127 is recorded over
+// several frames (marked FLIGHT_REC_CLIPPED), so the raw values of all frames can be calculated from the deltas.
+// The triggers are only armed, when the buffer is filled, so each dump has FLIGHT_FRAMES frames. After the trigger
+// FLIGHT_POST_FRAMES frames are recorded, then the buffer stays frozen until it is dumped. The dump sends the buffer
+// binary and arms the recorder again.
+
+#include <Arduino.h>
+#include <util/crc16.h>
+#include "config.h"
+#include "flightRecorder.h"
+#include "logMessages.h"
+
+#if FLIGHT_RECORDER > 0
+
+static FlightRecord records[FLIGHT_FRAMES];
+static uint8_t head = 0;          // index of the next record, the oldest record, when the buffer is filled
+static uint8_t filled = 0;        // number of records
+static uint8_t trigger = 0;       // FLIGHT_TRIG_* of the trigger, 0 = armed
+static uint8_t postFrames = 0;    // frames to record until the buffer is frozen
+
+// values of the newest record
+static unsigned long lastMillis = 0;
+static uint16_t lastSequence = 0;
+static int16_t lastRaw[8];
+static int16_t lastOffsets[8];
+static int16_t lastVelocity[6];
+
+/// @brief Clip a value to int8_t
+/// @param value the value
+/// @param flags set to FLIGHT_REC_CLIPPED, if the value doesn't fit
+/// @return the clipped value
+static int8_t clip8(int value, uint8_t &flags) {
+  if (value > 127) {
+    flags |= FLIGHT_REC_CLIPPED;
+    return 127;
+  }
+  if (value < -127) {
+    flags |= FLIGHT_REC_CLIPPED;
+    return -127;
+  }
+  return value;
+}
+
+/// @brief Store a frame in the ring buffer and check the triggers, unless the buffer is frozen.
+/// Called after the HID report of the frame.
+/// @param frame the frame after axisStage()
+/// @param reportSent a HID report was sent for the frame
+/// @param reportFailed the HID report couldn't be sent
+void recordFlightFrame(const Frame &frame, bool reportSent, bool reportFailed) {
+  if (trigger != 0 && postFrames == 0) {
+    return; // frozen
+  }
+
+  FlightRecord &rec = records[head];
+  uint8_t flags = 0;
+  uint8_t cause = 0;
+
+  unsigned long dt = frame.millis - lastMillis;
+  rec.dt = (dt > 255) ? 255 : dt;
+  for (uint8_t i = 0; i < 8; i++) {
+    rec.rawDelta[i] = clip8(frame.rawReads[i] - lastRaw[i], flags);
+    lastRaw[i] += rec.rawDelta[i]; // a clipped step follows in the next frames, so the deltas add up
+    int step = frame.offsets[i] - lastOffsets[i];
+    if (step != 0) {
+      flags |= FLIGHT_REC_OFFSET;
+      if (abs(step) >= FLIGHT_OFFSET_STEP) {
+        cause |= FLIGHT_TRIG_OFFSET;
+      }
+    }
+    lastOffsets[i] = frame.offsets[i];
+  }
+  for (uint8_t i = 0; i < 6; i++) {
+    rec.velocity[i] = clip8(frame.velocity[i] / 4, flags);
+    if (abs(frame.velocity[i] - lastVelocity[i]) > FLIGHT_VEL_STEP) {
+      cause |= FLIGHT_TRIG_VELOCITY;
+    }
+    lastVelocity[i] = frame.velocity[i];
+  }
+  rec.keys = 0;
+#if NUMKEYS > 0
+  for (uint8_t i = 0; i < NUMKEYS && i < 8; i++) {
+    if (frame.keyState[i]) {
+      rec.keys |= 1 << i;
+    }
+  }
+  if (FLIGHT_CHORD != 0 && (rec.keys & FLIGHT_CHORD) == FLIGHT_CHORD) {
+    cause |= FLIGHT_TRIG_CHORD;
+  }
+#endif
+  if (reportSent) {
+    flags |= FLIGHT_REC_REPORT;
+  }
+  if (reportFailed) {
+    flags |= FLIGHT_REC_DROP;
+    cause |= FLIGHT_TRIG_HID;
+  }
+  lastMillis = frame.millis;
+  lastSequence = frame.sequence;
+
+  head = (head + 1 < FLIGHT_FRAMES) ? head + 1 : 0;
+  if (filled < FLIGHT_FRAMES) {
+    filled++;
+  }
+
+  cause &= FLIGHT_TRIGGER;
+  if (trigger == 0) {
+    if (cause != 0 && filled == FLIGHT_FRAMES) {
+      trigger = cause;
+      flags |= FLIGHT_REC_TRIGGER;
+      postFrames = FLIGHT_POST_FRAMES;
+    }
+  } else {
+    postFrames--;
+  }
+  rec.flags = flags;
+}
+
+/// @brief Send the ring buffer binary (see FlightHeader) after a text line and arm the recorder again.
+/// Without a trigger before, the newest frame is marked as trigger (FLIGHT_TRIG_MANUAL).
+void dumpFlightRecorder() {
+  const uint8_t oldest = (filled < FLIGHT_FRAMES) ? 0 : head;
+  if (trigger == 0 && filled > 0) {
+    trigger = FLIGHT_TRIG_MANUAL;
+    records[(head > 0) ? head - 1 : FLIGHT_FRAMES - 1].flags |= FLIGHT_REC_TRIGGER;
+  }
+
+  FlightHeader header;
+  memcpy(header.magic, "FREC", 4);
+  header.version = FLIGHT_VERSION;
+  header.recordSize = sizeof(FlightRecord);
+  header.count = filled;
+  header.trigger = trigger;
+  header.sequence = lastSequence;
+  header.millis = lastMillis;
+  for (uint8_t i = 0; i < 8; i++) {
+    header.raw[i] = lastRaw[i];
+    header.offsets[i] = lastOffsets[i];
+  }
+
+  logPrintln(MSG_FLIGHT_DUMP);
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < sizeof(header); i++) {
+    crc = _crc_ccitt_update(crc, ((uint8_t *)&header)[i]);
+  }
+  Serial.write((uint8_t *)&header, sizeof(header));
+  for (uint8_t n = 0, i = oldest; n < filled; n++) {
+    for (uint8_t j = 0; j < sizeof(FlightRecord); j++) {
+      crc = _crc_ccitt_update(crc, ((uint8_t *)&records[i])[j]);
+    }
+    Serial.write((uint8_t *)&records[i], sizeof(FlightRecord));
+    i = (i + 1 < FLIGHT_FRAMES) ? i + 1 : 0;
+  }
+  Serial.write(lowByte(crc));
+  Serial.write(highByte(crc));
+  Serial.println();
+
+  // arm again: the next dump starts with a filled buffer
+  trigger = 0;
+  postFrames = 0;
+  filled = 0;
+  head = 0;
+}
+
+#endif // FLIGHT_RECORDER
@@ -0,0 +1,77 @@
+// Header for the flight recorder (debug mode 73)
+// A ring buffer in RAM keeps the last FLIGHT_FRAMES frames in compact form. A trigger (velocity spike, step of the
+// drift compensation, failed HID report or key chord) freezes it FLIGHT_POST_FRAMES frames later, so the dump shows
+// the frames before and after the event. Debug mode 73 sends the buffer binary and arms the recorder again.
+// The dump is decoded by host/tools/flight_decode.
+#ifndef FLIGHTRECORDER_H
+  #define FLIGHTRECORDER_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "pipeline.h"
+
+  #ifndef FLIGHT_RECORDER
+    #define FLIGHT_RECORDER 0
+  #endif
+  #ifndef FLIGHT_FRAMES
+    #define FLIGHT_FRAMES 48       // 17 bytes RAM per frame, max. 255
+  #endif
+  #ifndef FLIGHT_POST_FRAMES
+    #define FLIGHT_POST_FRAMES (FLIGHT_FRAMES / 4) // frames recorded after the trigger
+  #endif
+
+  // triggers, FLIGHT_TRIGGER selects the active ones
+  #define FLIGHT_TRIG_VELOCITY 0x01  // a velocity changes by more than FLIGHT_VEL_STEP from one frame to the next
+  #define FLIGHT_TRIG_OFFSET   0x02  // a drift compensation offset changes by FLIGHT_OFFSET_STEP or more
+  #define FLIGHT_TRIG_HID      0x04  // a HID report couldn't be sent
+  #define FLIGHT_TRIG_CHORD    0x08  // all keys of FLIGHT_CHORD are pressed
+  #define FLIGHT_TRIG_MANUAL   0x80  // no trigger before debug mode 73
+  #ifndef FLIGHT_TRIGGER
+    #define FLIGHT_TRIGGER (FLIGHT_TRIG_VELOCITY | FLIGHT_TRIG_OFFSET | FLIGHT_TRIG_HID | FLIGHT_TRIG_CHORD)
+  #endif
+  #ifndef FLIGHT_VEL_STEP
+    #define FLIGHT_VEL_STEP 200
+  #endif
+  #ifndef FLIGHT_OFFSET_STEP
+    #define FLIGHT_OFFSET_STEP 10
+  #endif
+  #ifndef FLIGHT_CHORD
+    #define FLIGHT_CHORD 0           // bit i = keyState[i], e.g. 0x03 for the keys 0 and 1, 0 = no chord
+  #endif
+
+  #define FLIGHT_VERSION 1           // change it when FlightHeader or FlightRecord changes
+
+  // flags of a record
+  #define FLIGHT_REC_REPORT  0x01    // a HID report was sent after the frame
+  #define FLIGHT_REC_DROP    0x02    // the HID report couldn't be sent
+  #define FLIGHT_REC_OFFSET  0x04    // the drift compensation offsets changed
+  #define FLIGHT_REC_CLIPPED 0x08    // a raw delta or a velocity didn't fit into int8_t
+  #define FLIGHT_REC_TRIGGER 0x10    // the frame of the trigger
+
+  // One frame in the ring buffer
+  typedef struct _FlightRecord {
+    uint8_t  dt;           // ms since the previous frame, 255 = 255 ms or more
+    uint8_t  flags;        // FLIGHT_REC_*
+    int8_t   rawDelta[8];  // change of rawReads[], max. +/-127 per frame, the rest of a larger step follows
+    int8_t   velocity[6];  // velocity[] / 4 after axisStage(), clipped to +/-127
+    uint8_t  keys;         // bit i = keyState[i], the first 8 keys
+  } __attribute__((packed)) FlightRecord;
+
+  // Start of the dump, all values little endian. The header is followed by count records (oldest first) and the
+  // CRC-16/MCRF4XX of header and records as in the telemetry. The raw values of the older frames are calculated
+  // backwards from raw[] and the deltas.
+  typedef struct _FlightHeader {
+    char     magic[4];     // "FREC"
+    uint8_t  version;      // FLIGHT_VERSION
+    uint8_t  recordSize;   // sizeof(FlightRecord)
+    uint8_t  count;        // number of records
+    uint8_t  trigger;      // FLIGHT_TRIG_* of the trigger frame
+    uint16_t sequence;     // Frame::sequence of the last record
+    uint32_t millis;       // time of the last record
+    int16_t  raw[8];       // rawReads[] of the last record (the sum of the deltas, see FLIGHT_REC_CLIPPED)
+    int16_t  offsets[8];   // offsets[] of the last record
+  } __attribute__((packed)) FlightHeader;
+
+  void recordFlightFrame(const Frame &frame, bool reportSent, bool reportFailed);
+  void dumpFlightRecorder();
+#endif
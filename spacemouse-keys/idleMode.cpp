@@ -0,0 +1,104 @@
+// File for the idle mode (IDLE_MODE 1), see idleMode.h
+//
+// The CPU sleeps in SLEEP_MODE_IDLE: the clocks of the timers and the USB keep running, so millis() stays correct
+// and the next Timer0 overflow (every 1.024 ms), a USB or a serial interrupt wake it up. The ADC noise reduction mode
+// would halt Timer0 and the USB controller, so it isn't used.
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "config.h"
+#include "idleMode.h"
+#include "kinematics.h"
+#include "spaceKeys.h"
+#if ROTARY_AXIS > 0 || ROTARY_KEYS > 0
+  #include "encoderWheel.h"
+#endif
+
+#if IDLE_MODE > 0
+
+static bool idle = false;
+static unsigned long restStart = 0; // time of the last frame with a velocity or a key
+static unsigned long lastFrame = 0; // time of the last frame
+static uint8_t nextSensor = 0;      // sensor of the next motion check
+#if ROTARY_AXIS > 0 || ROTARY_KEYS > 0
+static int32_t encoderAtFrame = 0;  // position of the encoder wheel at the last frame
+#endif
+
+/// @brief Check the frame for a movement or a key and enter or leave the idle mode. Call this after each frame.
+/// @param frame the frame after axisStage()
+/// @param allowed false: the idle mode is left and not entered, e.g. in the debug modes
+void updateIdle(const Frame &frame, bool allowed) {
+  bool rest = allowed;
+  for (uint8_t i = 0; i < 6 && rest; i++) {
+    rest = (frame.velocity[i] == 0);
+  }
+#if NUMKEYS > 0
+  for (uint8_t i = 0; i < NUMKEYS && rest; i++) {
+    rest = (frame.keyState[i] == 0);
+  }
+#endif
+  lastFrame = frame.millis;
+#if ROTARY_AXIS > 0 || ROTARY_KEYS > 0
+  encoderAtFrame = readEncoderWheel();
+#endif
+  if (!rest) {
+    restStart = frame.millis;
+    idle = false;
+  } else if (frame.millis - restStart >= IDLE_AFTER_MS) {
+    idle = true;
+  }
+}
+
+/// @brief Check, if the next frame shall run completely
+/// @return true, if not idle or IDLE_PERIOD_MS have passed since the last whole frame
+bool idleFrameDue() {
+  return !idle || millis() - lastFrame >= IDLE_PERIOD_MS;
+}
+
+/// @brief Cheap check for a movement between the whole frames: converts one sensor in turn and checks it as
+/// filterStage() would see it, with the offsets of the drift compensation of the last whole frame, then the keys and
+/// the encoder wheel
+/// @param frame the frame after beginFrame(), sets one of rawReads[] and keyVals[]
+/// @param centerPoints the centre positions of the sensors
+/// @param par struct of parameters used by the system at runtime
+/// @return true, if the sensor is beyond the deadzone, a key is pressed or the encoder wheel was turned
+bool idleMotion(Frame &frame, const int *centerPoints, ParamData &par) {
+  const int16_t deadzone = PARAM_VALUE(par, deadzone, DEADZONE);
+  uint8_t i = nextSensor;
+  nextSensor = (nextSensor + 1) & 7;
+  frame.rawReads[i] = readOneFromJoystick(i);
+  int centered = frame.rawReads[i] - centerPoints[i] + frame.offsets[i];
+  if (centered >= deadzone || centered <= -deadzone) {
+    return true;
+  }
+#if NUMKEYS > 0
+  readAllFromKeys(frame.keyVals);
+  for (uint8_t k = 0; k < NUMKEYS; k++) {
+    if (!frame.keyVals[k]) { // pulled to ground, see evalKeys()
+      return true;
+    }
+  }
+#endif
+#if ROTARY_AXIS > 0 || ROTARY_KEYS > 0
+  if (readEncoderWheel() != encoderAtFrame) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+/// @brief Check for the idle mode
+/// @return true, while the frames run every IDLE_PERIOD_MS
+bool isIdle() {
+  return idle;
+}
+
+/// @brief Sleep until the next interrupt, at the latest the next Timer0 overflow of millis()
+void idleSleep() {
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sleep_cpu();
+  sleep_disable();
+}
+
+#endif // IDLE_MODE
@@ -0,0 +1,36 @@
+// Header for the idle mode (IDLE_MODE 1)
+// When the velocities are zero and no key is pressed for IDLE_AFTER_MS, the whole frames (8 conversions, the
+// calculations and the HID report) run only every IDLE_PERIOD_MS. In between each pass of loop() only converts one
+// sensor in turn and reads the keys and the encoder wheel (idleMotion()), polls the LED state of the host and then
+// the CPU sleeps until the next interrupt, at the latest ~1 ms. A sensor beyond the deadzone, a pressed key or a
+// turned encoder runs the whole frame at once; a frame with a velocity or a key leaves the idle mode. A movement is
+// seen within 8 passes (1 pass, if it moves all sensors) or the next whole frame.
+// While the host has suspended the USB bus, the sensing stops and the CPU sleeps.
+#ifndef IDLEMODE_H
+  #define IDLEMODE_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "pipeline.h"
+  #include "scheduler.h"
+
+  #ifndef IDLE_MODE
+    #define IDLE_MODE 0
+  #endif
+  #ifndef IDLE_AFTER_MS
+    #define IDLE_AFTER_MS 3000 // time at rest before the idle mode
+  #endif
+  #ifndef IDLE_PERIOD_MS
+    #define IDLE_PERIOD_MS 20  // period of the whole frames in the idle mode, e.g. for the drift compensation
+  #endif
+
+  #if IDLE_MODE > 0 && TASK_SCHEDULER > 0
+    #error "IDLE_MODE needs TASK_SCHEDULER 0: the scheduler keeps the sensing on its fixed grid"
+  #endif
+
+  void updateIdle(const Frame &frame, bool allowed);
+  bool idleFrameDue();
+  bool idleMotion(Frame &frame, const int *centerPoints, ParamData &par);
+  bool isIdle();
+  void idleSleep();
+#endif
@@ -40,15 +40,15 @@ int modifierFunction(int x, ParamData& par) {
   double xn = abs((double)x / (double)TOTALSENSITIVITY);  // normalize x
   double sx = sign(x);                                    // detect sign of x
 
-  if(par.values->modFunc == 1){
+  if(PARAM_VALUE(par, modFunc, MODFUNC) == 1){
     // using "squared" function y = abs(x)^a * sign(x)
     // sign putting out -1 or 1 depending on sign of x. (Is needed because x^2 will always be positive)
-    y = pow(xn, par.values->slope_at_zero) * sx;
+    y = pow(xn, PARAM_VALUE(par, slope_at_zero, MOD_A)) * sx;
 
     // modFunc 2: tan is not supported anymore, because squared tangens serves the same purpose
-  }else if(par.values->modFunc == 3){
+  }else if(PARAM_VALUE(par, modFunc, MODFUNC) == 3){
     // using "squared" tangens function: y = tan(b * (abs(x)^a * sign(x))) / tan(b)
-    y = tan(par.values->slope_at_end * (pow(xn, par.values->slope_at_zero) * sx)) / tan(par.values->slope_at_end);
+    y = tan(PARAM_VALUE(par, slope_at_end, MOD_B) * (pow(xn, PARAM_VALUE(par, slope_at_zero, MOD_A)) * sx)) / tan(PARAM_VALUE(par, slope_at_end, MOD_B));
 
   }else{
     //MODFUNC == 0 or others...
@@ -62,42 +62,275 @@ int modifierFunction(int x, ParamData& par) {
   return (int)round(y);
 }
 
+// tables for the hot path, derived from the parameters PINLIST, INVERTLIST, MINVALS, MAXVALS by updateJoystickTables()
+static uint8_t pinList[8];
+static bool    invertList[8];
+static int     minVals[8];
+static int     maxVals[8];
+#if SKEW_COMP > 0
+static uint8_t skewMode;      // SKEW_MODE
+static bool    skewPrevious;  // SKEW_MODE 1: the values of the last pass are valid
+#endif
+
+#if LIN_TABLE > 0
+// linearization for the hot path, derived from LINTABLE, MINVALS, MAXVALS and DEADZONE by updateLinearTables():
+// per sensor and side (0 negative, 1 positive) the points in -350..+350 units and the factor, that turns the distance
+// from the deadzone into the position in 1/256 segments. The lookup needs two multiplications instead of the division
+// of map().
+static int16_t  linPoints[8][2][LIN_SEGMENTS + 1];
+static uint32_t linScale[8][2];
+
+/// @brief Calculate linPoints[] and linScale[] from LINTABLE and the input ranges of the sensors.
+/// @param par parameters
+static void updateLinearTables(ParamData& par){
+  for (uint8_t i = 0; i < 8; i++) {
+    for (uint8_t side = 0; side < 2; side++) {
+      // > 0, see minVals[] and maxVals[]
+      long range = side ? maxVals[i] - par.values->deadzone : -par.values->deadzone - minVals[i];
+      linScale[i][side] = (((uint32_t)LIN_SEGMENTS << 16) + range / 2) / range;
+      const int16_t* table = &par.values->linTable[(i * 2 + side) * (LIN_SEGMENTS - 1)];
+      linPoints[i][side][0] = 0;
+      for (uint8_t k = 1; k < LIN_SEGMENTS; k++) {
+        linPoints[i][side][k] = ((long)table[k - 1] * TOTALSENSITIVITY + 500) / 1000;
+      }
+      linPoints[i][side][LIN_SEGMENTS] = TOTALSENSITIVITY;
+    }
+  }
+}
+
+/// @brief Linearize a centered value outside of the deadzone by the table of its sensor.
+/// Values beyond MINVALS or MAXVALS continue the last segment, as map() did.
+/// @param value centered value, abs(value) >= deadzone
+/// @param i number of the sensor
+/// @param deadzone DEADZONE
+/// @return movement -350..+350
+static int _linearize(int value, uint8_t i, int deadzone){
+  uint8_t  side     = (value > 0);
+  uint16_t distance = side ? value - deadzone : -value - deadzone;
+  uint32_t position = ((uint32_t)distance * linScale[i][side]) >> 8;  // in 1/256 segments
+  uint8_t  segment  = min(position >> 8, (uint32_t)LIN_SEGMENTS - 1);
+  int32_t  fraction = position - ((uint32_t)segment << 8);              // > 256 beyond the last point
+  const int16_t* point = linPoints[i][side];
+  int32_t  result   = point[segment] + (((point[segment + 1] - point[segment]) * fraction + 128) >> 8);
+  return side ? result : -result;
+}
+#endif
+
+#if VEL_FILTER > 0
+// speed adaptive low pass of the velocities (one euro filter), see _filterVelocity(). The tables are derived from
+// FILT_CUT and FILT_BETA by updateJoystickTables(), all values are fixed point.
+#define FILTER_MAX_INPUT 2047        // keeps the products in int32_t, the modifiers limit to 350 anyway
+static uint16_t filterMinCutoff;     // FILT_CUT in 1/16 Hz
+static uint16_t filterBeta;          // FILT_BETA in 1/16 Hz per count/s, in 1/65536
+static bool     filterValid;         // false: start at the actual values
+static int32_t  filterValue[6];      // filtered velocity in 1/16
+static int16_t  filterRest[6];       // remainder of the last step in 1/16384, so small differences add up
+static int32_t  filterSpeed[6];      // low pass (1 Hz) of its speed in counts/s
+static unsigned long filterMicros;   // time of the last pass
+
+/// @brief Low pass of each velocity with a cutoff, that rises with the speed of the axis: heavy smoothing, when the
+/// knob is (nearly) still, almost no lag on fast moves. cutoff = FILT_CUT + FILT_BETA * speed / 1000 counts/s.
+/// The filter steps are forward Euler: alpha = 2 pi cutoff dt, limited to 1 (pass through), so no division is needed.
+/// @param velocity pointer to array of 6 velocities
+/// @param now time of the velocities in us (Frame::micros), the filter doesn't read the clock itself
+static void _filterVelocity(int16_t* velocity, unsigned long now){
+  uint32_t dt = min(now - filterMicros, 20000UL);       // us, longer pauses (e.g. menus) count as 20 ms
+  filterMicros = now;
+  // alpha in 1/16384 = cutoff in 1/16 Hz * dt * 2 pi * 16384 / 16 / 10^6 = cutoff * dt * 0.006434
+  uint32_t dtFactor   = (dt * 422 + 128) >> 8;          // dt * 0.006434 in 1/256
+  int32_t  speedAlpha = (16 * dtFactor + 128) >> 8;     // 1 Hz
+  for (uint8_t a = 0; a < 6; a++) {
+    int32_t x = (int32_t)constrain(velocity[a], -FILTER_MAX_INPUT, FILTER_MAX_INPUT) << 4;
+    if (!filterValid) {
+      filterValue[a] = x;
+      filterSpeed[a] = 0;
+      filterRest[a]  = 0;
+    }
+    int32_t delta = x - filterValue[a];
+    // speed += alpha * (delta / dt - speed): alpha * delta / dt = 2 pi * 1 Hz * delta / 16 = delta * 201 / 512
+    filterSpeed[a] += ((delta * 201) >> 9) - ((filterSpeed[a] * speedAlpha) >> 14);
+    uint32_t speed  = min((uint32_t)abs(filterSpeed[a]), 65535UL);
+    uint32_t cutoff = min(filterMinCutoff + ((speed * filterBeta) >> 16), 16000UL);
+    uint32_t alpha  = min((cutoff * dtFactor + 128) >> 8, 16384UL);
+    int32_t step = delta * (int32_t)alpha + filterRest[a];
+    filterValue[a] += step >> 14;
+    filterRest[a]   = step & 16383;
+    velocity[a] = (filterValue[a] + 8) >> 4;
+  }
+  filterValid = true;
+}
+#endif
+
+#if KIN_MATRIX > 0
+// decoupling matrix for the hot path: the rows of KINMATRIX with the inversion and the sensitivity of their axis
+// folded in, each row scaled by 2^kinShift[] to use 8 bits, so each coefficient is a multiplication of 8 by 16 bit.
+// Only the coefficients, which are not 0 after the scaling, are kept: kinTerms[] per row, kinCount[] of them. The
+// fixed factors need 2 to 4 (resistive) or 4 to 8 (hall effect) of the 8 sensors per row, a calibrated matrix of the
+// resistive joysticks about 5. Row 6 is TZ with SENS_NTZ, row 2 with SENS_PTZ. 8 * 127 * 32767 still fits into the int32_t.
+#define KIN_ROWS     7
+#define KIN_ROW_NTZ  6
+#define KIN_ROW_MAX  127
+struct KinTerm {
+  int8_t  coef;   // scaled coefficient
+  uint8_t input;  // index of the centered value
+};
+static KinTerm kinTerms[KIN_ROWS][8];
+static uint8_t kinCount[KIN_ROWS];
+static uint8_t kinShift[KIN_ROWS];
+
+/// @brief Calculate kinTerms[], kinCount[] and kinShift[] from KINMATRIX, INVX..INVRZ and the sensitivities.
+/// @param par parameters
+static void updateKinematicTables(ParamData& par){
+  const int8_t inv[6]  = {par.values->invX, par.values->invY, par.values->invZ,
+                          par.values->invRX, par.values->invRY, par.values->invRZ};
+  const double sens[KIN_ROWS] = {par.values->transX_sensitivity, par.values->transY_sensitivity,
+                                 par.values->pos_transZ_sensitivity, par.values->rotX_sensitivity,
+                                 par.values->rotY_sensitivity, par.values->rotZ_sensitivity,
+                                 par.values->neg_transZ_sensitivity};
+  for (uint8_t j = 0; j < KIN_ROWS; j++) {
+    uint8_t axis   = (j == KIN_ROW_NTZ) ? TRANSZ : j;
+    double  factor = ((inv[axis] == 1) ? -1.0 : 1.0) / (1024.0 * sens[j]);
+    double  biggest = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      biggest = max(biggest, fabs(par.values->kinMatrix[axis * 8 + i] * factor));
+    }
+    uint8_t shift = 0;
+    while (shift < 30 && biggest * (2.0 * (1L << shift)) <= KIN_ROW_MAX) {
+      shift++;
+    }
+    kinShift[j] = shift;
+    kinCount[j] = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      long coef = round(par.values->kinMatrix[axis * 8 + i] * factor * (1L << shift));
+      if (coef != 0) {
+        kinTerms[j][kinCount[j]].coef  = constrain(coef, -KIN_ROW_MAX, KIN_ROW_MAX);
+        kinTerms[j][kinCount[j]].input = i;
+        kinCount[j]++;
+      }
+    }
+  }
+}
+
+/// @brief Number of multiplications of a row of the decoupling matrix, for the tools (kinematics_bench --cost)
+/// @param row TRANSX..ROTZ or 6 for TZ with SENS_NTZ
+uint8_t kinematicMatrixTerms(uint8_t row){
+  return kinCount[row];
+}
+
+/// @brief One row of the decoupling matrix times the centered values, rounded.
+static int16_t _kinematicRow(int* centered, uint8_t j){
+  int32_t sum = 0;
+  for (uint8_t k = 0; k < kinCount[j]; k++) {
+    sum += (int32_t)kinTerms[j][k].coef * (int16_t)centered[kinTerms[j][k].input]; // 8 x 16 bit
+  }
+  if (kinShift[j] > 0) {
+    sum = (sum + (1L << (kinShift[j] - 1))) >> kinShift[j];
+  }
+  return constrain(sum, -32767L, 32767L);
+}
+#endif
+
+/// @brief Calculate the tables used by readAllFromJoystick(), FilterAnalogReadOuts() and calculateKinematic() from the
+/// parameters. Call this at startup and every time the parameters were changed.
+/// @param par parameters with the pins, the inversion and the min/max values of the joysticks
+void updateJoystickTables(ParamData& par){
+  for (int i = 0; i < 8; i++) {
+    pinList[i]    = par.values->pinList[i];
+    invertList[i] = (par.values->invertList[i] == 1);
+    // keep the input ranges of map() in FilterAnalogReadOuts() > 0
+    minVals[i]    = min(par.values->minVals[i], -par.values->deadzone - 1);
+    maxVals[i]    = max(par.values->maxVals[i], par.values->deadzone + 1);
+  }
+  #if VEL_FILTER > 0
+  filterMinCutoff = constrain(round(par.values->filterMinCutoff * 16), 0, 16000);
+  filterBeta      = constrain(round(par.values->filterBeta * 16 / 1000 * 65536), 0, 65535);
+  filterValid     = false;
+  #endif
+  #if SKEW_COMP > 0
+  skewMode     = par.values->skewMode;
+  skewPrevious = false;
+  #endif
+  #if LIN_TABLE > 0
+  updateLinearTables(par);
+  #endif
+  #if KIN_MATRIX > 0
+  updateKinematicTables(par);
+  #endif
+}
+
+/// @brief Read one sensor, inverted according to INVERTLIST.
+static int _readSensor(uint8_t i){
+  if (invertList[i]) {
+    // invert the reading
+    return 1023 - analogRead(pinList[i]);
+  } else {
+    return analogRead(pinList[i]);
+  }
+}
+
+/// @brief Read one sensor, e.g. for the motion check of the idle mode
+/// @param i index of the sensor in PINLIST
+/// @return 0-1023, inverted according to INVERTLIST
+int readOneFromJoystick(uint8_t i){
+  return _readSensor(i);
+}
+
 /// @brief Function to read and store analogue voltages for each joystick axis.
+/// With SKEW_COMP the conversions are ordered symmetrically in time (see SKEW_MODE in config.h): sensor i is
+/// converted i steps after the start of a forward and i steps before the end of a backward pass, so the mean of
+/// both passes belongs to the same instant for all sensors.
 /// @param rawReads pointer to 8 analog values
 void readAllFromJoystick(int *rawReads){
-  // define an array for reading the analog pins of the joysticks, see config.h
-  static int pinList[8] = PINLIST;
-  static int invertList[8] = INVERTLIST;
+  #if SKEW_COMP > 0
+  static int  previous[8];     // SKEW_MODE 1: the last pass
+  static bool backward = false;
 
-  for (int i = 0; i < 8; i++) {
-    if (invertList[i] == 1) {
-      // invert the reading
-      rawReads[i] = 1023 - analogRead(pinList[i]);
-    } else {
-      rawReads[i] = analogRead(pinList[i]);
+  if (skewMode == 2) {
+    for (uint8_t i = 0; i < 8; i++) {
+      rawReads[i] = _readSensor(i);
     }
+    for (int8_t i = 7; i >= 0; i--) {
+      rawReads[i] = (rawReads[i] + _readSensor(i) + 1) >> 1;
+    }
+    return;
+  } else if (skewMode == 1) {
+    for (uint8_t n = 0; n < 8; n++) {
+      uint8_t i = backward ? 7 - n : n;
+      int value = _readSensor(i);
+      rawReads[i] = skewPrevious ? (value + previous[i] + 1) >> 1 : value;
+      previous[i] = value;
+    }
+    backward     = !backward;
+    skewPrevious = true;
+    return;
+  }
+  #endif
+  for (int i = 0; i < 8; i++) {
+    rawReads[i] = _readSensor(i);
   }
 }
 
 /// @brief Takes the centered joystick values, applies a deadzone and maps the values to +/- 350.
+/// With LIN_TABLE the table of each sensor replaces the straight lines of map(), see _linearize().
 /// @param centered pointer to array with 8 centered analog values
 void FilterAnalogReadOuts(int *centered, ParamData& par){
-  // set the min and maxvals from the config.h into real variables
-  static int minVals[8] = MINVALS;
-  static int maxVals[8] = MAXVALS;
-
+  const int16_t deadzone = PARAM_VALUE(par, deadzone, DEADZONE);
     // Filter movement values. Set to zero if movement is below deadzone threshold.
   for(int i = 0; i < 8; i++){
-    if (centered[i] < par.values->deadzone && centered[i] > -par.values->deadzone){
+    if (centered[i] < deadzone && centered[i] > -deadzone){
             centered[i] = 0;
     }else{
+      #if LIN_TABLE > 0
+      centered[i] = _linearize(centered[i], i, deadzone);
+      #else
       if(centered[i] < 0){ // if the value is smaller 0 ...
         // ... map the value from the [min,-DEADZONE] to [-350,0]
-        centered[i] = map(centered[i], minVals[i], -par.values->deadzone, -TOTALSENSITIVITY, 0);
+        centered[i] = map(centered[i], minVals[i], -deadzone, -TOTALSENSITIVITY, 0);
       }else{ // if the value is > 0 ...
         // ... map the values from the [DEADZONE,max] to [0,+350]
-        centered[i] = map(centered[i], par.values->deadzone, maxVals[i], 0, TOTALSENSITIVITY);
+        centered[i] = map(centered[i], deadzone, maxVals[i], 0, TOTALSENSITIVITY);
       }
+      #endif
     }
   }
 }
@@ -137,6 +370,25 @@ void FilterAnalogReadOuts(int *centered, ParamData& par){
  *
  */
 
+#ifndef HALLEFFECT
+/// @brief Resistive joysticks: at least 3 of the 4 joysticks move up (or down) and none the other way, the knob is
+/// mainly pushed or pulled.
+/// @param centered eight values from the four joysticks
+static bool _zMove(int* centered){
+  int cntN = 0;
+  int cntP = 0;
+  if(centered[AX] < 0){cntN += 1;} if(centered[AX] > 0){cntP += 1;}
+  if(centered[BX] < 0){cntN += 1;} if(centered[BX] > 0){cntP += 1;}
+  if(centered[CX] < 0){cntN += 1;} if(centered[CX] > 0){cntP += 1;}
+  if(centered[DX] < 0){cntN += 1;} if(centered[DX] > 0){cntP += 1;}
+  return ((cntP >= 3 && cntN == 0) || (cntN >= 3 && cntP == 0));
+}
+#endif
+
+/// @brief Kinematics with the fixed factors of the table above
+/// @param centered eight values from the four joysticks or eight hall-sensors
+/// @param velocity resulting translational and rotational motions, before inversion and sensitivity
+/// @param prio_z_exclusive resistive joysticks: no rotation, while the knob is pushed or pulled
 void _calculateKinematicSensors(int* centered, int16_t* velocity, bool prio_z_exclusive){
   // resistive joysticks or hall-joysticks
   #ifndef HALLEFFECT
@@ -149,14 +401,7 @@ void _calculateKinematicSensors(int* centered, int16_t* velocity, bool prio_z_ex
   So this code sees that min. 3 of 4 joysticks all move up (or down) and use it as an indicator that the knob is mainly pushed/pulled. So before any (ghost-)rotational component can be calculated, it is sorted out.
   That should only support the exclusive-logic for smallest signals to surpress little undesired rotations.
   */
-  int cntN = 0;
-  int cntP = 0;
-  if(centered[AX] < 0){cntN += 1;} if(centered[AX] > 0){cntP += 1;}
-  if(centered[BX] < 0){cntN += 1;} if(centered[BX] > 0){cntP += 1;}
-  if(centered[CX] < 0){cntN += 1;} if(centered[CX] > 0){cntP += 1;}
-  if(centered[DX] < 0){cntN += 1;} if(centered[DX] > 0){cntP += 1;}
-
-    bool zMove = ((cntP >= 3 && cntN == 0) || (cntN >= 3 && cntP == 0));
+  bool zMove = _zMove(centered);
 
     velocity[TRANSX] = (-centered[CY] +centered[AY]);
     velocity[TRANSY] = (-centered[BY] +centered[DY]);
@@ -187,58 +432,100 @@ void _calculateKinematicSensors(int* centered, int16_t* velocity, bool prio_z_ex
 }
 
 /// @brief Calculate the kinematic of the three axis from the eight joysticks
+/// With FILT_EN the velocities are filtered before the modifiers, see _filterVelocity().
+/// With KINMAT_EN the decoupling matrix KINMATRIX replaces the fixed factors, the inversion and the division by the
+/// sensitivities: per axis one multiplication of 8 by 16 bit for each coefficient, which is not 0, instead of the sum
+/// and a floating point division (counted by kinematics_bench --cost, the time on the AVR is not measured). The
+/// exclusive mode (EXCLUSIVE) of the resistive joysticks applies to both.
 /// @param centered eight values from the four joysticks or eight hall-sensors
 /// @param velocity resulting translational and rotational motions
-void calculateKinematic(int *centered, int16_t *velocity, ParamData& par){
-  // Get raw kinematics from sensors
-  _calculateKinematicSensors(centered, velocity, par.values->exclusiveMode);
-
-  // Invert directions if needed. Done first so the direction-dependand factors modify the right direction.
-  if(par.values->invX  == 1){velocity[TRANSX] = -velocity[TRANSX];}
-  if(par.values->invY  == 1){velocity[TRANSY] = -velocity[TRANSY];}
-  if(par.values->invZ  == 1){velocity[TRANSZ] = -velocity[TRANSZ];}
-  if(par.values->invRX == 1){velocity[ROTX]   = -velocity[ROTX];}
-  if(par.values->invRY == 1){velocity[ROTY]   = -velocity[ROTY];}
-  if(par.values->invRZ == 1){velocity[ROTZ]   = -velocity[ROTZ];}
+/// @param now time of the sampling of the sensors in us (Frame::micros), used by the velocity filter
+void calculateKinematic(int *centered, int16_t *velocity, ParamData& par, unsigned long now){
+  #if KIN_MATRIX > 0
+  if (par.values->kinMatrixEnabled == 1) {
+    velocity[TRANSX] = _kinematicRow(centered, TRANSX);
+    velocity[TRANSY] = _kinematicRow(centered, TRANSY);
+    velocity[TRANSZ] = _kinematicRow(centered, TRANSZ);
+    if (velocity[TRANSZ] < 0) {
+      velocity[TRANSZ] = _kinematicRow(centered, KIN_ROW_NTZ);
+    }
+    #ifndef HALLEFFECT
+    if (PARAM_VALUE(par, exclusiveMode, EXCLUSIVE) && _zMove(centered)) { // prio-z-exclusive mode, see above
+      velocity[ROTX] = 0;
+      velocity[ROTY] = 0;
+      velocity[ROTZ] = 0;
+    } else
+    #endif
+    {
+      velocity[ROTX] = _kinematicRow(centered, ROTX);
+      velocity[ROTY] = _kinematicRow(centered, ROTY);
+      velocity[ROTZ] = _kinematicRow(centered, ROTZ);
+    }
+  } else
+  #endif
+  {
+    // Get raw kinematics from sensors
+    _calculateKinematicSensors(centered, velocity, PARAM_VALUE(par, exclusiveMode, EXCLUSIVE));
+
+    // Invert directions if needed. Done first so the direction-dependand factors modify the right direction.
+    if(PARAM_VALUE(par, invX, INVX)  == 1){velocity[TRANSX] = -velocity[TRANSX];}
+    if(PARAM_VALUE(par, invY, INVY)  == 1){velocity[TRANSY] = -velocity[TRANSY];}
+    if(PARAM_VALUE(par, invZ, INVZ)  == 1){velocity[TRANSZ] = -velocity[TRANSZ];}
+    if(PARAM_VALUE(par, invRX, INVRX) == 1){velocity[ROTX]   = -velocity[ROTX];}
+    if(PARAM_VALUE(par, invRY, INVRY) == 1){velocity[ROTY]   = -velocity[ROTY];}
+    if(PARAM_VALUE(par, invRZ, INVRZ) == 1){velocity[ROTZ]   = -velocity[ROTZ];}
+
+    velocity[TRANSX] = velocity[TRANSX] / PARAM_VALUE(par, transX_sensitivity, SENS_TX);
+    velocity[TRANSY] = velocity[TRANSY] / PARAM_VALUE(par, transY_sensitivity, SENS_TY);
+    if(velocity[TRANSZ] < 0){
+      velocity[TRANSZ] = velocity[TRANSZ] / PARAM_VALUE(par, neg_transZ_sensitivity, SENS_NTZ);
+    }else{                                                                                // pulling the knob upwards is much heavier... smaller factor
+      velocity[TRANSZ] = constrain(velocity[TRANSZ] / PARAM_VALUE(par, pos_transZ_sensitivity, SENS_PTZ), (double)-TOTALSENSITIVITY, (double)TOTALSENSITIVITY);
+    }
+    velocity[ROTX] = velocity[ROTX] / PARAM_VALUE(par, rotX_sensitivity, SENS_RX);
+    velocity[ROTY] = velocity[ROTY] / PARAM_VALUE(par, rotY_sensitivity, SENS_RY);
+    velocity[ROTZ] = velocity[ROTZ] / PARAM_VALUE(par, rotZ_sensitivity, SENS_RZ);
+  }
+
+  #if VEL_FILTER > 0
+  if (PARAM_VALUE(par, filterEnabled, FILT_EN) == 1) {
+    _filterVelocity(velocity, now);
+  }
+  #else
+  (void)now;
+  #endif
 
   // transX
-  velocity[TRANSX] = velocity[TRANSX] / par.values->transX_sensitivity;
   velocity[TRANSX] = modifierFunction(velocity[TRANSX], par);                             // recalculate with modifier function
 
   // transY
-  velocity[TRANSY] = velocity[TRANSY] / par.values->transY_sensitivity;
   velocity[TRANSY] = modifierFunction(velocity[TRANSY], par);                             // recalculate with modifier function
 
   // transZ
   if(velocity[TRANSZ] < 0){
-    velocity[TRANSZ] = velocity[TRANSZ] / par.values->neg_transZ_sensitivity;
     velocity[TRANSZ] = modifierFunction(velocity[TRANSZ], par);                           // recalculate with modifier function
-    if (abs(velocity[TRANSZ]) < par.values->gate_neg_transZ){
+    if (abs(velocity[TRANSZ]) < PARAM_VALUE(par, gate_neg_transZ, GATE_NTZ)){
       velocity[TRANSZ] = 0;
     }
-  }else{                                                                                  // pulling the knob upwards is much heavier... smaller factor
-    velocity[TRANSZ] = velocity[TRANSZ] / par.values->pos_transZ_sensitivity;
-    velocity[TRANSZ] = constrain(velocity[TRANSZ], (double)-TOTALSENSITIVITY, (double)TOTALSENSITIVITY);  // no modifier function, just constrain linear!
+  }else{
+    velocity[TRANSZ] = constrain(velocity[TRANSZ], -TOTALSENSITIVITY, TOTALSENSITIVITY);  // no modifier function, just constrain linear!
   }
 
   // rotX
-  velocity[ROTX] = velocity[ROTX] / par.values->rotX_sensitivity;
   velocity[ROTX] = modifierFunction(velocity[ROTX], par);                                 // recalculate with modifier function
-  if(abs(velocity[ROTX]) < par.values->gate_rotX){
+  if(abs(velocity[ROTX]) < PARAM_VALUE(par, gate_rotX, GATE_RX)){
     velocity[ROTX] = 0;
   }
 
   // rotY
-  velocity[ROTY] = velocity[ROTY] / par.values->rotY_sensitivity;
   velocity[ROTY] = modifierFunction(velocity[ROTY], par); // recalculate with modifier function
-  if(abs(velocity[ROTY]) < par.values->gate_rotY){
+  if(abs(velocity[ROTY]) < PARAM_VALUE(par, gate_rotY, GATE_RY)){
     velocity[ROTY] = 0;
   }
 
   // rotZ
-  velocity[ROTZ] = velocity[ROTZ] / par.values->rotZ_sensitivity;
   velocity[ROTZ] = modifierFunction(velocity[ROTZ], par); // recalculate with modifier function
-  if(abs(velocity[ROTZ]) < par.values->gate_rotZ){
+  if(abs(velocity[ROTZ]) < PARAM_VALUE(par, gate_rotZ, GATE_RZ)){
     velocity[ROTZ] = 0;
   }
 } // end calculateKinematic
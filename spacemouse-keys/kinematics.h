@@ -5,11 +5,18 @@
 
 int modifierFunction(int x, ParamData& par);
 
+void updateJoystickTables(ParamData& par);
+
 void readAllFromJoystick(int *rawReads);
+int readOneFromJoystick(uint8_t i);
 
 void FilterAnalogReadOuts(int* centered, ParamData& par);
 
-void calculateKinematic(int* centered, int16_t* velocity, ParamData& par);
+void calculateKinematic(int* centered, int16_t* velocity, ParamData& par, unsigned long now);
+void _calculateKinematicSensors(int* centered, int16_t* velocity, bool prio_z_exclusive);
+#if KIN_MATRIX > 0
+uint8_t kinematicMatrixTerms(uint8_t row);
+#endif
 
 void switchXY(int16_t *velocity);
 void switchYZ(int16_t *velocity);
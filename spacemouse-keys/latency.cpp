@@ -0,0 +1,146 @@
+// File for the latency statistics (debug mode 75, ProgMode >h), see latency.h
+//
+// A latency of v = us / LATENCY_UNIT_US units is counted in bin v for v < 8, above in bin 4 * octave + (v >> octave)
+// with v >> octave = 4..7: four bins per octave. The statistics are cleared after each query, so each query covers
+// the time since the previous one.
+
+#include <Arduino.h>
+#include "config.h"
+#include "latency.h"
+#include "logMessages.h"
+
+#if LATENCY_STATS > 0
+
+static LatencyHistogram sampleAge;      // reading the sensors -> report in the endpoint
+static LatencyHistogram motionToReport; // first changed frame -> report with the velocities
+
+static int16_t reported[6];             // velocities of the last report
+static bool pending = false;            // a frame differs from the last report
+static unsigned long pendingMicros = 0; // Frame::micros of the first of these frames
+
+/// @brief Count a latency in a histogram
+/// @param hist the histogram
+/// @param us latency in us
+static void addLatency(LatencyHistogram &hist, unsigned long us) {
+  unsigned long v = us / LATENCY_UNIT_US;
+  uint8_t octave = 0;
+  while (v >= 8) {
+    v >>= 1;
+    octave++;
+  }
+  uint8_t bin = 4 * octave + v;
+  if (bin >= LATENCY_BINS) {
+    bin = LATENCY_BINS - 1;
+  }
+  if (hist.count[bin] == 0xFFFF) {
+    for (uint8_t i = 0; i < LATENCY_BINS; i++) {
+      hist.count[i] >>= 1;
+    }
+  }
+  hist.count[bin]++;
+  hist.reports++;
+  if (us > hist.max) {
+    hist.max = us;
+  }
+}
+
+/// @brief Get a percentile of a histogram
+/// @param hist the histogram
+/// @param percent 1..100
+/// @return upper bound of the bin of the percentile in us, not more than the maximum
+static unsigned long percentile(const LatencyHistogram &hist, uint8_t percent) {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < LATENCY_BINS; i++) {
+    total += hist.count[i];
+  }
+  uint32_t target = (total * percent + 99) / 100;
+  uint32_t sum = 0;
+  uint8_t bin = 0;
+  for (; bin < LATENCY_BINS - 1; bin++) {
+    sum += hist.count[bin];
+    if (sum >= target) {
+      break;
+    }
+  }
+  if (bin == LATENCY_BINS - 1) {
+    return hist.max; // the last bin has no upper bound
+  }
+  unsigned long upper = (bin < 4) ? (unsigned long)(bin + 1) * LATENCY_UNIT_US
+                                  : ((unsigned long)((bin & 3) + 5) * LATENCY_UNIT_US) << ((bin - 4) >> 2);
+  return min(upper, hist.max);
+}
+
+/// @brief Count the latencies of a frame, called after send_command() for every frame
+/// @param frame the frame, which send_command() got
+/// @param reportId 1 = translations and rotations, 3 = keys, 0 = no report (or it couldn't be sent)
+/// @param sentMicros micros() after send_command()
+void recordLatency(const Frame &frame, uint8_t reportId, unsigned long sentMicros) {
+  if (!pending && memcmp(frame.velocity, reported, sizeof(reported)) != 0) {
+    pending = true;
+    pendingMicros = frame.micros;
+  }
+  if (reportId == 0) {
+    return;
+  }
+  addLatency(sampleAge, sentMicros - frame.micros);
+  if (reportId == 1) {
+    if (pending) {
+      addLatency(motionToReport, sentMicros - pendingMicros);
+      pending = false;
+    }
+    memcpy(reported, frame.velocity, sizeof(reported));
+  }
+}
+
+/// @brief Print the number of reports, p50, p99 and the maximum in us of one histogram
+/// @param hist the histogram
+/// @param prog true: separated by ';' for ProgMode, false: text
+static void printHistogram(const LatencyHistogram &hist, bool prog) {
+  if (!prog) {
+    logPrint(MSG_LATENCY_COUNT);
+  }
+  Serial.print(hist.reports);
+  if (prog) {
+    Serial.print(';');
+  } else {
+    logPrint(MSG_LATENCY_P50);
+  }
+  Serial.print(percentile(hist, 50));
+  if (prog) {
+    Serial.print(';');
+  } else {
+    logPrint(MSG_LATENCY_P99);
+  }
+  Serial.print(percentile(hist, 99));
+  if (prog) {
+    Serial.print(';');
+  } else {
+    logPrint(MSG_LATENCY_MAX);
+  }
+  Serial.print(hist.max);
+}
+
+/// @brief Print the statistics since the last query and clear them
+/// @param prog true: "<h<reports>;<p50>;<p99>;<max>;<reports>;<p50>;<p99>;<max>" (sample age, motion to report) for
+/// ProgMode >h, false: two text lines for debug mode 75
+void printLatencyStats(bool prog) {
+  if (prog) {
+    Serial.print(F("<h"));
+  } else {
+    logPrint(MSG_LATENCY_SAMPLE);
+  }
+  printHistogram(sampleAge, prog);
+  if (prog) {
+    Serial.print(';');
+  } else {
+    Serial.println();
+    logPrint(MSG_LATENCY_MOTION);
+  }
+  printHistogram(motionToReport, prog);
+  Serial.println();
+
+  memset(&sampleAge, 0, sizeof(sampleAge));
+  memset(&motionToReport, 0, sizeof(motionToReport));
+}
+
+#endif // LATENCY_STATS
@@ -0,0 +1,31 @@
+// Header for the latency statistics (debug mode 75, ProgMode >h)
+// Each frame carries the time, when its sensors were read (Frame::micros). After send_command() handed a report to
+// the endpoint, two latencies are counted in histograms:
+// - sample age: from reading the sensors of the frame in the report until the report is in the endpoint
+// - motion to report: from the first frame, whose velocities differ from the last report, until the next report with
+//   the velocities. This includes the wait for IsNewHidReportDue().
+// The percentiles are the upper bounds of the bins (above 256 us 4 bins per octave, 12..25 % wide), the maximum is
+// exact.
+#ifndef LATENCY_H
+  #define LATENCY_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "pipeline.h"
+
+  #ifndef LATENCY_STATS
+    #define LATENCY_STATS 0
+  #endif
+
+  #define LATENCY_UNIT_US 32 // width of the first 8 bins
+  #define LATENCY_BINS    40 // then 4 bins per octave up to 65 ms, longer latencies count in the last bin
+
+  typedef struct _LatencyHistogram {
+    uint16_t      count[LATENCY_BINS]; // halved, when a bin overflows, so the percentiles stay valid
+    uint32_t      reports;             // number of reports since the last query
+    unsigned long max;                 // longest latency in us
+  } LatencyHistogram;
+
+  void recordLatency(const Frame &frame, uint8_t reportId, unsigned long sentMicros);
+  void printLatencyStats(bool prog);
+#endif
@@ -16,6 +16,9 @@ void rotateColor(boolean clockwise, CRGB color);
 
 CRGB leds[LEDRING];
 
+// a changed frame waits up to this long after LEDUPDATERATE_MS for a HID report, before it is sent anyway
+#define LED_MAX_DEFER_MS 20
+
 
 /// @brief Initialize the LED ring. Call this once during setup()
 void initLEDring()
@@ -23,17 +26,40 @@ void initLEDring()
     FastLED.addLeds<WS2811, LEDpin, GRB>(leds, LEDRING);
 }
 
-/// @brief process the LEDs connected via FastLED. Call this in loop()
+/// @brief process the LEDs connected via FastLED. Call this in loop(), right after the HID report.
+/// FastLED.show() disables the interrupts for about 30 us per LED, so the ring is only sent, if the frame has changed,
+/// and preferably in the loop pass, which has just sent a HID report: the next report and the next ADC reading are
+/// then a whole loop pass away.
 /// @param velocity array with velocity informations
 /// @param ledCmd transmit if the LED shall be on (as it may be demanded over USB)
-void processLED(int16_t *velocity, boolean ledCmd)
+/// @param reportSent a HID report has been sent in this loop pass
+void processLED(int16_t *velocity, boolean ledCmd, bool reportSent)
 {
     unsigned long now = millis();
     static unsigned long lastLEDupdate = now;
-    
+    static uint8_t shownFrame = 0; // frame on the ring: 0 = nothing shown yet
 
     if (now - lastLEDupdate >= LEDUPDATERATE_MS)
     {
+        // the frame is given by the LED command or the main axis and its direction
+        int8_t mainVelocity = getMainVelocity(velocity);
+        uint8_t frame = 0xFF;
+        if (!ledCmd)
+        {
+            frame = 1 + 2 * (mainVelocity + 1) + (mainVelocity >= 0 && velocity[mainVelocity] > 0);
+        }
+        if (frame == shownFrame && (ledCmd || mainVelocity != ROTZ))
+        {
+            // unchanged, only the rotation of ROTZ is animated
+            lastLEDupdate += LEDUPDATERATE_MS;
+            return;
+        }
+        if (!reportSent && now - lastLEDupdate < LEDUPDATERATE_MS + LED_MAX_DEFER_MS)
+        {
+            return; // wait for the gap after the next HID report
+        }
+        shownFrame = frame;
+
         setAllLEDs(CRGB::Black);
         if (ledCmd)
         {
@@ -43,7 +69,7 @@ void processLED(int16_t *velocity, boolean ledCmd)
         else
         {
             // USB doesn't send us commands to turn on LED
-            switch (getMainVelocity(velocity))
+            switch (mainVelocity)
             {
             case TRANSX:
                 setAllLEDs(CRGB::Yellow);
@@ -3,7 +3,7 @@
 
 void initLEDring();
 
-void processLED(int16_t *velocity, boolean ledCmd);
+void processLED(int16_t *velocity, boolean ledCmd, bool reportSent);
 
 int8_t getMainVelocity(int16_t *velocity);
 
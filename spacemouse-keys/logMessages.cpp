@@ -0,0 +1,17 @@
+// File for the tokenized log messages, see logMessages.h
+
+#include <Arduino.h>
+#include "config.h"
+#include "logMessages.h"
+
+#if LOG_TOKENIZED > 0
+
+/// @brief Send a message as token: LOG_TOKEN_MARKER and the number of the message.
+/// host/tools/log_decode replaces it by the text from logMessages.h.
+/// @param id number of the message, MSG_...
+void logToken(uint8_t id) {
+  uint8_t token[2] = {LOG_TOKEN_MARKER, id};
+  Serial.write(token, 2);
+}
+
+#endif // LOG_TOKENIZED
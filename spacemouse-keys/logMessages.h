@@ -0,0 +1,216 @@
+// Header for the menu and diagnostic messages
+//
+// All texts of the menus and the diagnostic output are collected here. They are printed with logPrint(MSG_...)
+// and logPrintln(MSG_...):
+// - LOG_TOKENIZED 0 (default): the text is stored in flash and printed, as with Serial.print(F("...")).
+// - LOG_TOKENIZED 1: only LOG_TOKEN_MARKER and the number of the message are sent, the texts don't use any flash.
+//   The parameter names are sent as token, too. host/tools/log_decode prints the texts again.
+//   The answers of the ProgMode (except the names of >d) stay plain text.
+//
+// to add a message: define its text as MSG_<NAME>_T and append MSG_<NAME> to LOG_MESSAGES.
+// The position in LOG_MESSAGES is the number of the message: only append, so log_decode stays compatible.
+#ifndef LOGMESSAGES_H
+  #define LOGMESSAGES_H
+
+  #include <Arduino.h>
+  #include "config.h"
+
+  #ifndef LOG_TOKENIZED
+    #define LOG_TOKENIZED 0
+  #endif
+
+  #define LOG_TOKEN_MARKER 0x1E // ASCII record separator, followed by the number of the message
+
+  // debug menu in loop()
+  #define MSG_DEBUG_TITLE_T      "\r\n\r\nSpaceMouse FW"
+  #define MSG_DEBUG_MODES_T      " - Debug Modes"
+  #define MSG_DEBUG_ESC_T        "ESC stop running mode, leave menu (ESC, Q)"
+  #define MSG_DEBUG_1_T          "  1 raw sensors ADC values full range, max. 0..1023"
+  #define MSG_DEBUG_10_T         " 10 raw sensors ADC values used range, max. 0..1023"
+  #define MSG_DEBUG_2_T          "  2 centered values -500..+500"
+  #define MSG_DEBUG_11_T         " 11 auto calibrate centers, show deadzones"
+  #define MSG_DEBUG_20_T         " 20 find min/max-values over 20s (move stick)"
+  #define MSG_DEBUG_21_T         " 21 calibrate decoupling matrix (guided, 54s)"
+  #define MSG_DEBUG_3_T          "  3 centered values w.deadzones -350..+350"
+  #define MSG_DEBUG_31_T         " 31 drift compensation offsets"
+  #define MSG_DEBUG_4_T          "  4 velocity- (trans-/rot-)values -350..+350"
+  #define MSG_DEBUG_5_T          "  5 centered- & velocity-values, (3) and (4)"
+  #define MSG_DEBUG_6_T          "  6 velocity after kill-keys and keys"
+  #define MSG_DEBUG_61_T         " 61 velocity after axis-switch, exclusive"
+  #define MSG_DEBUG_40_T         " 40 binary telemetry (1,3,31,4 + keys)"
+  #define MSG_DEBUG_7_T          "  7 loop-frequency-test"
+  #define MSG_DEBUG_71_T         " 71 task statistics of the scheduler"
+  #define MSG_DEBUG_72_T         " 72 micro-benchmark, CPU cycles (Timer1)"
+  #define MSG_DEBUG_73_T         " 73 flight recorder: binary dump, then armed again"
+  #define MSG_DEBUG_74_T         " 74 minimum free stack since the start"
+  #define MSG_DEBUG_75_T         " 75 latency of the HID reports since the last query"
+  #define MSG_DEBUG_8_T          "  8 key-test, button-codes to send"
+  #define MSG_DEBUG_9_T          "  9 encoder wheel-test"
+  #define MSG_DEBUG_30_T         " 30 parameters (load, save, edit, view)"
+  #define MSG_DEBUG_PROMPT_T     "mode::"
+  #define MSG_AREF_5V_T          "Setting analog reference to 5V."
+  #define MSG_AREF_256_T         "Setting analog reference to 2.56V."
+
+  // calibration
+  #define MSG_MINMAX_START_T     "Start moving the SpaceMouse around for 20s!"
+  #define MSG_MINMAX_STOP_T      "\r\n\r\nStop moving. These are the results for the config.h"
+  #define MSG_DEFINE_MINVALS_T   "#define MINVALS "
+  #define MSG_DEFINE_MAXVALS_T   "#define MAXVALS "
+  #define MSG_RANGES_T           "Ranges are: "
+  #define MSG_MINVALUE_T         "minValue["
+  #define MSG_MAXVALUE_T         "maxValue["
+  #define MSG_IS_SMALL_T         " is small: "
+  #define MSG_MINMAX_SAVED_T     "Applied, saving MINVALS and MAXVALS to EEPROM in background."
+  #define MSG_MINMAX_APPLIED_T   "Applied until the next restart."
+  #define MSG_FREQUENCY_T        "Frequency: "
+  #define MSG_HZ_T               " Hz"
+  #define MSG_ZEROING_JOY_T      "Zeroing Joysticks..."
+  #define MSG_ZEROING_HALL_T     "Zeroing HALL Sensors..."
+  #define MSG_ZERO_HEADER_T      "##  Min - Mean- Max -> Dead Zone"
+  #define MSG_MOVED_AXIS_T       " Moved axis?"
+  #define MSG_NOT_CENTERED_T     " Axis not centered?"
+  #define MSG_USING_MEAN_T       "Using mean as zero position."
+  #define MSG_SUGGESTION_T       "Suggestion for config.h: "
+  #define MSG_DEFINE_DEADZONE_T  "#define DEADZONE "
+  #define MSG_KINMAT_START_T     "Move the knob only along or around the shown axis, back and forth over the full range."
+  #define MSG_KINMAT_AXIS_T      "\r\nNext axis: "
+  #define MSG_KINMAT_MOVE_T      "move now!"
+  #define MSG_KINMAT_STOP_T      "\r\nStop moving. This is the result for the config.h"
+  #define MSG_DEFINE_KINMAT_T    "#define KINMAT_EN 1\r\n#define KINMATRIX {"
+  #define MSG_KINMAT_FAILED_T    "Not enough movement recorded, the matrix is unchanged."
+  #define MSG_KINMAT_SAVED_T     "Applied, saving KINMAT_EN and KINMATRIX to EEPROM in background."
+  #define MSG_DEFINE_LINTABLE_T  "#define LINTABLE {"
+  #define MSG_LINTABLE_SAVED_T   "Applied, saving MINVALS, MAXVALS and LINTABLE to EEPROM in background."
+
+  // encoder wheel
+  #define MSG_ENC_VAL_T          "Enc Val: "
+  #define MSG_ENC_FACTOR_T       ", factor: "
+  #define MSG_ENC_SIMPULL_T      ", simpull: "
+  #define MSG_ENC_SPEED_T        ", counts/s: "
+
+  // task scheduler
+  #define MSG_TASK_T             "task "
+  #define MSG_TASK_MAX_T         ": max us "
+  #define MSG_TASK_BUDGET_T      ", budget "
+  #define MSG_TASK_MISSES_T      ", misses "
+  #define MSG_TASK_OVERRUNS_T    ", overruns "
+  #define MSG_WDT_ALARMS_T       "watchdog alarms: "
+  #define MSG_WDT_TASK_T         ", last in task "
+
+  // micro-benchmark (debug mode 72): name, min / mean cycles
+  #define MSG_BENCH_HEADER_T     "cycles min / mean of 16 runs, F_CPU "
+  #define MSG_BENCH_SEP_T        " / "
+  #define MSG_BENCH_OVERFLOW_T   " overflow"
+  #define MSG_BENCH_COLON_T      ": "
+  #define MSG_BENCH_ANALOG_T     "analogRead: "
+  #define MSG_BENCH_JOYSTICK_T   "readAllFromJoystick: "
+  #define MSG_BENCH_MODFUNC_T    "modifierFunction MODFUNC "
+  #define MSG_BENCH_FILTER_T     "FilterAnalogReadOuts: "
+  #define MSG_BENCH_KINEMATIC_T  "calculateKinematic: "
+  #define MSG_BENCH_KEYBYTES_T   "prepareKeyBytes: "
+  #define MSG_BENCH_SEND_IDLE_T  "send_command, no report due: "
+  #define MSG_BENCH_SEND_DUE_T   "send_command, report due: "
+  #define MSG_BENCH_EEPROM_SAME_T  "EEPROM.update, same value: "
+  #define MSG_BENCH_EEPROM_WRITE_T "EEPROM.update, write: "
+
+  // flight recorder (debug mode 73), the binary dump follows the line
+  #define MSG_FLIGHT_DUMP_T      "flight recorder dump:"
+
+  // stack monitor (debug mode 74)
+  #define MSG_STACK_FREE_T       "free stack min: "
+  #define MSG_STACK_BYTES_T      " bytes"
+
+  // latency statistics (debug mode 75), in us
+  #define MSG_LATENCY_SAMPLE_T   "sample age us"
+  #define MSG_LATENCY_MOTION_T   "motion to report us"
+  #define MSG_LATENCY_COUNT_T    ": n "
+  #define MSG_LATENCY_P50_T      " p50 <= "
+  #define MSG_LATENCY_P99_T      " p99 <= "
+  #define MSG_LATENCY_MAX_T      " max "
+
+  // parameter menu
+  #define MSG_PARAM_TITLE_T      "\r\nSpaceMouse FW"
+  #define MSG_PARAM_MENU_T       " - Parameters"
+  #define MSG_PARAM_ESC_T        "ESC leave parameter-menu (ESC, Q)"
+  #define MSG_PARAM_1_T          "  1  list parameters"
+  #define MSG_PARAM_2_T          "  2  edit parameters"
+  #define MSG_PARAM_3_T          "  3  load from EEPROM"
+  #define MSG_PARAM_4_T          "  4  save to EEPROM"
+  #define MSG_PARAM_5_T          "  5  clear EEPROM to 0xFF"
+  #define MSG_PARAM_6_T          "  6  set EEPROM params invalid"
+  #define MSG_PARAM_7_T          "  7  list parameters as defines"
+  #define MSG_PARAM_PROMPT_T     "param::"
+  #define MSG_LOADING_T          "loading parameters from EEPROM"
+  #define MSG_SAVING_T           "saving parameters to EEPROM in background"
+  #define MSG_CLEARING_T         "clearing EEPROM in background"
+  #define MSG_INVALIDATING_T     "setting EEPROM params invalid"
+  #define MSG_EDIT_ENTER_T       "enter number of parameter to edit (ESC, Q to leave)"
+  #define MSG_EDIT_PROMPT_T      "edit::"
+  #define MSG_EDIT_ELEMENT_T     "\r\nenter element 0.."
+  #define MSG_ARROW_T            " -> "
+  #define MSG_UNCHANGED_T        "unchanged"
+  #define MSG_OUT_OF_RANGE_T     "out of range, unchanged"
+  #define MSG_MIGRATING_T        "Migrating EEPROM!"
+  #define MSG_WRONG_MAGIC_T      "Wrong magic!"
+  #define MSG_WRONG_VERSION_T    "Wrong version!"
+  #define MSG_WRONG_CRC_T        "Wrong CRC!"
+  #define MSG_WRONG_RECORDS_T    "Wrong records!"
+  #define MSG_EEPROM_BUSY_T      "EEPROM busy, try again"
+
+  // name of a parameter: the token is followed by the number of the parameter (one byte),
+  // log_decode prints the name from paramDescription with this format
+  #define MSG_PARAM_NAME_T       "%s"
+  #define MSG_PARAM_NAME_PAD_T   "%-10s" // left aligned to MAX_PARAM_NAME_LEN, see printParameterName()
+
+  // all messages, the position is the number of the token
+  #define LOG_MESSAGES(X) \
+    X(MSG_DEBUG_TITLE) X(MSG_DEBUG_MODES) X(MSG_DEBUG_ESC) \
+    X(MSG_DEBUG_1) X(MSG_DEBUG_10) X(MSG_DEBUG_2) X(MSG_DEBUG_11) X(MSG_DEBUG_20) X(MSG_DEBUG_3) X(MSG_DEBUG_31) \
+    X(MSG_DEBUG_4) X(MSG_DEBUG_5) X(MSG_DEBUG_6) X(MSG_DEBUG_61) X(MSG_DEBUG_40) X(MSG_DEBUG_7) X(MSG_DEBUG_8) \
+    X(MSG_DEBUG_9) X(MSG_DEBUG_30) X(MSG_DEBUG_PROMPT) X(MSG_AREF_5V) X(MSG_AREF_256) \
+    X(MSG_MINMAX_START) X(MSG_MINMAX_STOP) X(MSG_DEFINE_MINVALS) X(MSG_DEFINE_MAXVALS) X(MSG_RANGES) \
+    X(MSG_MINVALUE) X(MSG_MAXVALUE) X(MSG_IS_SMALL) X(MSG_MINMAX_SAVED) X(MSG_MINMAX_APPLIED) X(MSG_FREQUENCY) \
+    X(MSG_HZ) X(MSG_ZEROING_JOY) X(MSG_ZEROING_HALL) X(MSG_ZERO_HEADER) X(MSG_MOVED_AXIS) X(MSG_NOT_CENTERED) \
+    X(MSG_USING_MEAN) X(MSG_SUGGESTION) X(MSG_DEFINE_DEADZONE) \
+    X(MSG_ENC_VAL) X(MSG_ENC_FACTOR) X(MSG_ENC_SIMPULL) \
+    X(MSG_PARAM_TITLE) X(MSG_PARAM_MENU) X(MSG_PARAM_ESC) X(MSG_PARAM_1) X(MSG_PARAM_2) X(MSG_PARAM_3) \
+    X(MSG_PARAM_4) X(MSG_PARAM_5) X(MSG_PARAM_6) X(MSG_PARAM_7) X(MSG_PARAM_PROMPT) X(MSG_LOADING) X(MSG_SAVING) \
+    X(MSG_CLEARING) X(MSG_INVALIDATING) X(MSG_EDIT_ENTER) X(MSG_EDIT_PROMPT) X(MSG_EDIT_ELEMENT) X(MSG_ARROW) \
+    X(MSG_UNCHANGED) X(MSG_OUT_OF_RANGE) X(MSG_MIGRATING) X(MSG_WRONG_MAGIC) X(MSG_WRONG_VERSION) \
+    X(MSG_WRONG_CRC) X(MSG_PARAM_NAME) X(MSG_PARAM_NAME_PAD) \
+    X(MSG_DEBUG_21) X(MSG_KINMAT_START) X(MSG_KINMAT_AXIS) X(MSG_KINMAT_MOVE) X(MSG_KINMAT_STOP) X(MSG_DEFINE_KINMAT) \
+    X(MSG_KINMAT_FAILED) X(MSG_KINMAT_SAVED) X(MSG_DEFINE_LINTABLE) X(MSG_LINTABLE_SAVED) \
+    X(MSG_ENC_SPEED) \
+    X(MSG_DEBUG_71) X(MSG_TASK) X(MSG_TASK_MAX) X(MSG_TASK_BUDGET) X(MSG_TASK_MISSES) X(MSG_TASK_OVERRUNS) \
+    X(MSG_WDT_ALARMS) X(MSG_WDT_TASK) \
+    X(MSG_DEBUG_72) X(MSG_BENCH_HEADER) X(MSG_BENCH_SEP) X(MSG_BENCH_OVERFLOW) X(MSG_BENCH_COLON) X(MSG_BENCH_ANALOG) \
+    X(MSG_BENCH_JOYSTICK) X(MSG_BENCH_MODFUNC) X(MSG_BENCH_FILTER) X(MSG_BENCH_KINEMATIC) X(MSG_BENCH_KEYBYTES) \
+    X(MSG_BENCH_SEND_IDLE) X(MSG_BENCH_SEND_DUE) X(MSG_BENCH_EEPROM_SAME) X(MSG_BENCH_EEPROM_WRITE) \
+    X(MSG_DEBUG_73) X(MSG_FLIGHT_DUMP) \
+    X(MSG_DEBUG_74) X(MSG_STACK_FREE) X(MSG_STACK_BYTES) \
+    X(MSG_DEBUG_75) X(MSG_LATENCY_SAMPLE) X(MSG_LATENCY_MOTION) X(MSG_LATENCY_COUNT) X(MSG_LATENCY_P50) \
+    X(MSG_LATENCY_P99) X(MSG_LATENCY_MAX) \
+    X(MSG_WRONG_RECORDS) X(MSG_EEPROM_BUSY)
+
+  #define LOG_ENUM(id) id,
+  enum LogMessages { LOG_MESSAGES(LOG_ENUM) NUM_LOG_MESSAGES };
+  #undef LOG_ENUM
+
+  #if LOG_TOKENIZED > 0
+    void logToken(uint8_t id);
+    #define logPrint(id)   logToken(id)
+    #define logPrintln(id) (logToken(id), Serial.println())
+  #else
+    #define logPrint(id)   Serial.print(F(id##_T))
+    #define logPrintln(id) Serial.println(F(id##_T))
+  #endif
+
+  // the names of the parameters are only stored in the flash for LOG_TOKENIZED 0
+  #if LOG_TOKENIZED > 0
+    #define PARAM_NAME(name) ""
+    #define PARAM_NAME_SIZE  1
+  #else
+    #define PARAM_NAME(name) name
+    #define PARAM_NAME_SIZE  (MAX_PARAM_NAME_LEN + 1)
+  #endif
+#endif
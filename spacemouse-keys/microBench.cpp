@@ -0,0 +1,216 @@
+// File for the micro-benchmark of the primitives of the pipeline (debug mode 72, MICRO_BENCH 1)
+//
+// Timer1 runs without prescaler in normal mode, so TCNT1 counts CPU cycles (4.1 ms until the overflow at 16 MHz).
+// Each primitive runs MICRO_BENCH_RUNS times, the cycles of the empty measurement are subtracted. The minimum is the
+// run without interrupts (USB, millis()), the mean includes them. A run longer than 65535 cycles is marked as overflow.
+// Timer1 isn't used by the firmware otherwise, its settings are restored afterwards.
+//
+// send_command() is measured with a fake time: first the state machine is brought to "values changed, last report
+// HIDUPDATERATE_MS ago", then it is called once shortly before and once at the time of the next report. The host
+// only gets reports with zero values. EEPROM.update() is measured with the value, which is already stored (no
+// write), and once with a changed value until the write is done; the byte is restored afterwards.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "config.h"
+#include "microBench.h"
+#include "kinematics.h"
+#include "eepromWriter.h"
+#include "SpaceMouseHID.h"
+#include "logMessages.h"
+
+#if MICRO_BENCH > 0
+
+#define BENCH_ADDRESS E2END     // EEPROM byte for the write, restored afterwards
+#define BENCH_TIME_STEP 100     // ms between the fake times of the send_command() runs
+
+typedef struct _BenchResult {
+  uint16_t min;
+  uint32_t sum;
+  uint8_t  runs;
+  bool     overflow;
+} BenchResult;
+
+static uint16_t overhead = 0;  // cycles of the empty measurement
+
+// measure the cycles of statement once and add them to result
+#define MEASURE(result, statement) do { \
+    TIFR1 = _BV(TOV1);                  \
+    TCNT1 = 0;                          \
+    statement;                          \
+    uint16_t cycles = TCNT1;            \
+    addRun(result, cycles, TIFR1 & _BV(TOV1)); \
+  } while (0)
+
+/// @brief Clear a result before the runs of a primitive
+/// @param result the result
+static void clearResult(BenchResult &result) {
+  result.min = 0xFFFF;
+  result.sum = 0;
+  result.runs = 0;
+  result.overflow = false;
+}
+
+/// @brief Add the cycles of one run to a result
+/// @param result the result
+/// @param cycles TCNT1 after the run
+/// @param overflow TOV1 after the run: the run took more than 65535 cycles
+static void addRun(BenchResult &result, uint16_t cycles, bool overflow) {
+  cycles = (cycles > overhead) ? cycles - overhead : 0;
+  if (overflow) {
+    cycles = 0xFFFF;
+    result.overflow = true;
+  }
+  result.min = min(result.min, cycles);
+  result.sum += cycles;
+  result.runs++;
+}
+
+/// @brief Print minimum and mean of a result, after the name of the primitive
+/// @param result the result
+static void printResult(BenchResult &result) {
+  Serial.print(result.min);
+  logPrint(MSG_BENCH_SEP);
+  Serial.print(result.runs ? result.sum / result.runs : 0);
+  if (result.overflow) {
+    logPrint(MSG_BENCH_OVERFLOW);
+  }
+  Serial.println();
+}
+
+/// @brief Run the micro-benchmark of the primitives and print the cycles (debug mode 72)
+/// @param par parameters, MODFUNC is changed during the measurement of modifierFunction() and restored
+void runMicroBenchmark(ParamData &par) {
+  uint8_t tccr1a = TCCR1A, tccr1b = TCCR1B, timsk1 = TIMSK1;
+  TIMSK1 = 0;
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);  // normal mode, clk/1
+
+  logPrint(MSG_BENCH_HEADER);
+  Serial.println(F_CPU);
+
+  BenchResult result;
+  volatile int sink;   // keeps the results, which are not used
+
+  overhead = 0;
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, ;);
+  }
+  overhead = result.min;
+
+  const uint8_t pin = par.values->pinList[0];
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, sink = analogRead(pin));
+  }
+  logPrint(MSG_BENCH_ANALOG);
+  printResult(result);
+
+  int raw[8];
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, readAllFromJoystick(raw));
+  }
+  logPrint(MSG_BENCH_JOYSTICK);
+  printResult(result);
+
+  // half of the full scale, the modifiers use pow() and tan() on it
+#if PARAM_CONST > 0
+  const int16_t funcs[] = {MODFUNC};  // the parameters are constants: only the configured modifier
+#else
+  const int16_t funcs[] = {0, 1, 3};
+  const int16_t modFunc = par.values->modFunc;
+#endif
+  for (uint8_t f = 0; f < sizeof(funcs) / sizeof(funcs[0]); f++) {
+#if PARAM_CONST == 0
+    par.values->modFunc = funcs[f];
+#endif
+    clearResult(result);
+    for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+      MEASURE(result, sink = modifierFunction(175, par));
+    }
+    logPrint(MSG_BENCH_MODFUNC);
+    Serial.print(funcs[f]);
+    logPrint(MSG_BENCH_COLON);
+    printResult(result);
+  }
+#if PARAM_CONST == 0
+  par.values->modFunc = modFunc;
+#endif
+
+  // every sensor deflected, alternating in both directions
+  int centered[8];
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    for (uint8_t j = 0; j < 8; j++) {
+      centered[j] = (j & 1) ? -150 : 150;
+    }
+    MEASURE(result, FilterAnalogReadOuts(centered, par));
+  }
+  logPrint(MSG_BENCH_FILTER);
+  printResult(result);
+
+  int16_t velocity[6];
+  unsigned long now = micros(); // outside of the measurement
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, calculateKinematic(centered, velocity, par, now));
+  }
+  logPrint(MSG_BENCH_KINEMATIC);
+  printResult(result);
+
+  uint8_t keys[NUMKEYS > 0 ? NUMKEYS : 1] = {0};
+#if NUMKEYS > 0
+  uint8_t keyData[4];
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, SpaceMouseHID.prepareKeyBytes(keys, keyData, -1, millis()));
+  }
+  logPrint(MSG_BENCH_KEYBYTES);
+  printResult(result);
+#endif
+
+  BenchResult due;
+  clearResult(result);
+  clearResult(due);
+  // fake times in the past: afterwards the last report is 100 ms ago and the next one is due at once
+  unsigned long base = millis() - (unsigned long)MICRO_BENCH_RUNS * BENCH_TIME_STEP;
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    unsigned long t = base + (unsigned long)i * BENCH_TIME_STEP;
+    // zero reports and released keys, until the state machine waits with the last report at t - HIDUPDATERATE_MS
+    for (uint8_t k = 0; k < 8; k++) {
+      SpaceMouseHID.send_command(0, 0, 0, 0, 0, 0, keys, -1, t);
+    }
+    SpaceMouseHID.send_command(1, 0, 0, 0, 0, 0, keys, -1, t);                    // values changed: report waits
+    MEASURE(result, SpaceMouseHID.send_command(0, 0, 0, 0, 0, 0, keys, -1, t - 1)); // not yet due
+    MEASURE(due, SpaceMouseHID.send_command(0, 0, 0, 0, 0, 0, keys, -1, t));        // due: sends a zero report
+  }
+  logPrint(MSG_BENCH_SEND_IDLE);
+  printResult(result);
+  logPrint(MSG_BENCH_SEND_DUE);
+  printResult(due);
+
+  eepromWriterWait();  // no background write of the parameters
+  const uint8_t value = EEPROM.read(BENCH_ADDRESS);
+  clearResult(result);
+  for (uint8_t i = 0; i < MICRO_BENCH_RUNS; i++) {
+    MEASURE(result, EEPROM.update(BENCH_ADDRESS, value));
+  }
+  logPrint(MSG_BENCH_EEPROM_SAME);
+  printResult(result);
+
+  clearResult(result);
+  MEASURE(result, EEPROM.update(BENCH_ADDRESS, value ^ 0xFF); while (EECR & _BV(EEPE)) {});
+  EEPROM.update(BENCH_ADDRESS, value);
+  while (EECR & _BV(EEPE)) {}
+  logPrint(MSG_BENCH_EEPROM_WRITE);
+  printResult(result);
+
+  (void)sink;
+  TCCR1B = tccr1b;
+  TCCR1A = tccr1a;
+  TIMSK1 = timsk1;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Header for the micro-benchmark of the primitives of the pipeline (debug mode 72)
+// Measures the CPU cycles of the single primitives with Timer1 on the unit itself, e.g. to compare board
+// revisions and clock settings without lab tools.
+#ifndef MICROBENCH_H
+  #define MICROBENCH_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "parameterMenu.h"
+
+  #ifndef MICRO_BENCH
+    #define MICRO_BENCH 0
+  #endif
+
+  #define MICRO_BENCH_RUNS 16 // runs of each primitive, the minimum and the mean are reported
+
+  void runMicroBenchmark(ParamData &par);
+#endif
@@ -2,38 +2,123 @@
 
 #include <Arduino.h>
 #include <EEPROM.h>
+#include <util/crc16.h>
 #include "parameterMenu.h"
+#include "eepromWriter.h"
+#include "logMessages.h"
+#include "stackMonitor.h"
+#include "latency.h"
 
 /* possible commands in ProgMode:
 
   Cmd    |function                       |returns (>= 10000 -> NOK)
   -------|-------------------------------|----------------------------------------------------------------------------
-  >p...   parameter number                <p...   (PE_OK,PE_INVALID_PARAM)
+  >p...   parameter number                <p...   (PE_OK,PE_INVALID_PARAM), selects element 0
+  >x...   element of an array parameter   <x...   (PE_OK,PE_INVALID_PARAM), used by >r and >w
+  >k      get number of elements          <k...   (<count>: 1 for single values, or PE_INVALID_PARAM)
   >r      read value                      <r...   (<value> or PE_INVALID_PARAM
   >w...   write value                     <w...   (PE_OK,PE_INVALID_PARAM,PE_INVALID_VALUE "not in
-  [-10000..+10000]")
+  [min..max] of the parameter, see paramDescription")
 
   >l      load params from EEPROM         <l0     (PE_OK)
 
-  >s      save params to   EEPROM   <s0     (PE_OK)
+  >s      save params to   EEPROM   <s0     (PE_OK, saving runs in background, see >e)
 
-  >c      clear EEPROM <c0     (PE_OK)
+  >c      clear EEPROM <c0     (PE_OK, clearing runs in background, see >e)
 
-  >m   get magic number <m... (<magic   number>: all values are valid, no fault-codes!)
+  >e   get state of EEPROM writer  <e...   (0=idle, all data is written; 1=busy)
+
+  >m   get magic number <m... (<magic   number>: all values are valid, no fault-codes! PE_BUSY while the EEPROM
+                              writer runs, see >e)
 
   >n   get number of parameters   <n...   (<number   of params>)
 
-  >i   invalidate magic number <i0   (PE_OK)
+  >i   invalidate magic number <i0   (PE_OK, PE_BUSY while the EEPROM writer runs)
 
   >t   get type of parameter   <t...   (<type>:  1=bool,2=int,3=float or PE_INVALID_PARAM)
 
   >d   get description of parameter    <d...   (<name of  parameter> or PE_INVALID_PARAM)
+
+  >f   get minimum free stack      <f...   (<bytes> since the start, only with STACK_MONITOR 1)
+
+  >h   get latency of HID reports  <h<n>;<p50>;<p99>;<max>;<n>;<p50>;<p99>;<max>   (in us, only with LATENCY_STATS 1)
+                                   (sample age and motion to report since the last query, see latency.h)
+
+  >a   get all parameters          <a<id>:<type>:<value>;<id>:<type>:<value>;...*<CRC>
+                                   (the elements of array parameters are separated by ',' in >a and >b)
+
+  >b<id>=<value>;<id>=<value>;...*<CRC>   set several parameters at once
+                                   <b...   (PE_OK, PE_VALUE_FAULT, PE_CRC_FAULT or PE_INVALID_VALUE followed by
+                                           ;<id>=<PE_INVALID_PARAM or PE_INVALID_VALUE> for each faulty parameter)
+                                           the values are only taken over, if all of them are valid;
+                                           PE_BUSY while the EEPROM writer runs, the block is skipped
+
+  <CRC>: CRC-16/MCRF4XX (see _crc_ccitt_update(), start 0xFFFF) of all characters between the command and '*',
+         as four hex digits
 */
 
 #if ENABLE_PROGMODE > 0
 ProgCmd prog;
 #endif
-long invalidNum = 0xFFFFFFFF;
+int32_t invalidNum = 0xFFFFFFFF;
+
+// The records of a running save (see putParametersToEEPROM()), encoded when the save starts, so the EEPROM-ready
+// interrupt only copies bytes, or, while no save runs, the staged values of >b (see readParameterBlock()). A record
+// isn't longer than its variable plus ID and length. One static buffer keeps the ~350 bytes off the stack.
+static union ShadowBuffer {
+  ShadowBuffer() {}
+  ParamStorage values;                                  // staged values of >b
+  uint8_t      records[sizeof(ParamStorage) + 2 * NUM_PARAMS]; // encoded records of a running save
+} shadow;
+
+/// @brief  gets the type of a parameter out of the description table in flash
+/// @param  i          index of the parameter
+/// @param  par        struct of parameters used by the system at runtime
+/// @return type       PARAM_TYPE_BOOL, PARAM_TYPE_INT or PARAM_TYPE_FLOAT
+static uint8_t paramType(int i, ParamData &par) {
+  return pgm_read_byte(&par.description[i].type);
+}
+
+/// @brief  gets the number of elements of a parameter out of the description table in flash
+/// @param  i          index of the parameter
+/// @param  par        struct of parameters used by the system at runtime
+/// @return count      number of elements of an array parameter, 1 for a single value
+uint8_t paramCount(int i, ParamData &par) {
+  return pgm_read_byte(&par.description[i].count);
+}
+
+/// @brief  gets a limit of a parameter out of the description table in flash
+/// @param  i          index of the parameter
+/// @param  par        struct of parameters used by the system at runtime
+/// @param  upper      true=max, false=min
+/// @return limit      in the unit of the variable, FLOAT in 1/PARAM_FIXED_SCALE
+static int32_t paramLimitFixed(int i, ParamData &par, bool upper) {
+  int32_t limit = (int16_t)pgm_read_word(upper ? &par.description[i].max : &par.description[i].min);
+  if (paramType(i, par) == PARAM_TYPE_FLOAT) {
+    for (uint8_t n = pgm_read_byte(&par.description[i].decimals); n < 3; n++) {
+      limit *= 10; // 1/10^decimals -> 1/PARAM_FIXED_SCALE
+    }
+  }
+  return limit;
+}
+
+/// @brief  gets a limit of a parameter out of the description table in flash
+/// @param  i          index of the parameter
+/// @param  par        struct of parameters used by the system at runtime
+/// @param  upper      true=max, false=min
+/// @return limit      in the unit of the variable
+double paramLimit(int i, ParamData &par, bool upper) {
+  double limit = paramLimitFixed(i, par, upper);
+  return (paramType(i, par) == PARAM_TYPE_FLOAT) ? limit / PARAM_FIXED_SCALE : limit;
+}
+
+/// @brief  gets the address of the variable of a parameter in the ParamStorage
+/// @param  i          index of the parameter
+/// @param  par        struct of parameters used by the system at runtime
+/// @return pointer    to the variable, cast it according to the type
+static void *paramStorage(int i, ParamData &par) {
+  return (uint8_t *)par.values + pgm_read_offset(&par.description[i].offset);
+}
 
 /// @brief  Test for User-input on serial interface. If something is typed in, the input is checked
 /// for a (floating point-)number, 'q' or ESC.
@@ -92,6 +177,17 @@ int userInput(
         prog.cmd = next;
         Serial.read();
       } //   'p' set parameter-number
+      else if (progMode && !cmdDone && next == 'x') {
+        cmdDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'x' set element of an array parameter
+      else if (progMode && !cmdDone && next == 'k') {
+        cmdDone = true;
+        valDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'k' get number of elements
       else if (progMode && !cmdDone && next == 't') {
         cmdDone = true;
         valDone = true;
@@ -151,6 +247,41 @@ int userInput(
         prog.cmd = next;
         Serial.read();
       } //   'i' invalidate magic-number
+      else if (progMode && !cmdDone && next == 'e') {
+        cmdDone = true;
+        valDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'e' get state of EEPROM writer
+      else if (progMode && !cmdDone && next == 'a') {
+        cmdDone = true;
+        valDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'a' get all parameters
+      else if (progMode && !cmdDone && next == 'b') {
+        cmdDone = true;
+        valDone = true;
+        crlfDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'b' set several parameters, the block is read by executeProgCommand()
+#if STACK_MONITOR > 0
+      else if (progMode && !cmdDone && next == 'f') {
+        cmdDone = true;
+        valDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'f' get minimum free stack
+#endif
+#if LATENCY_STATS > 0
+      else if (progMode && !cmdDone && next == 'h') {
+        cmdDone = true;
+        valDone = true;
+        prog.cmd = next;
+        Serial.read();
+      } //   'h' get latency statistics
+#endif
 #endif
       else if (next == 'q' || next == 27) {
         state = 2;
@@ -210,10 +341,176 @@ int userInput(
 }
 
 #if ENABLE_PROGMODE > 0
+// Print, which calculates the CRC of all printed characters
+class CrcPrint : public Print {
+public:
+  CrcPrint(Print &out) : out(out), crc(0xFFFF) {}
+  using Print::write;
+  size_t write(uint8_t c) {
+    crc = _crc_ccitt_update(crc, c);
+    return out.write(c);
+  }
+  Print   &out;
+  uint16_t crc;
+};
+
+/// @brief  prints a CRC as four hex digits
+static void printCrc(uint16_t crc) {
+  for (int8_t shift = 12; shift >= 0; shift -= 4) {
+    Serial.print((crc >> shift) & 0x0F, HEX);
+  }
+}
+
+/// @brief  prints all parameters as "<a<id>:<type>:<value>;...*<CRC>" for >a, the elements of arrays are
+/// separated by ','
+/// @param  par        struct of parameters used by the system at runtime
+static void printParameterBlock(ParamData &par) {
+  CrcPrint out(Serial);
+
+  Serial.print(F("<a"));
+  for (int i = 1; i <= NUM_PARAMS; i++) {
+    uint8_t type = paramType(i, par);
+    out.print(i);
+    out.print(':');
+    out.print(type);
+    out.print(':');
+    for (uint8_t n = 0; n < paramCount(i, par); n++) {
+      if (n > 0) {
+        out.print(',');
+      }
+      if (type == PARAM_TYPE_FLOAT) {
+        out.print(readParameter(i, par, n), 3);
+      } else {
+        out.print((int)readParameter(i, par, n));
+      }
+    }
+    out.print(';');
+  }
+  Serial.print('*');
+  printCrc(out.crc);
+  Serial.println();
+}
+
+/// @brief  reads "<id>=<value>;...*<CRC>" for >b from Serial, the elements of arrays are separated by ','. The values
+/// are written to a copy of the parameters first, so they are checked against their limits, and only taken over, if
+/// the CRC is correct and all values are valid. Prints the result and the faulty parameters. The copy is the static
+/// shadow buffer, so call this only while the EEPROM writer is idle.
+/// @param  par        struct of parameters used by the system at runtime
+static void readParameterBlock(ParamData &par) {
+  shadow.values = *par.values;
+  ParamData    stagedPar = {&shadow.values, par.description, false};
+  uint16_t     errorIds[MAX_BLOCK_ERRORS];
+  uint8_t      errors = 0;
+  uint16_t     lastErrorId = 0xFFFF;
+  uint16_t     crc = 0xFFFF;
+  uint16_t     id = 0;
+  uint8_t      element = 0;
+  int32_t      number = 0;      // digits of the value without decimal point
+  int8_t       decimals = -1;   // number of digits after the decimal point, -1: no decimal point yet
+  bool         negative = false;
+  bool         inValue = false; // false: reading id, true: reading value
+  int          retval = PE_OK;
+  char         c;
+  unsigned long timeout = Serial.getTimeout();
+
+  Serial.setTimeout(BLOCK_TIMEOUT); // the block is sent at once, don't block the loop for long
+  while (retval == PE_OK) {
+    if (Serial.readBytes(&c, 1) == 0) {
+      retval = PE_VALUE_FAULT; // timeout
+      break;
+    }
+    if (c == '*') {
+      break;
+    }
+    crc = _crc_ccitt_update(crc, c);
+
+    if (isDigit(c)) {
+      if (!inValue) {
+        id = (id < 1000) ? id * 10 + (c - '0') : id;
+      } else if (decimals < 3 && number < 100000000L) { // more than three decimals are ignored
+        number = number * 10 + (c - '0');
+        if (decimals >= 0) {
+          decimals++;
+        }
+      }
+    } else if (c == '=' && !inValue) {
+      inValue = true;
+    } else if (c == '-' && inValue && number == 0 && decimals < 0) {
+      negative = true;
+    } else if (c == '.' && inValue && decimals < 0) {
+      decimals = 0;
+    } else if ((c == ';' || c == ',') && inValue) {
+      double value = negative ? -number : number;
+      for (; decimals > 0; decimals--) {
+        value /= 10.0;
+      }
+      if (!writeParameter(id, value, stagedPar, element) && id != lastErrorId) { // report each parameter once
+        lastErrorId = id;
+        if (errors < MAX_BLOCK_ERRORS) {
+          errorIds[errors] = id;
+        }
+        errors++;
+      }
+      number = 0;
+      decimals = -1;
+      negative = false;
+      element++;
+      if (c == ';') { // next parameter
+        id = 0;
+        element = 0;
+        inValue = false;
+      }
+    } else {
+      retval = PE_VALUE_FAULT; // unexpected character
+    }
+  }
+
+  if (retval == PE_OK) {
+    char hex[5] = {0};
+    if (Serial.readBytes(hex, 4) != 4 || strtoul(hex, NULL, 16) != crc) {
+      retval = PE_CRC_FAULT;
+    } else if (inValue || id != 0) {
+      retval = PE_VALUE_FAULT; // last parameter without ';'
+    } else if (errors > 0) {
+      retval = PE_INVALID_VALUE;
+    } else {
+      *par.values = shadow.values;
+      par.changed = true;
+    }
+  }
+  while (Serial.available() && Serial.peek() != 13 && Serial.peek() != 10) { // skip the rest of a faulty telegram
+    Serial.read();
+  }
+  Serial.setTimeout(timeout);
+
+  Serial.print(F("<b"));
+  Serial.print(retval);
+  if (retval == PE_INVALID_VALUE) {
+    for (uint8_t n = 0; n < errors && n < MAX_BLOCK_ERRORS; n++) {
+      Serial.print(';');
+      Serial.print(errorIds[n]);
+      Serial.print('=');
+      Serial.print((errorIds[n] >= 1 && errorIds[n] <= NUM_PARAMS) ? PE_INVALID_VALUE : PE_INVALID_PARAM);
+    }
+  }
+  Serial.println();
+}
+
+/// @brief  skips the rest of a >b telegram up to LF, waits at most BLOCK_TIMEOUT for the next character
+static void skipParameterBlock() {
+  char          buf[16];
+  unsigned long timeout = Serial.getTimeout();
+
+  Serial.setTimeout(BLOCK_TIMEOUT);
+  while (Serial.readBytesUntil(10, buf, sizeof(buf)) == sizeof(buf)) {
+  }
+  Serial.setTimeout(timeout);
+}
+
 /// @brief  executes a program-command which is stored in the global variable "prog" by userInput()
 /// @param  nothing
 void executeProgCommand(ParamData &par) {
-  long m = 0L;
+  int32_t m = 0L;
   bool intVal = true;
 
   if (prog.retval == PE_OK) {
@@ -222,11 +519,28 @@ void executeProgCommand(ParamData &par) {
         prog.retval = PE_INVALID_PARAM;
       } else {
         prog.paramNo = prog.value;
+        prog.element = 0;
+      }
+    }
+
+    else if (prog.cmd == 'x') {
+      if (prog.paramNo < 1 || prog.paramNo > NUM_PARAMS || prog.value < 0 || prog.value >= paramCount(prog.paramNo, par)) {
+        prog.retval = PE_INVALID_PARAM;
+      } else {
+        prog.element = prog.value;
+      }
+    }
+
+    else if (prog.cmd == 'k') {
+      if (prog.paramNo < 1 || prog.paramNo > NUM_PARAMS) {
+        prog.retval = PE_INVALID_PARAM;
+      } else {
+        prog.retval = paramCount(prog.paramNo, par);
       }
     }
 
     else if (prog.cmd == 't') {
-      prog.retval = par.description[prog.paramNo].type;
+      prog.retval = paramType(prog.paramNo, par);
     }
 
     else if (prog.cmd == 'd') {
@@ -241,21 +555,19 @@ void executeProgCommand(ParamData &par) {
     }
 
     else if (prog.cmd == 'r') {
-      if (prog.paramNo < 1 || prog.paramNo > NUM_PARAMS) {
+      if (prog.paramNo < 1 || prog.paramNo > NUM_PARAMS || prog.element >= paramCount(prog.paramNo, par)) {
         prog.retval = PE_INVALID_PARAM;
       } else {
-        prog.retval = readParameter(prog.paramNo, par);
-        intVal = (par.description[prog.paramNo].type != PARAM_TYPE_FLOAT);
+        prog.retval = readParameter(prog.paramNo, par, prog.element);
+        intVal = (paramType(prog.paramNo, par) != PARAM_TYPE_FLOAT);
       }
     }
 
     else if (prog.cmd == 'w') {
       if (prog.paramNo < 1 || prog.paramNo > NUM_PARAMS) {
-        prog.retval = PE_INVALID_VALUE;
-      } else if (prog.value < -10000.0 || prog.value > +10000.0) {
         prog.retval = PE_INVALID_PARAM;
-      } else {
-        writeParameter(prog.paramNo, prog.value, par);
+      } else if (!writeParameter(prog.paramNo, prog.value, par, prog.element)) {
+        prog.retval = PE_INVALID_VALUE;
       }
     }
 
@@ -268,9 +580,15 @@ void executeProgCommand(ParamData &par) {
     }
 
     else if (prog.cmd == 'c') {
-      for (unsigned int i = 0; i < EEPROM.length(); i++) {
-        EEPROM.update(i, 255);
-      }
+      clearEEPROM();
+    }
+
+    else if (prog.cmd == 'e') {
+      prog.retval = eepromWriterBusy() ? 1 : 0;
+    }
+
+    else if (prog.cmd == 'm' && eepromWriterBusy()) {
+      prog.retval = PE_BUSY; // the magic number is invalid until the writer has finished
     }
 
     else if (prog.cmd == 'm') {
@@ -285,8 +603,40 @@ void executeProgCommand(ParamData &par) {
     }
 
     else if (prog.cmd == 'i') {
-      EEPROM.put(BASE_ADDRESS_MAGIC, invalidNum);
+      if (eepromWriterBusy()) {
+        prog.retval = PE_BUSY;
+      } else {
+        EEPROM.put(BASE_ADDRESS_MAGIC, invalidNum);
+      }
+    }
+
+    else if (prog.cmd == 'a') {
+      printParameterBlock(par);
+      return;
+    }
+
+    else if (prog.cmd == 'b' && eepromWriterBusy()) {
+      skipParameterBlock(); // the shadow buffer holds the records of the running save
+      prog.retval = PE_BUSY;
+    }
+
+    else if (prog.cmd == 'b') {
+      readParameterBlock(par);
+      return;
     }
+
+#if STACK_MONITOR > 0
+    else if (prog.cmd == 'f') {
+      prog.retval = stackFreeMin();
+    }
+#endif
+
+#if LATENCY_STATS > 0
+    else if (prog.cmd == 'h') {
+      printLatencyStats(true);
+      return;
+    }
+#endif
   }
 
   Serial.print(F("<"));
@@ -311,18 +661,18 @@ int parameterMenu(ParamData &par) {
   static int menuMode = -1; // mode requested by user input (-1 = nothing)
 
   if (state == 0 || state == 1) { // 0 = "off", 1 = "writeMenu"
-    Serial.print(F("\r\nSpaceMouse FW"));
+    logPrint(MSG_PARAM_TITLE);
     Serial.print(F(FW_RELEASE));
-    Serial.println(F(" - Parameters"));
-    Serial.println(F("ESC leave parameter-menu (ESC, Q)"));
-    Serial.println(F("  1  list parameters"));
-    Serial.println(F("  2  edit parameters"));
-    Serial.println(F("  3  load from EEPROM"));
-    Serial.println(F("  4  save to EEPROM"));
-    Serial.println(F("  5  clear EEPROM to 0xFF"));
-    Serial.println(F("  6  set EEPROM params invalid"));
-    Serial.println(F("  7  list parameters as defines"));
-    Serial.print(F("param::"));
+    logPrintln(MSG_PARAM_MENU);
+    logPrintln(MSG_PARAM_ESC);
+    logPrintln(MSG_PARAM_1);
+    logPrintln(MSG_PARAM_2);
+    logPrintln(MSG_PARAM_3);
+    logPrintln(MSG_PARAM_4);
+    logPrintln(MSG_PARAM_5);
+    logPrintln(MSG_PARAM_6);
+    logPrintln(MSG_PARAM_7);
+    logPrint(MSG_PARAM_PROMPT);
     menuMode = -1; // nothing
     state = 2;     // getInput
   }
@@ -357,28 +707,30 @@ int parameterMenu(ParamData &par) {
       break;
 
     case 3:
-      Serial.println(F("loading parameters from EEPROM"));
+      logPrintln(MSG_LOADING);
       getParametersFromEEPROM(par);
       state = 1; // writeMenu
       break;
 
     case 4:
-      Serial.println(F("saving parameters to EEPROM"));
+      logPrintln(MSG_SAVING);
       putParametersToEEPROM(par);
       state = 1; // writeMenu
       break;
 
     case 5:
-      Serial.println(F("clearing EEPROM"));
-      for (unsigned int i = 0; i < EEPROM.length(); i++) {
-        EEPROM.update(i, 255);
-      }
+      logPrintln(MSG_CLEARING);
+      clearEEPROM();
       state = 1; // writeMenu
       break;
 
     case 6:
-      Serial.println(F("setting EEPROM params invalid"));
-      EEPROM.put(BASE_ADDRESS_MAGIC, invalidNum);
+      if (eepromWriterBusy()) {
+        logPrintln(MSG_EEPROM_BUSY);
+      } else {
+        logPrintln(MSG_INVALIDATING);
+        EEPROM.put(BASE_ADDRESS_MAGIC, invalidNum);
+      }
       state = 1; // writeMenu
       break;
 
@@ -402,16 +754,18 @@ int parameterMenu(ParamData &par) {
 /// value, write to selected parameter
 /// @param  par        struct of parameters used by the system at runtime
 /// @return state      of StateMachine: 0=edit is off; 1=show list on serial; 2=user-input index;
-/// 3=show old value; 4=user-input new value; 5=write new value to parameter
+/// 3=show old value; 4=user-input new value; 5=write new value to parameter; 6=user-input element of an array
 int editParameters(ParamData &par) {
   static int state = 0;
   static bool isFloat;
   static int parIndex = 0;
+  static uint8_t parElement = 0;
   static double parValue = 0.0;
   int result = 0;
 
   if (state == 0) { // OFF
     parIndex = 0;
+    parElement = 0;
     parValue = 0.0;
     state = 1; // coming from OFF -> start over
   }
@@ -420,8 +774,8 @@ int editParameters(ParamData &par) {
     Serial.println();
     printAllParameters(par, true);
     Serial.println();
-    Serial.println(F("enter number of parameter to edit (ESC, Q to leave)"));
-    Serial.print(F("edit::"));
+    logPrintln(MSG_EDIT_ENTER);
+    logPrint(MSG_EDIT_PROMPT);
     state = 2;
   }
 
@@ -440,28 +794,60 @@ int editParameters(ParamData &par) {
   }
 
   if (state == 3) { // show actual parameter value
+    parElement = 0;
     if (parIndex >= 1 && parIndex <= NUM_PARAMS) {
       isFloat = printOneParameter(parIndex, par, false, true);
-      Serial.print(F(" -> "));
-      state = 4; // input parameter value
+      if (paramCount(parIndex, par) == 0) { // e.g. KEYLIST without keys
+        Serial.println();
+        logPrintln(MSG_UNCHANGED);
+        state = 1;
+      } else if (paramCount(parIndex, par) == 1) {
+        logPrint(MSG_ARROW);
+        state = 4; // input parameter value
+      } else {
+        logPrint(MSG_EDIT_ELEMENT);
+        Serial.print(paramCount(parIndex, par) - 1);
+        logPrint(MSG_ARROW);
+        state = 6; // input element of the array
+      }
     } else {
       state = 1; // invalid number -> show menu
     }
   }
 
+  if (state == 6) { // user input: element of an array parameter
+    double num;
+    result = userInput(num);
+    if (result == 1 && num >= 0 && num < paramCount(parIndex, par)) {
+      parElement = (uint8_t)num;
+      Serial.println(parElement);
+      if (isFloat) {
+        Serial.print(readParameter(parIndex, par, parElement));
+      } else {
+        Serial.print((int)readParameter(parIndex, par, parElement));
+      }
+      logPrint(MSG_ARROW);
+      state = 4; // input parameter value
+    } else if (result != 0) {
+      logPrintln(MSG_UNCHANGED); // others    -> abort input
+      state = 1;
+    }
+  }
+
   if (state == 4) { // user input: new parameter value
     result = userInput(parValue);
     if (result == 1) {
       state = 5; // new value -> edit selected
     } else if (result != 0) {
-      Serial.println(F("unchanged")); // others    -> abort input
+      logPrintln(MSG_UNCHANGED); // others    -> abort input
       state = 1;
     }
   }
 
   if (state == 5) { // write new parameter
-    writeParameter(parIndex, parValue, par);
-    if (isFloat) {
+    if (!writeParameter(parIndex, parValue, par, parElement)) {
+      logPrintln(MSG_OUT_OF_RANGE);
+    } else if (isFloat) {
       Serial.println(parValue);
     } else {
       Serial.println((int)trunc(parValue));
@@ -472,37 +858,234 @@ int editParameters(ParamData &par) {
   return state;
 }
 
-/// @brief  gets all parameters from EEPROM, if the magic number in EEPROM is correct
+#define MAX_RECORD_LEN (2 + 2 * MAX_PARAM_COUNT) // ID + length + biggest array
+
+/// @brief  encodes one parameter as EEPROM record [ID][length][value]. Arrays are stored element by element.
+/// @param  i          index of the parameter = ID of the record
+/// @param  par        struct of parameters used by the system at runtime
+/// @param  record     (output) buffer with at least MAX_RECORD_LEN bytes
+/// @return length of the record in bytes
+static uint8_t encodeRecord(uint8_t i, ParamData &par, uint8_t *record) {
+  uint8_t *data = &record[2];
+  uint8_t  count = paramCount(i, par);
+  int16_t  fixed;
+  float    f;
+  double   scaled;
+
+  switch (paramType(i, par)) {
+  case PARAM_TYPE_BOOL:
+    for (uint8_t n = 0; n < count; n++) {
+      *data++ = ((int8_t *)paramStorage(i, par))[n];
+    }
+    break;
+  case PARAM_TYPE_INT:
+    for (uint8_t n = 0; n < count; n++) {
+      fixed = ((int16_t *)paramStorage(i, par))[n];
+      *data++ = fixed & 0xFF;
+      *data++ = fixed >> 8;
+    }
+    break;
+  case PARAM_TYPE_FLOAT:
+    f = *(double *)paramStorage(i, par);
+    scaled = f * PARAM_FIXED_SCALE;
+    if (scaled >= -32768.0 && scaled <= 32767.0 && fabs(scaled - round(scaled)) < 0.01) {
+      fixed = (int16_t)round(scaled); // three decimals are enough -> fixed point
+      *data++ = fixed & 0xFF;
+      *data++ = fixed >> 8;
+    } else {
+      memcpy(data, &f, sizeof(f));
+      data += sizeof(f);
+    }
+    break;
+  }
+  record[0] = i;
+  record[1] = data - &record[2];
+  return data - record;
+}
+
+/// @brief  decodes the value of one record into the parameter given by the ID. Unknown IDs or records with an
+/// unexpected length (e.g. written by another firmware) are skipped, so the parameter keeps its actual value.
+/// Arrays take as many elements as stored and as they have, e.g. when the number of keys was changed.
+/// The values are checked against the limits of the description table as by >w: a value out of range (e.g. of an
+/// older table or a faulty save) keeps the actual value, so a sensitivity of 0 can't reach the kinematics.
+/// @param  id         ID of the record = index of the parameter
+/// @param  len        length of the value
+/// @param  data       value of the record
+/// @param  par        struct of parameters used by the system at runtime
+static void decodeRecord(uint8_t id, uint8_t len, const uint8_t *data, ParamData &par) {
+  if (id < 1 || id > NUM_PARAMS) {
+    return;
+  }
+  uint8_t count = paramCount(id, par);
+  float   f;
+
+  switch (paramType(id, par)) {
+  case PARAM_TYPE_BOOL:
+    for (uint8_t n = 0; n < count && n < len; n++) {
+      writeParameter(id, (int8_t)data[n], par, n);
+    }
+    break;
+  case PARAM_TYPE_INT:
+    if ((len & 1) == 0) {
+      for (uint8_t n = 0; n < count && n < len / 2; n++) {
+        writeParameter(id, (int16_t)(data[2 * n] | (data[2 * n + 1] << 8)), par, n);
+      }
+    }
+    break;
+  case PARAM_TYPE_FLOAT:
+    if (len == 2) {
+      writeParameter(id, (int16_t)(data[0] | (data[1] << 8)) / PARAM_FIXED_SCALE, par);
+    } else if (len == sizeof(f)) {
+      memcpy(&f, data, sizeof(f));
+      writeParameter(id, f, par);
+    }
+    break;
+  }
+}
+
+/// @brief  reads the parameters of EEPROM layout 1, which was a copy of the ParamStorage of NUM_PARAMS_V1 parameters
+/// in the order of their numbers. The sizes are taken from the types: BOOL=1, INT=2, FLOAT=4 bytes.
+/// @param  par        struct of parameters used by the system at runtime, read from EEPROM
+static void getParametersV1(ParamData &par) {
+  uint16_t address = BASE_ADDRESS_PAR_V1;
+  uint8_t  data[4];
+
+  for (uint8_t i = 1; i <= NUM_PARAMS_V1 && i <= NUM_PARAMS; i++) {
+    uint8_t len = (paramType(i, par) == PARAM_TYPE_BOOL) ? 1 : (paramType(i, par) == PARAM_TYPE_INT) ? 2 : 4;
+    for (uint8_t n = 0; n < len; n++) {
+      data[n] = EEPROM.read(address++);
+    }
+    decodeRecord(i, len, data, par);
+  }
+}
+
+/// @brief  gets all parameters from EEPROM, if the header is valid. Parameters not found in the EEPROM keep their
+/// actual value. An EEPROM of layout 1 is read and converted to the actual layout in background.
 /// @param  par        struct of parameters used by the system at runtime, read from EEPROM
 void getParametersFromEEPROM(ParamData &par) {
-  long magicNumber = 0L;
-  EEPROM.get(BASE_ADDRESS_MAGIC, magicNumber);
-  if (magicNumber == MAGIC_NUMBER) {
-    EEPROM.get(BASE_ADDRESS_PAR, *par.values);
-  } else {
-    Serial.println(F("Wrong magic!")); // No params in EEPROM are assumed
+  ParamHeader header;
+  eepromWriterWait(); // a running save has to be finished first
+  EEPROM.get(BASE_ADDRESS_MAGIC, header);
+
+  if (header.magic == MAGIC_NUMBER_V1) {
+    getParametersV1(par);
+    logPrintln(MSG_MIGRATING);
+    putParametersToEEPROM(par);
+    return;
+  }
+  if (header.magic != MAGIC_NUMBER) {
+    logPrintln(MSG_WRONG_MAGIC); // No params in EEPROM are assumed
+    return;
+  }
+  // when the meaning of a parameter changes, increment PARAM_VERSION and convert the old values after the loop below
+  if (header.version > PARAM_VERSION || header.length > EEPROM.length() - BASE_ADDRESS_PAR) {
+    logPrintln(MSG_WRONG_VERSION);
+    return;
+  }
+
+  uint16_t crc = 0xFFFF;
+  for (uint16_t address = BASE_ADDRESS_PAR; address < BASE_ADDRESS_PAR + header.length; address++) {
+    crc = _crc_ccitt_update(crc, EEPROM.read(address));
   }
+  if (crc != header.crc) {
+    logPrintln(MSG_WRONG_CRC);
+    return;
+  }
+
+  // the records have to fill the length exactly and match the count of the header
+  uint16_t address = BASE_ADDRESS_PAR;
+  uint16_t records = 0;
+  while (address + 2u <= BASE_ADDRESS_PAR + header.length) {
+    address += 2 + EEPROM.read(address + 1);
+    records++;
+  }
+  if (address != BASE_ADDRESS_PAR + header.length || records != header.count) {
+    logPrintln(MSG_WRONG_RECORDS);
+    return;
+  }
+
+  address = BASE_ADDRESS_PAR;
+  uint8_t  data[MAX_RECORD_LEN];
+  while (address + 2u <= BASE_ADDRESS_PAR + header.length) {
+    uint8_t id  = EEPROM.read(address++);
+    uint8_t len = EEPROM.read(address++);
+    if (len <= sizeof(data)) {
+      for (uint8_t n = 0; n < len; n++) {
+        data[n] = EEPROM.read(address + n);
+      }
+      decodeRecord(id, len, data, par);
+    }
+    address += len;
+  }
+}
+
+static ParamHeader savedHeader; // header of the running save
+
+/// @brief  delivers the bytes of the header and the records of the running save to the background writer
+/// @param  address    EEPROM address to be written
+/// @return byte to be stored at this address
+static uint8_t parameterSource(uint16_t address) {
+  if (address < BASE_ADDRESS_PAR) {
+    return ((const uint8_t *)&savedHeader)[address - BASE_ADDRESS_MAGIC];
+  }
+  return shadow.records[address - BASE_ADDRESS_PAR];
 }
 
-/// @brief  puts all parameters to EEPROM, sets the magic number in EEPROM
+/// @brief  puts all parameters to EEPROM, sets the header in EEPROM. The header is invalidated first and written
+/// last, so an interrupted save never leaves half written parameters with a valid header.
+/// The function returns at once, the writing is done in background (see eepromWriter.h). The records are encoded
+/// into the shadow buffer here, so changes during the writing (e.g. the live values of debug mode 20 or a menu edit)
+/// can't make the CRC of the header differ from the stored records, and the interrupt only copies bytes.
 /// @param  par        struct of parameters used by the system at runtime, written to EEPROM
 void putParametersToEEPROM(ParamData &par) {
-  long magicNumber = MAGIC_NUMBER;
-  EEPROM.put(BASE_ADDRESS_PAR, *par.values);
-  EEPROM.put(BASE_ADDRESS_MAGIC, magicNumber);
+  ParamHeader header;
+
+  eepromWriterStop(); // the interrupt of a running save reads the shadow buffer
+
+  header.magic = MAGIC_NUMBER;
+  header.version = PARAM_VERSION;
+  header.count = NUM_PARAMS;
+  header.length = 0;
+  header.crc = 0xFFFF;
+  header.reserved = 0;
+  for (uint8_t i = 1; i <= NUM_PARAMS; i++) {
+    uint8_t *record = &shadow.records[header.length];
+    uint8_t  len = encodeRecord(i, par, record);
+    for (uint8_t n = 0; n < len; n++) {
+      header.crc = _crc_ccitt_update(header.crc, record[n]);
+    }
+    header.length += len;
+  }
+
+  savedHeader = header;
+  eepromWriterStart(BASE_ADDRESS_MAGIC, BASE_ADDRESS_PAR, BASE_ADDRESS_PAR + header.length, parameterSource);
+}
+
+/// @brief  delivers the erased value 0xFF for every address to the background writer
+static uint8_t clearSource(uint16_t) {
+  return 0xFF;
+}
+
+/// @brief  sets the whole EEPROM to 0xFF. The function returns at once, the clearing is done in background.
+void clearEEPROM() {
+  eepromWriterStart(BASE_ADDRESS_MAGIC, BASE_ADDRESS_PAR, EEPROM.length(), clearSource);
 }
 
 /// @brief  prints parameter name of parameter requested by index i. Prints unformatted or
 /// left-aligned  >>when defining a new parameter, edit this function<<
+/// With LOG_TOKENIZED the name is sent as token with the number of the parameter, see logMessages.h.
 /// @param  i          index of the parameter to print
 /// @param  formatted  true=print name left aligned, false=print only name
 /// @return nothing
 void printParameterName(int i, ParamData &par, bool formatted) {
-
-  Serial.print(par.description[i].name);
+#if LOG_TOKENIZED > 0
+  logToken(formatted ? MSG_PARAM_NAME_PAD : MSG_PARAM_NAME);
+  Serial.write((uint8_t)i);
+#else
+  Serial.print((const __FlashStringHelper *)par.description[i].name);
 
   if (formatted) {
-    int c = MAX_PARAM_NAME_LEN - strlen(par.description[i].name);
+    int c = MAX_PARAM_NAME_LEN - strlen_P(par.description[i].name);
     char spc[MAX_PARAM_NAME_LEN + 1];
 
     for (int n = 0; n < c; n++) {
@@ -511,6 +1094,7 @@ void printParameterName(int i, ParamData &par, bool formatted) {
     spc[c] = '\0';
     Serial.print(spc);
   }
+#endif
 }
 
 /// @brief  prints all parameters as a list to Serial
@@ -532,7 +1116,7 @@ bool printOneParameter(int i, ParamData &par, bool line, bool numbering) {
   bool isFloat = false;
 
   if (i >= 1 && i <= NUM_PARAMS) {
-    isFloat = (par.description[i].type == PARAM_TYPE_FLOAT);
+    isFloat = (paramType(i, par) == PARAM_TYPE_FLOAT);
 
     if (numbering) {
       if (i <= 9) {
@@ -543,11 +1127,23 @@ bool printOneParameter(int i, ParamData &par, bool line, bool numbering) {
     }
     printParameterName(i, par, true);
     Serial.print(" ");
-    double value = readParameter(i, par);
-    if (isFloat) {
-      Serial.print(value);
-    } else {
-      Serial.print((int)trunc(value));
+    uint8_t count = paramCount(i, par);
+    if (count != 1) {
+      Serial.print("{");
+    }
+    for (uint8_t n = 0; n < count; n++) {
+      double value = readParameter(i, par, n);
+      if (n > 0) {
+        Serial.print(", ");
+      }
+      if (isFloat) {
+        Serial.print(value);
+      } else {
+        Serial.print((int)trunc(value));
+      }
+    }
+    if (count != 1) {
+      Serial.print("}");
     }
     if (line) {
       Serial.println();
@@ -556,47 +1152,60 @@ bool printOneParameter(int i, ParamData &par, bool line, bool numbering) {
   return isFloat;
 }
 
-/// @brief  reads one parameter (selected by index i) out of parameter-set  >>when defining a new
-/// parameter, edit this function<<
+/// @brief  reads one parameter (selected by index i) out of parameter-set
 /// @param  i         index of the parameter to print
 /// @param  par       struct of parameters used by the system at runtime
+/// @param  element   element of an array parameter, 0 for single values
 /// @return value     read from the selected parameter
-double readParameter(int i, ParamData &par) {
+double readParameter(int i, ParamData &par, uint8_t element) {
   double value = NAN;
 
-  if (i >= 1 && i <= NUM_PARAMS) {
-    switch (par.description[i].type) {
+  if (i >= 1 && i <= NUM_PARAMS && element < paramCount(i, par)) {
+    switch (paramType(i, par)) {
     case PARAM_TYPE_BOOL:
-      value = *(int8_t *)par.description[i].storage;
+      value = ((int8_t *)paramStorage(i, par))[element];
       break;
     case PARAM_TYPE_INT:
-      value = *(int16_t *)par.description[i].storage;
+      value = ((int16_t *)paramStorage(i, par))[element];
       break;
     case PARAM_TYPE_FLOAT:
-      value = *(double *)par.description[i].storage;
+      value = ((double *)paramStorage(i, par))[element];
       break;
     }
   }
   return value;
 }
 
-/// @brief  writes one parameter (selected by index i) to the parameter-set  >>when defining a new
-/// parameter, edit this function<<
+/// @brief  writes one parameter (selected by index i) to the parameter-set. The value is rounded to the step of the
+/// parameter and checked against its limits from the description table.
 /// @param  i         index of the parameter to print
 /// @param  value     value to write into the selected parameter
 /// @param  par       struct of parameters used by the system at runtime
-void writeParameter(int i, double value, ParamData &par) {
-  if (i >= 1 && i <= NUM_PARAMS) {
-    switch (par.description[i].type) {
-    case PARAM_TYPE_BOOL:
-      *((int8_t *)par.description[i].storage) = (int8_t)trunc(value);
-      break;
-    case PARAM_TYPE_INT:
-      *((int16_t *)par.description[i].storage) = (int16_t)trunc(value);
-      break;
-    case PARAM_TYPE_FLOAT:
-      *((double *)par.description[i].storage) = value;
-      break;
-    }
+/// @param  element   element of an array parameter, 0 for single values
+/// @return true=value written; false=invalid index or value out of range, the parameter is unchanged
+bool writeParameter(int i, double value, ParamData &par, uint8_t element) {
+  if (i < 1 || i > NUM_PARAMS || element >= paramCount(i, par)) {
+    return false;
+  }
+  uint8_t type = paramType(i, par);
+  uint8_t step = pgm_read_byte(&par.description[i].step);
+  double  scaled = (type == PARAM_TYPE_FLOAT) ? round(value * PARAM_FIXED_SCALE) : trunc(value);
+  scaled = round(scaled / step) * step;
+  if (!(scaled >= paramLimitFixed(i, par, false) && scaled <= paramLimitFixed(i, par, true))) { // also NaN
+    return false;
+  }
+
+  switch (type) {
+  case PARAM_TYPE_BOOL:
+    ((int8_t *)paramStorage(i, par))[element] = (int8_t)scaled;
+    break;
+  case PARAM_TYPE_INT:
+    ((int16_t *)paramStorage(i, par))[element] = (int16_t)scaled;
+    break;
+  case PARAM_TYPE_FLOAT:
+    ((double *)paramStorage(i, par))[element] = scaled / PARAM_FIXED_SCALE;
+    break;
   }
+  par.changed = true;
+  return true;
 }
@@ -3,6 +3,7 @@
   #define PARAMETERMENU_H
 
   #include "config.h"
+  #include "logMessages.h"
 
   //---------------------------------------------------------
   // to define a new parameter:
@@ -12,39 +13,211 @@
   // 3. PASTE the parameters in an editor to a text-file or into your new config.h (to use them as initial values)
   //
   // parameterMenu.h
-  // 4. change the magicNumber to something new to invalidate the actual content of the EEPROM
-  // 5. insert the new parameter into the struct ParamStorage
-  // 6. increment the number of parameters in NUM_PARAMS
+  // 4. insert the new parameter into the struct ParamStorage
+  // 5. increment the number of parameters in NUM_PARAMS
   // spacemouse-keys.ino
-  // 7. insert a line into the initialization of par (at the right position!!!)
+  // 6. append a line at the end of the initialization of paramDescription
+  //    the number of a parameter is its ID in the EEPROM: never renumber or reuse a number!
+  //    parameters missing in the EEPROM keep their value from config.h, so the EEPROM content stays valid.
+  //    (if the meaning of an existing parameter changes, increment PARAM_VERSION and convert it in getParametersFromEEPROM())
   //    example:
-  //    {PARAM_TYPE_FLOAT, "TEST",          &parStorage.test      }, //      34
-  //     ^type of param     ^name of param   ^pointer to the variable        ^number as comment
+  //    {PARAM_TYPE_FLOAT, PARAM_NAME("TEST"),  offsetof(ParamStorage, test),   1,    1, 9999,  1,  2}, //      39
+  //     ^type of param    ^name of param       ^offset of the variable    ^count ^min ^max  ^step ^dec ^number as comment
+  //    min, max and step are given in the unit of the variable. For PARAM_TYPE_FLOAT min and max are given with dec
+  //    decimals (1, 9999 and 2 -> 0.01..99.99), the step in 1/1000 (-> PARAM_FIXED_SCALE), dec is 0 for BOOL and INT
+  //    values outside of [min..max] are refused by writeParameter()
+  //    count is the number of elements of an array parameter (only BOOL and INT), 1 for a single value
+  //    if the parameter is used to calculate something in advance, update it, when par.changed is set (see loop())
   //
   // because all user-interface handles numbers and the type for the variables is forced now:
   //   use int8_T  for PARAM_TYPE_BOOL  [0 , 1]
   //   use int16_t for PARAM_TYPE_INT   [-9999 .. 9999]
-  //   use double  for PARAM_TYPE_FLOAT [-xx.yyy .. 0.000 .. xx.yyy]
+  //   use double  for PARAM_TYPE_FLOAT (stored with three decimals in the EEPROM, if it fits into int16, else as float)
   //
-  // 8. consider putting the values from 3. as initial values into config.h
-  // 9. compile/download the new program
-  // 10. check the parameters with "list parameters"
-  // 11. modify the parameters as needed with "edit parameters"
-  // 12. store the parameters to the EEPROM with "write to EEPROM"
+  // 7. consider putting the values from 3. as initial values into config.h
+  // 8. compile/download the new program
+  // 9. check the parameters with "list parameters"
+  // 10. modify the parameters as needed with "edit parameters"
+  // 11. store the parameters to the EEPROM with "write to EEPROM"
   //---------------------------------------------------------
 
-  #define NUM_PARAMS         33   // total number of parameters in struct ParamStorage
+  #define NUM_PARAMS         46   // total number of parameters in struct ParamStorage
 
   #define MAX_PARAM_NAME_LEN 10   // maximum length of any parameter name
 
-  #define MAGIC_NUMBER       1209196405L
-  #define BASE_ADDRESS_MAGIC 0
-  #define BASE_ADDRESS_PAR   4
+  //---------------------------------------------------------
+  // EEPROM layout
+  // ---------------------------
+  // BASE_ADDRESS_MAGIC: ParamHeader with magic number, version, length and CRC of the records
+  // BASE_ADDRESS_PAR:   one record per parameter: [ID = parameter number][length][value]
+  //                     BOOL -> int8, INT -> int16, FLOAT -> int16 with three decimals (or float, if it doesn't fit)
+  // The header is written last, so it is only valid, if all records are written completely.
+  //
+  // Layout 1 (MAGIC_NUMBER_V1) was a 1:1 copy of ParamStorage. It is migrated on startup.
+  //---------------------------------------------------------
+  #define MAGIC_NUMBER        1397575730L
+  #define PARAM_VERSION       2      // version of the meaning of the records, see getParametersFromEEPROM()
+  #define BASE_ADDRESS_MAGIC  0
+  #define BASE_ADDRESS_PAR    (BASE_ADDRESS_MAGIC + sizeof(ParamHeader))
+  #define PARAM_FIXED_SCALE   1000.0 // FLOATs are stored as int16 with three decimals, if they fit
+
+  #define MAGIC_NUMBER_V1     1209196405L
+  #define BASE_ADDRESS_PAR_V1 4
+  #define NUM_PARAMS_V1       33     // number of parameters in layout 1
+
+  typedef struct _ParamHeader {
+    int32_t  magic;
+    uint8_t  version;
+    uint8_t  count;                  // number of records
+    uint16_t length;                 // length of all records in bytes
+    uint16_t crc;                    // CRC-CCITT of all records
+    uint16_t reserved;               // 0, gives the same size on all compilers
+  } ParamHeader;
 
   #define PARAM_TYPE_BOOL    1
   #define PARAM_TYPE_INT     2
   #define PARAM_TYPE_FLOAT   3
 
+  // arrays in ParamStorage must not be empty: without keys keyList keeps one unused element, but the parameter
+  // KEYLIST has no elements (PARAM_KEYLIST_COUNT 0), so the menu and ProgMode refuse to read or write it
+  #if NUMKEYS > 255
+    #error "NUMKEYS > 255 doesn't fit into ParamDescription.count"
+  #elif NUMKEYS > 0
+    #define PARAM_NUMKEYS       NUMKEYS
+    #define PARAM_KEYLIST       KEYLIST
+    #define PARAM_KEYLIST_COUNT NUMKEYS
+  #else
+    #define PARAM_NUMKEYS       1
+    #define PARAM_KEYLIST       {0}
+    #define PARAM_KEYLIST_COUNT 0
+  #endif
+
+  // decoupling matrix of the kinematics (see calculateKinematic()): 6 rows TX..RZ of 8 sensor factors in 1/1024.
+  // The defaults are the fixed factors of _calculateKinematicSensors(), debug mode 21 fits the matrix of the unit.
+  // Without KIN_MATRIX the parameters KINMAT_EN and KINMATRIX are kept (with one element), but not used.
+  #ifndef KIN_MATRIX
+    #define KIN_MATRIX       0
+  #endif
+  #ifndef KINMAT_EN
+    #define KINMAT_EN        0
+  #endif
+  #if KIN_MATRIX > 0
+    #define KIN_MATRIX_COUNT 48
+    #ifndef KINMATRIX
+      #ifdef HALLEFFECT
+        //                  HES0   HES1   HES2   HES3   HES6   HES7   HES8   HES9
+        #define KINMATRIX { -512,  +512,     0,     0,  +512,  -512,     0,     0,  /* TX */ \
+                               0,     0,  +512,  -512,     0,     0,  -512,  +512,  /* TY */ \
+                            +256,  +256,  +256,  +256,  +256,  +256,  +256,  +256,  /* TZ */ \
+                            +512,  +512,     0,     0,  -512,  -512,     0,     0,  /* RX */ \
+                               0,     0,  -512,  -512,     0,     0,  +512,  +512,  /* RY */ \
+                            +256,  -256,  +256,  -256,  +256,  -256,  +256,  -256 } /* RZ */
+      #else
+        //                    AX     AY     BX     BY     CX     CY     DX     DY
+        #define KINMATRIX {    0, +1024,     0,     0,     0, -1024,     0,     0,  /* TX */ \
+                               0,     0,     0, -1024,     0,     0,     0, +1024,  /* TY */ \
+                           -1024,     0, -1024,     0, -1024,     0, -1024,     0,  /* TZ */ \
+                           +1024,     0,     0,     0, -1024,     0,     0,     0,  /* RX */ \
+                               0,     0, -1024,     0,     0,     0, +1024,     0,  /* RY */ \
+                               0, +1024,     0, +1024,     0, +1024,     0, +1024 } /* RZ */
+      #endif
+    #endif
+  #else
+    #define KIN_MATRIX_COUNT 1      // arrays in ParamStorage must not be empty
+    #undef  KINMATRIX
+    #define KINMATRIX        {0}
+  #endif
+
+  // linearization of the sensors (see FilterAnalogReadOuts()): per sensor LIN_SEGMENTS-1 inner points of the
+  // negative, then of the positive side. A point is the movement in 1/1000 of the full range at k/LIN_SEGMENTS of
+  // MINVALS or MAXVALS, the outer points 0 and 1000 are fixed. The default is linear (as the two segments of map()),
+  // debug mode 20 fits the table of the unit to the min/max values.
+  // Without LIN_TABLE the parameter LINTABLE is kept (with one element), but not used.
+  #ifndef LIN_TABLE
+    #define LIN_TABLE        0
+  #endif
+  #if LIN_TABLE > 0
+    #define LIN_SEGMENTS     4
+    #define LIN_TABLE_COUNT  (8 * 2 * (LIN_SEGMENTS - 1))
+    #ifndef LINTABLE
+      //                   negative side    positive side
+      #define LINTABLE {   250, 500, 750,   250, 500, 750,  /* sensor 0 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 1 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 2 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 3 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 4 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 5 */ \
+                           250, 500, 750,   250, 500, 750,  /* sensor 6 */ \
+                           250, 500, 750,   250, 500, 750 } /* sensor 7 */
+    #endif
+  #else
+    #define LIN_TABLE_COUNT  1      // arrays in ParamStorage must not be empty
+    #undef  LINTABLE
+    #define LINTABLE         {0}
+  #endif
+
+  // biggest array parameter
+  #if KIN_MATRIX_COUNT >= LIN_TABLE_COUNT
+    #define PARAM_TABLE_COUNT KIN_MATRIX_COUNT
+  #else
+    #define PARAM_TABLE_COUNT LIN_TABLE_COUNT
+  #endif
+  #if PARAM_TABLE_COUNT > PARAM_NUMKEYS && PARAM_TABLE_COUNT > 8
+    #define MAX_PARAM_COUNT  PARAM_TABLE_COUNT
+  #else
+    #define MAX_PARAM_COUNT  (PARAM_NUMKEYS > 8 ? PARAM_NUMKEYS : 8)
+  #endif
+
+  // configs without binary telemetry
+  #ifndef TELEM_DEC
+    #define TELEM_DEC        1
+  #endif
+
+  // order of the conversions in readAllFromJoystick(), SKEW_MODE is only used with SKEW_COMP
+  #ifndef SKEW_COMP
+    #define SKEW_COMP        0
+  #endif
+  #ifndef SKEW_MODE
+    #define SKEW_MODE        0
+  #endif
+
+  // speed adaptive low pass of the velocities, the parameters are only used with VEL_FILTER
+  #ifndef VEL_FILTER
+    #define VEL_FILTER       0
+  #endif
+  #ifndef FILT_EN
+    #define FILT_EN          0
+  #endif
+  #ifndef FILT_CUT
+    #define FILT_CUT         1.0
+  #endif
+  #ifndef FILT_BETA
+    #define FILT_BETA        4.0
+  #endif
+
+  // Without the parameter menu (PARAM_IN_EEPROM 0) and without ProgMode the parameters can't change at runtime.
+  // PARAM_CONST 1 then takes the values of config.h as constants in the hot path (kinematics, axis switching,
+  // drift compensation): the compiler drops the branches and stages, which are switched off, e.g. pow() and tan()
+  // of the modifier with MODFUNC 0. Values changed by the calibration (MINVALS, MAXVALS, LINTABLE, KINMATRIX,
+  // KINMAT_EN) are always read from ParamStorage.
+  #ifndef PARAM_CONST
+    #if PARAM_IN_EEPROM > 0 || ENABLE_PROGMODE > 0
+      #define PARAM_CONST 0
+    #else
+      #define PARAM_CONST 1
+    #endif
+  #endif
+  #if PARAM_CONST > 0 && (PARAM_IN_EEPROM > 0 || ENABLE_PROGMODE > 0)
+    #error "PARAM_CONST 1 needs PARAM_IN_EEPROM 0 and ENABLE_PROGMODE 0"
+  #endif
+
+  // PARAM_VALUE(par, invX, INVX): the parameter invX, with PARAM_CONST 1 the constant INVX of its type
+  #if PARAM_CONST > 0
+    #define PARAM_VALUE(par, field, value) ((decltype(ParamStorage::field))(value))
+  #else
+    #define PARAM_VALUE(par, field, value) ((par).values->field)
+  #endif
+
   typedef struct _ParamStorage {
     int16_t deadzone               = DEADZONE;
 
@@ -86,17 +259,52 @@
 
     int16_t rotAxisEchos           = RAXIS_ECH;
     int16_t rotAxisSimStrength     = RAXIS_STR;    
+
+    int16_t pinList[8]             = PINLIST;
+    int8_t  invertList[8]          = INVERTLIST;
+    int16_t minVals[8]             = MINVALS;
+    int16_t maxVals[8]             = MAXVALS;
+    int16_t keyList[PARAM_NUMKEYS] = PARAM_KEYLIST;
+
+    int16_t telemetryDecimation    = TELEM_DEC;
+
+    int8_t  kinMatrixEnabled       = KINMAT_EN;
+    int16_t kinMatrix[KIN_MATRIX_COUNT] = KINMATRIX;
+
+    int16_t linTable[LIN_TABLE_COUNT] = LINTABLE;
+
+    int16_t skewMode               = SKEW_MODE;
+
+    int8_t  filterEnabled          = FILT_EN;
+    double  filterMinCutoff        = FILT_CUT;
+    double  filterBeta             = FILT_BETA;
   } ParamStorage;
 
+  // offset of a variable in ParamStorage: one byte, while ParamStorage fits into 256 bytes, else two. The tables
+  // (KIN_MATRIX, LIN_TABLE) and the doubles of 8 bytes on other platforms than AVR may need two.
+  template <bool wide> struct ParamOffsetType { typedef uint8_t type; };
+  template <> struct ParamOffsetType<true> { typedef uint16_t type; };
+  typedef ParamOffsetType<(sizeof(ParamStorage) > 0x100)>::type ParamOffset;
+  static_assert(sizeof(ParamStorage) - 1 <= (ParamOffset)~0, "ParamDescription.offset is too small for ParamStorage");
+  #define pgm_read_offset(address) (sizeof(ParamOffset) == 1 ? pgm_read_byte(address) : pgm_read_word(address))
+
+  // description of a parameter, the table of all descriptions is stored in flash (PROGMEM)
+  // and must be read with pgm_read_*()
   typedef struct _ParamDescription {
-    int   type;
-    char  name[MAX_PARAM_NAME_LEN+1];
-    void* storage;
+    uint8_t type;
+    char    name[PARAM_NAME_SIZE];           // empty for LOG_TOKENIZED, see PARAM_NAME()
+    ParamOffset offset;                    // offset of the variable in ParamStorage
+    uint8_t count;                         // number of elements of an array, 1 for a single value
+    int16_t min;                           // limits of the value, FLOAT with decimals
+    int16_t max;
+    uint8_t step;                          // step of the value, FLOAT in 1/PARAM_FIXED_SCALE
+    uint8_t decimals;                      // FLOAT: min and max in 1/10^decimals (0..3), 0 for BOOL and INT
   } ParamDescription;
 
   typedef struct _ParamData {
-    ParamStorage*     values;
-    ParamDescription  description[NUM_PARAMS+1];
+    ParamStorage*           values;
+    const ParamDescription* description;   // PROGMEM table with NUM_PARAMS+1 entries
+    bool                    changed;       // set, when a value was changed, see loop()
   } ParamData;
 
   #if ENABLE_PROGMODE > 0
@@ -105,6 +313,7 @@
       double  value;
       double  retval;
       int16_t paramNo;
+      uint8_t element;                     // element of an array parameter, see >x
     } ProgCmd;
 
     #define PE_OK            10000
@@ -112,13 +321,21 @@
     #define PE_INVALID_VALUE 10002
     #define PE_VALUE_FAULT   10003
     #define PE_CMD_FAULT     10004
+    #define PE_CRC_FAULT     10005
+    #define PE_BUSY          10006  // the EEPROM writer is busy with a save or a clear, see >e
+
+    #define MAX_BLOCK_ERRORS 8      // number of parameters reported as faulty by >b
+    #define BLOCK_TIMEOUT    100    // ms to wait for the next character of a >b telegram
   #endif
 
   int    userInput(double& value);
-  double readParameter(int i, ParamData& par);
-  void   writeParameter(int i, double value, ParamData& par);
+  uint8_t paramCount(int i, ParamData& par);
+  double paramLimit(int i, ParamData& par, bool upper);
+  double readParameter(int i, ParamData& par, uint8_t element = 0);
+  bool   writeParameter(int i, double value, ParamData& par, uint8_t element = 0);
   void   getParametersFromEEPROM(ParamData& par);
   void   putParametersToEEPROM(ParamData& par);
+  void   clearEEPROM();
   void   printParameterName(int i, ParamData& par, bool formatted);
   bool   printOneParameter(int i, ParamData& par, bool line, bool num);
   void   printAllParameters(ParamData& par, bool num);
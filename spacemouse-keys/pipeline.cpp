@@ -0,0 +1,149 @@
+// File for the stages of the frame oriented pipeline, see pipeline.h
+// The stages are called by the sensing in the order of the declaration. They don't print any debug output and don't
+// read the time themselves: all of them use frame.millis, which beginFrame() has read once for the frame.
+
+#include <Arduino.h>
+#include "config.h"
+#include "pipeline.h"
+#include "calibration.h"
+#include "kinematics.h"
+#include "spaceKeys.h"
+#include "SpaceMouseHID.h"
+
+#if NUMKEYS > 0
+// state of the FN1+FN2 zero hotkey
+static bool fnZeroPending = false;
+static unsigned long fnZeroStart = 0;
+static unsigned long fnZeroCooldownUntil = 0;
+#endif
+
+/// @brief Start a new frame: read the time for all stages of the frame and count the frame
+/// @param frame the frame
+void beginFrame(Frame &frame) {
+  frame.millis = millis();
+  frame.micros = micros();
+  frame.sequence++;
+}
+
+/// @brief Read the sensors (0-1023) and the keys
+/// @param frame the frame, sets rawReads[] and keyVals[]
+void readStage(Frame &frame) {
+  readAllFromJoystick(frame.rawReads);
+#if NUMKEYS > 0
+  readAllFromKeys(frame.keyVals);
+#endif
+}
+
+/// @brief Calculate the drift compensation and subtract the centre position and the offsets from the raw values
+/// @param frame the frame, sets offsets[] and centered[]
+/// @param centerPoints zero position of the sensors
+/// @param compensate false: no drift compensation, e.g. while the min/max values are calibrated
+/// @param par parameters, the compensation is only used with COMP_EN
+void centerStage(Frame &frame, int *centerPoints, bool compensate, ParamData &par) {
+  if (compensate && PARAM_VALUE(par, compEnabled, COMP_EN) == 1) {
+    compensateDrifts(frame.rawReads, centerPoints, frame.offsets, par);
+  } else {
+    for (uint8_t i = 0; i < 8; i++) {
+      frame.offsets[i] = 0;
+    }
+  }
+  for (uint8_t i = 0; i < 8; i++) {
+    frame.centered[i] = frame.rawReads[i] - centerPoints[i] + frame.offsets[i];
+  }
+}
+
+/// @brief Set the centered values to zero below the deadzone and scale them to +/-350
+/// @param frame the frame, changes centered[]
+/// @param par parameters
+void filterStage(Frame &frame, ParamData &par) {
+  FilterAnalogReadOuts(frame.centered, par);
+}
+
+/// @brief Calculate the kinematics (centered -> velocity)
+/// @param frame the frame, sets velocity[]
+/// @param par parameters
+void kinematicStage(Frame &frame, ParamData &par) {
+  calculateKinematic(frame.centered, frame.velocity, par, frame.micros);
+}
+
+/// @brief Debounce the keys with the time of the frame
+/// @param frame the frame, sets keyOut[] and keyState[]
+void keyStage(Frame &frame) {
+#if NUMKEYS > 0
+  evalKeys(frame.keyVals, frame.keyOut, frame.keyState, frame.millis);
+#else
+  (void)frame;
+#endif
+}
+
+/// @brief Build the keys of the HID report and zero the sensors, when FN1+FN2 are held for FN_ZERO_HOLD_MS without
+/// any other key. While they are held, no key is reported.
+/// @param frame the frame, sets hidKeys[] from keyState[]
+/// @param centerPoints zero position of the sensors, which is updated
+void zeroHotkeyStage(Frame &frame, int *centerPoints) {
+#if NUMKEYS > 0
+  memcpy(frame.hidKeys, frame.keyState, NUMKEYS);
+
+  const bool hasFn1 = (KEY_FN1_IDX < NUMKEYS) ? (frame.hidKeys[KEY_FN1_IDX] != 0) : false;
+  const bool hasFn2 = (KEY_FN2_IDX < NUMKEYS) ? (frame.hidKeys[KEY_FN2_IDX] != 0) : false;
+
+  bool anyOther = false;
+  for (int i = 0; i < NUMHIDKEYS; ++i) {
+    if (i == KEY_FN1_IDX || i == KEY_FN2_IDX) continue;
+    if (frame.hidKeys[i]) { anyOther = true; break; }
+  }
+
+  if (hasFn1 && hasFn2 && !anyOther && frame.millis >= fnZeroCooldownUntil) {
+    if (!fnZeroPending) {
+      fnZeroPending = true;
+      fnZeroStart = frame.millis;
+    }
+    for (int i = 0; i < NUMKEYS; ++i) frame.hidKeys[i] = 0;
+
+    if (frame.millis - fnZeroStart >= FN_ZERO_HOLD_MS) {
+      // zero only the centre points, not the min/max values or the sensitivities
+      busyZeroing(centerPoints, FN_ZERO_SAMPLES, false);
+      fnZeroPending = false;
+      // the zeroing takes most of a second: the cooldown starts after it, not at the time of the frame
+      fnZeroCooldownUntil = millis() + FN_ZERO_COOLDOWN_MS;
+    }
+  } else {
+    fnZeroPending = false;
+  }
+#else
+  (void)frame;
+  (void)centerPoints;
+#endif
+}
+
+/// @brief Kill the rotations or translations as long as the kill keys are pressed (NUMKILLKEYS 2)
+/// @param frame the frame, changes velocity[]
+void killKeyStage(Frame &frame) {
+#if (NUMKILLKEYS == 2)
+  // check for the raw keyVal and not keyOut, because keyOut is only 1 for a single frame. keyVals has inverse logic due to pull-ups
+  if (frame.keyVals[KILLROT] == LOW) {
+    frame.velocity[ROTX] = 0;
+    frame.velocity[ROTY] = 0;
+    frame.velocity[ROTZ] = 0;
+  }
+  if (frame.keyVals[KILLTRANS] == LOW) {
+    frame.velocity[TRANSX] = 0;
+    frame.velocity[TRANSY] = 0;
+    frame.velocity[TRANSZ] = 0;
+  }
+#else
+  (void)frame;
+#endif
+}
+
+/// @brief Exchange the axes (SWITCHYZ, SWITCHXY) and apply the exclusive mode: rotation OR translation
+/// @param frame the frame, changes velocity[]
+/// @param par parameters
+void axisStage(Frame &frame, ParamData &par) {
+  if (PARAM_VALUE(par, switchYZ, SWITCHYZ) == 1) {switchYZ(frame.velocity);}
+  if (PARAM_VALUE(par, switchXY, SWITCHXY) == 1) {switchXY(frame.velocity);}
+
+  if (PARAM_VALUE(par, exclusiveMode, EXCLUSIVE) == 1) {
+    exclusiveMode(frame.velocity, PARAM_VALUE(par, exclusiveHysteresis, EXCL_HYST));
+  }
+}
@@ -0,0 +1,36 @@
+// Header for the frame oriented pipeline
+// One pass of the sensing (loop() or the sensing task of the scheduler) is a frame. The Frame holds the time of the
+// frame, read once by beginFrame(), a sequence number and all values, which the stages calculate from each other.
+// Each stage gets the frame by reference, so the stages of one frame see the same time, and the host build can run
+// and benchmark single stages with its own frames. The debug output between the stages stays in the sketch.
+#ifndef PIPELINE_H
+  #define PIPELINE_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "parameterMenu.h"
+
+  typedef struct _Frame {
+    unsigned long millis;       // time of the frame
+    unsigned long micros;       // time in us, when the sensors of the frame are read (age of the HID report)
+    uint16_t sequence;          // counts the frames
+    int      rawReads[8];       // raw analog values of the sensors, 0..1023
+    int      offsets[8];        // drift compensation of the sensors
+    int      centered[8];       // after zeroing and drift compensation, after filterStage() with deadzone and mapping
+    int16_t  velocity[6];       // resulting velocities, int16_t to match what the HID protocol expects
+    int      keyVals[NUMKEYS];  // raw value of the keys, without debouncing
+    uint8_t  keyOut[NUMKEYS];   // key event after debouncing, 1 only for a single frame
+    uint8_t  keyState[NUMKEYS]; // state of the key, which stays 1 as long as the key is pressed
+    uint8_t  hidKeys[NUMKEYS];  // keys for the HID report: keyState[] without the keys held for the zero hotkey
+  } Frame;
+
+  void beginFrame(Frame &frame);
+  void readStage(Frame &frame);
+  void centerStage(Frame &frame, int *centerPoints, bool compensate, ParamData &par);
+  void filterStage(Frame &frame, ParamData &par);
+  void kinematicStage(Frame &frame, ParamData &par);
+  void keyStage(Frame &frame);
+  void zeroHotkeyStage(Frame &frame, int *centerPoints);
+  void killKeyStage(Frame &frame);
+  void axisStage(Frame &frame, ParamData &par);
+#endif
@@ -0,0 +1,182 @@
+// File for the cooperative task scheduler (TASK_SCHEDULER 1)
+//
+// loop() calls runScheduler(), which runs one task of the task table per call:
+// - the first periodic task in the table, whose release has come. The releases stay on the grid of the period,
+//   a late start doesn't shift the following releases. A task, which finishes after its next release, counts as
+//   deadline miss. Releases, which have passed completely in the meantime, are dropped and count as misses, too.
+// - otherwise the next task for the remaining time (in turn), if its budget fits before the next release, or if it
+//   didn't run for BACKGROUND_MAX_WAIT_US. Each of them gets one chance between two periodic tasks.
+// - otherwise it waits for the next release.
+// The watchdog runs in interrupt mode as overrun alarm: if a task doesn't return within 250 ms, WDT_vect counts an
+// alarm for the running task (e.g. the zeroing in debug mode 11). It doesn't reset the controller: the Arduino core
+// uses the watchdog for the jump into the bootloader (1200 baud touch), therefore it is not fed, once WDE is set.
+
+#include <Arduino.h>
+#include <avr/wdt.h>
+#include "config.h"
+#include "scheduler.h"
+#include "logMessages.h"
+
+#if TASK_SCHEDULER > 0
+
+#define MAX_TASKS 6
+#define NO_TASK 0xFF
+#define BACKGROUND_MAX_WAIT_US 16000 // a task for the remaining time runs at least this often
+
+static const Task *taskTable;
+static uint8_t numTasks = 0;
+static TaskStats stats[MAX_TASKS];   // release: for the tasks for the remaining time the start of the last run
+static uint8_t nextBackground = 0;   // the next task for the remaining time is searched from here
+static uint8_t checked = 0;          // tasks checked for the remaining time since the last periodic task
+static volatile uint8_t runningTask = NO_TASK;
+static volatile uint16_t watchdogAlarms = 0;
+static volatile uint8_t alarmTask = NO_TASK;
+
+/// @brief Watchdog interrupt: a task didn't return within the watchdog timeout
+ISR(WDT_vect) {
+  watchdogAlarms++;
+  alarmTask = runningTask;
+}
+
+/// @brief Start the scheduler with a task table. Call this once at the end of setup().
+/// @param table task table in flash, first the periodic tasks by priority, then the tasks for the remaining time
+/// @param count number of tasks, at most MAX_TASKS
+void initScheduler(const Task *table, uint8_t count) {
+  taskTable = table;
+  numTasks = min(count, (uint8_t)MAX_TASKS);
+  unsigned long now = micros();
+  for (uint8_t i = 0; i < numTasks; i++) {
+    stats[i].release = now;
+    stats[i].maxMicros = 0;
+    stats[i].misses = 0;
+    stats[i].overruns = 0;
+  }
+  nextBackground = 0;
+  checked = 0;
+  runningTask = NO_TASK;
+  watchdogAlarms = 0;
+  alarmTask = NO_TASK;
+
+  // watchdog in interrupt mode with 250 ms
+  cli();
+  wdt_reset();
+  WDTCSR = _BV(WDCE) | _BV(WDE); // timed sequence: change within 4 cycles
+  WDTCSR = _BV(WDIE) | _BV(WDP2);
+  sei();
+}
+
+/// @brief Run a task and update its statistics
+/// @param i number of the task
+/// @param task the task, copied from flash
+static void runTask(uint8_t i, const Task &task) {
+  if (!(WDTCSR & _BV(WDE))) {
+    wdt_reset(); // WDE is set by the core before the jump into the bootloader
+  }
+  runningTask = i;
+  unsigned long start = micros();
+  task.run();
+  unsigned long used = micros() - start;
+  runningTask = NO_TASK;
+  if (used > stats[i].maxMicros) {
+    stats[i].maxMicros = used;
+  }
+  if (used > task.budgetMicros) {
+    stats[i].overruns++;
+  }
+}
+
+/// @brief Run the next task of the task table. Call this in loop().
+void runScheduler() {
+  Task task;
+  unsigned long now = micros();
+  unsigned long wait = BACKGROUND_MAX_WAIT_US; // until the next release
+
+  // the first periodic task, which is due
+  for (uint8_t i = 0; i < numTasks; i++) {
+    memcpy_P(&task, &taskTable[i], sizeof(Task));
+    if (task.periodMicros == 0) {
+      continue;
+    }
+    long late = (long)(now - stats[i].release);
+    if (late < 0) {
+      wait = min(wait, (unsigned long)-late);
+      continue;
+    }
+    runTask(i, task);
+    checked = 0;
+    unsigned long end = micros();
+    stats[i].release += task.periodMicros;
+    if ((long)(end - stats[i].release) > 0) {
+      stats[i].misses++; // finished after the next release
+    }
+    while ((long)(end - stats[i].release) >= (long)task.periodMicros) {
+      stats[i].release += task.periodMicros; // passed completely: dropped
+      stats[i].misses++;
+    }
+    return;
+  }
+
+  // the next task for the remaining time, which fits before the next release or has waited too long
+  while (checked < numTasks) {
+    checked++;
+    uint8_t i = nextBackground;
+    nextBackground = (nextBackground + 1) % numTasks;
+    memcpy_P(&task, &taskTable[i], sizeof(Task));
+    if (task.periodMicros != 0) {
+      continue;
+    }
+    if (task.budgetMicros <= wait || now - stats[i].release >= BACKGROUND_MAX_WAIT_US) {
+      stats[i].release = now;
+      runTask(i, task);
+      return;
+    }
+  }
+
+  // nothing fits: wait for the next release
+  delayMicroseconds(wait);
+}
+
+/// @brief Print a part of the run time statistics of all tasks and the watchdog alarms (debug mode 71). The output
+/// is split into parts of a few bytes, so a task for the remaining time can print it without delaying the sensing.
+/// @param part the part to print, start with 0
+/// @return the next part, 0 after the last one
+uint8_t printTaskStats(uint8_t part) {
+  uint8_t i = part / 5;
+  if (i >= numTasks) {
+    logPrint(MSG_WDT_ALARMS);
+    Serial.print(watchdogAlarms);
+    if (alarmTask != NO_TASK) {
+      logPrint(MSG_WDT_TASK);
+      Serial.print(alarmTask);
+    }
+    Serial.println();
+    return 0;
+  }
+  Task task;
+  memcpy_P(&task, &taskTable[i], sizeof(Task));
+  switch (part % 5) {
+    case 0:
+      logPrint(MSG_TASK);
+      Serial.print(i);
+      break;
+    case 1:
+      logPrint(MSG_TASK_MAX);
+      Serial.print(stats[i].maxMicros);
+      break;
+    case 2:
+      logPrint(MSG_TASK_BUDGET);
+      Serial.print(task.budgetMicros);
+      break;
+    case 3:
+      logPrint(MSG_TASK_MISSES);
+      Serial.print(stats[i].misses);
+      break;
+    default:
+      logPrint(MSG_TASK_OVERRUNS);
+      Serial.println(stats[i].overruns);
+      break;
+  }
+  return part + 1;
+}
+
+#endif
@@ -0,0 +1,36 @@
+// Header for the cooperative task scheduler (TASK_SCHEDULER 1)
+// Instead of running all stages one after another as fast as possible, loop() dispatches the tasks of a fixed
+// task table: periodic tasks are released on a fixed time grid, the others run in the remaining time.
+#ifndef SCHEDULER_H
+  #define SCHEDULER_H
+
+  #include <Arduino.h>
+  #include "config.h"
+
+  #ifndef TASK_SCHEDULER
+    #define TASK_SCHEDULER 0
+  #endif
+  #ifndef SENSE_PERIOD_US
+    #define SENSE_PERIOD_US 1250
+  #endif
+
+  // One entry of the task table. The table is stored in flash: first the periodic tasks in the order of their
+  // priority, then the tasks for the remaining time (periodMicros 0).
+  typedef struct _Task {
+    void (*run)();          // the task, it has to return within its budget
+    uint32_t periodMicros;  // release period, 0: runs in the remaining time before the next release
+    uint16_t budgetMicros;  // declared run time
+  } Task;
+
+  // Run time statistics of a task, see printTaskStats()
+  typedef struct _TaskStats {
+    uint32_t release;       // next release of a periodic task
+    uint32_t maxMicros;     // longest run, 32 bit: blocking debug modes (e.g. the zeroing) take seconds
+    uint16_t misses;        // periodic: not finished before the next release, or a release was dropped
+    uint16_t overruns;      // ran longer than the budget
+  } TaskStats;
+
+  void initScheduler(const Task *table, uint8_t count);
+  void runScheduler();
+  uint8_t printTaskStats(uint8_t part);
+#endif
@@ -2,15 +2,17 @@
 // Please open config_sample.h, adjust your settings and save it as config.h
 #include "config.h"
 #include <Arduino.h>
+#include "spaceKeys.h"
 // check config.h if this functions and variables are needed
 #if NUMKEYS > 0
 
-// array with the pin definition of all keys
-int keyList[NUMKEYS] = KEYLIST;
+// array with the pin definition of all keys, taken from the parameter KEYLIST by setupKeys()
+static uint8_t keyList[NUMKEYS];
 
-// Function to setup up all keys in keyList
-void setupKeys() {
+// Function to setup up all keys in keyList. Call this at startup and every time the parameters were changed.
+void setupKeys(ParamData& par) {
   for (int i = 0; i < NUMKEYS; i++) {
+    keyList[i] = par.values->keyList[i];
     pinMode(keyList[i], INPUT_PULLUP);
   }
 }
@@ -23,8 +25,8 @@ void readAllFromKeys(int* keyVals) {
 }
 
 // Evaluate and debounce all keys from the raw keyVals into the debounced keyOut event or the debounced keyState.
-// The keyOut is only 1 for one iteration of the loop.
-void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState) {
+// The keyOut is only 1 for one iteration of the loop. now is the time of the frame from millis().
+void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState, unsigned long now) {
   static unsigned long timestamp[NUMKEYS];                 // needed for key evaluation
 
   //Button Evaluation
@@ -36,7 +38,7 @@ void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState) {
       if (keyState[i] == 0) {  // if the button has not been pressed lately:
         keyOut[i] = 1;               // this is the variable telling the outside world only one iteration, that the key was pressed
         keyState[i] = 1;       // remember, that we already told the outside world about this key
-        timestamp[i] = millis();     // remember the time, the button was pressed
+        timestamp[i] = now;          // remember the time, the button was pressed
         #ifdef DEBUG_KEYS
         Serial.println("");
         Serial.print("Key: ");       // this is always sent over the serial console, and not only in debug
@@ -48,7 +50,7 @@ void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState) {
     } else {                         // the button is not pressed
       if (keyState[i] == 1) {  // has it been pressed lately?
         // debouncing:
-        if (millis() - timestamp[i] > DEBOUNCE_KEYS_MS) {  // check if the last button press is long enough in the past
+        if (now - timestamp[i] > DEBOUNCE_KEYS_MS) {  // check if the last button press is long enough in the past
           keyState[i] = 0;                           // reset this marker and allow a new button press
         }
       }
@@ -1,6 +1,8 @@
 // header for spaceKeys.cpp
 // Handle all the keys for the spacemouse
 
+#include "parameterMenu.h"
+
 void readAllFromKeys(int* keyVals);
-void setupKeys();
-void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState);
+void setupKeys(ParamData& par);
+void evalKeys(int* keyVals, uint8_t* keyOut, uint8_t* keyState, unsigned long now);
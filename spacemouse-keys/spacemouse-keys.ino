@@ -36,6 +36,33 @@
 #include "ledring.h"
 #endif
 
+// binary telemetry in debug mode 40
+#include "telemetry.h"
+
+// task table and scheduler for TASK_SCHEDULER 1
+#include "scheduler.h"
+
+// texts of the menus and diagnostic output, optionally sent as tokens
+#include "logMessages.h"
+
+// the stages of the sensing, which work on a Frame
+#include "pipeline.h"
+
+// micro-benchmark in debug mode 72
+#include "microBench.h"
+
+// flight recorder, dumped in debug mode 73
+#include "flightRecorder.h"
+
+// minimum free stack in debug mode 74
+#include "stackMonitor.h"
+
+// latency of the HID reports in debug mode 75
+#include "latency.h"
+
+// fewer frames and sleep at rest (IDLE_MODE 1)
+#include "idleMode.h"
+
 void setup();
 void loop();
 #ifdef LEDpin
@@ -43,88 +70,81 @@ void lightSimpleLED(boolean light);
 #endif
 #ifdef HALLEFFECT
 void setAnalogReferenceVoltage(int dbg);
+#if TASK_SCHEDULER > 0
+static unsigned long referenceSettled = 0; // millis(), when the analog reference has settled after a change
+#endif
+#endif
+#if TASK_SCHEDULER > 0
+extern const Task taskTable[];
+extern const uint8_t taskCount;
 #endif
 
-// stores the raw analog values from the joysticks
-int rawReads[8];
-
-// stores the values from the joysticks after zeroing and mapping
-int centered[8];
+// the values of the actual frame: raw values, offsets, centered values, velocities and keys
+Frame frame;
 
 // Centerpoints store the zero position of the joysticks
 int centerPoints[8];
 
-
-
-
-
-// === FN1+FN2 zero hotkey state ===
-static bool g_fnZeroPending = false;
-static unsigned long g_fnZeroStart = 0;
-static unsigned long g_fnZeroCooldownUntil = 0;
-
-
-
-
-
-// Offsets store the drift-compensation values of the joysticks
-int offsets[8];
-
-// Resulting calculated velocities / movements
-// int16_t to match what the HID protocol expects.
-int16_t velocity[6];
-
 // global parameters (also stored in EEPROM)
 ParamStorage parStorage;
 
+// description of the parameters (also stored in EEPROM), the table resides in flash to save RAM
+const ParamDescription paramDescription[NUM_PARAMS+1] PROGMEM = {
+// type              name                      offset of the variable                            count    min    max step  dec   number
+  {PARAM_TYPE_BOOL,  PARAM_NAME(""),           0,                                                    0,     0,     0,  1,   0}, // param 0 is unused
+  {PARAM_TYPE_INT,   PARAM_NAME("DEADZONE"),   offsetof(ParamStorage, deadzone),                     1,     0,  1000,  1,   0}, //       1
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_TX"),    offsetof(ParamStorage, transX_sensitivity),           1,     1, 32767,  1,   2}, //       2
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_TY"),    offsetof(ParamStorage, transY_sensitivity),           1,     1, 32767,  1,   2}, //       3
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_PTZ"),   offsetof(ParamStorage, pos_transZ_sensitivity),       1,     1, 32767,  1,   2}, //       4
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_NTZ"),   offsetof(ParamStorage, neg_transZ_sensitivity),       1,     1, 32767,  1,   2}, //       5
+  {PARAM_TYPE_FLOAT, PARAM_NAME("GATE_NTZ"),   offsetof(ParamStorage, gate_neg_transZ),              1,     0,  1000,  1,   0}, //       6
+  {PARAM_TYPE_INT,   PARAM_NAME("GATE_RX"),    offsetof(ParamStorage, gate_rotX),                    1,     0,  1000,  1,   0}, //       7
+  {PARAM_TYPE_INT,   PARAM_NAME("GATE_RY"),    offsetof(ParamStorage, gate_rotY),                    1,     0,  1000,  1,   0}, //       8
+  {PARAM_TYPE_INT,   PARAM_NAME("GATE_RZ"),    offsetof(ParamStorage, gate_rotZ),                    1,     0,  1000,  1,   0}, //       9
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_RX"),    offsetof(ParamStorage, rotX_sensitivity),             1,     1, 32767,  1,   2}, //      10
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_RY"),    offsetof(ParamStorage, rotY_sensitivity),             1,     1, 32767,  1,   2}, //      11
+  {PARAM_TYPE_FLOAT, PARAM_NAME("SENS_RZ"),    offsetof(ParamStorage, rotZ_sensitivity),             1,     1, 32767,  1,   2}, //      12
+  {PARAM_TYPE_INT,   PARAM_NAME("MODFUNC"),    offsetof(ParamStorage, modFunc),                      1,     0,     3,  1,   0}, //      13
+  {PARAM_TYPE_FLOAT, PARAM_NAME("MOD_A"),      offsetof(ParamStorage, slope_at_zero),                1,     1,  1000,  1,   2}, //      14
+  {PARAM_TYPE_FLOAT, PARAM_NAME("MOD_B"),      offsetof(ParamStorage, slope_at_end),                 1,     1,   157,  1,   2}, //      15
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVX"),       offsetof(ParamStorage, invX),                         1,     0,     1,  1,   0}, //      16
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVY"),       offsetof(ParamStorage, invY),                         1,     0,     1,  1,   0}, //      17
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVZ"),       offsetof(ParamStorage, invZ),                         1,     0,     1,  1,   0}, //      18
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVRX"),      offsetof(ParamStorage, invRX),                        1,     0,     1,  1,   0}, //      19
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVRY"),      offsetof(ParamStorage, invRY),                        1,     0,     1,  1,   0}, //      20
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVRZ"),      offsetof(ParamStorage, invRZ),                        1,     0,     1,  1,   0}, //      21
+  {PARAM_TYPE_BOOL,  PARAM_NAME("SWITCHXY"),   offsetof(ParamStorage, switchXY),                     1,     0,     1,  1,   0}, //      22
+  {PARAM_TYPE_BOOL,  PARAM_NAME("SWITCHYZ"),   offsetof(ParamStorage, switchYZ),                     1,     0,     1,  1,   0}, //      23
+  {PARAM_TYPE_BOOL,  PARAM_NAME("EXCLUSIVE"),  offsetof(ParamStorage, exclusiveMode),                1,     0,     1,  1,   0}, //      24
+  {PARAM_TYPE_INT,   PARAM_NAME("EXCL_HYST"),  offsetof(ParamStorage, exclusiveHysteresis),          1,     0,  1000,  1,   0}, //      25
+  {PARAM_TYPE_BOOL,  PARAM_NAME("EXCL_PRIOZ"), offsetof(ParamStorage, prioZexclusiveMode),           1,     0,     1,  1,   0}, //      26
+  {PARAM_TYPE_BOOL,  PARAM_NAME("COMP_EN"),    offsetof(ParamStorage, compEnabled),                  1,     0,     1,  1,   0}, //      27
+  {PARAM_TYPE_INT,   PARAM_NAME("COMP_NR"),    offsetof(ParamStorage, compNoOfPoints),               1,     1,  9999,  1,   0}, //      28
+  {PARAM_TYPE_INT,   PARAM_NAME("COMP_WAIT"),  offsetof(ParamStorage, compWaitTime),                 1,     0,  9999,  1,   0}, //      29
+  {PARAM_TYPE_INT,   PARAM_NAME("COMP_MDIFF"), offsetof(ParamStorage, compMinMaxDiff),               1,     0,  1000,  1,   0}, //      30
+  {PARAM_TYPE_INT,   PARAM_NAME("COMP_CDIFF"), offsetof(ParamStorage, compCenterDiff),               1,     0,  1000,  1,   0}, //      31
+  {PARAM_TYPE_INT,   PARAM_NAME("RAXIS_ECH"),  offsetof(ParamStorage, rotAxisEchos),                 1,     0,  9999,  1,   0}, //      32
+  {PARAM_TYPE_INT,   PARAM_NAME("RAXIS_STR"),  offsetof(ParamStorage, rotAxisSimStrength),           1,     0,  9999,  1,   0}, //      33
+  {PARAM_TYPE_INT,   PARAM_NAME("PINLIST"),    offsetof(ParamStorage, pinList),                      8,     0,    30,  1,   0}, //      34
+  {PARAM_TYPE_BOOL,  PARAM_NAME("INVERTLIST"), offsetof(ParamStorage, invertList),                   8,     0,     1,  1,   0}, //      35
+  {PARAM_TYPE_INT,   PARAM_NAME("MINVALS"),    offsetof(ParamStorage, minVals),                      8, -1023,     0,  1,   0}, //      36
+  {PARAM_TYPE_INT,   PARAM_NAME("MAXVALS"),    offsetof(ParamStorage, maxVals),                      8,     0,  1023,  1,   0}, //      37
+  {PARAM_TYPE_INT,   PARAM_NAME("KEYLIST"),    offsetof(ParamStorage, keyList),    PARAM_KEYLIST_COUNT,     0,    30,  1,   0}, //      38
+  {PARAM_TYPE_INT,   PARAM_NAME("TELEM_DEC"),  offsetof(ParamStorage, telemetryDecimation),          1,     1,  1000,  1,   0}, //      39
+  {PARAM_TYPE_BOOL,  PARAM_NAME("KINMAT_EN"),  offsetof(ParamStorage, kinMatrixEnabled),             1,     0,     1,  1,   0}, //      40
+  {PARAM_TYPE_INT,   PARAM_NAME("KINMATRIX"),  offsetof(ParamStorage, kinMatrix),     KIN_MATRIX_COUNT, -9999,  9999,  1,   0}, //      41
+  {PARAM_TYPE_INT,   PARAM_NAME("LINTABLE"),   offsetof(ParamStorage, linTable),       LIN_TABLE_COUNT,     0,  1000,  1,   0}, //      42
+  {PARAM_TYPE_INT,   PARAM_NAME("SKEW_MODE"),  offsetof(ParamStorage, skewMode),                     1,     0,     2,  1,   0}, //      43
+  {PARAM_TYPE_BOOL,  PARAM_NAME("FILT_EN"),    offsetof(ParamStorage, filterEnabled),                1,     0,     1,  1,   0}, //      44
+  {PARAM_TYPE_FLOAT, PARAM_NAME("FILT_CUT"),   offsetof(ParamStorage, filterMinCutoff),              1,     1, 32767,  1,   2}, //      45
+  {PARAM_TYPE_FLOAT, PARAM_NAME("FILT_BETA"),  offsetof(ParamStorage, filterBeta),                   1,     0, 32767,  1,   2}  //      46
+};
+
 ParamData par = { .values      = &parStorage,
-                  .description = {
-                    {PARAM_TYPE_BOOL,  "",            NULL                              }, // param 0 is unused
-                    {PARAM_TYPE_INT,   "DEADZONE",    &parStorage.deadzone              }, //       1
-                    {PARAM_TYPE_FLOAT, "SENS_TX",     &parStorage.transX_sensitivity    }, //       2
-                    {PARAM_TYPE_FLOAT, "SENS_TY",     &parStorage.transY_sensitivity    }, //       3
-                    {PARAM_TYPE_FLOAT, "SENS_PTZ",    &parStorage.pos_transZ_sensitivity}, //       4
-                    {PARAM_TYPE_FLOAT, "SENS_NTZ",    &parStorage.neg_transZ_sensitivity}, //       5
-                    {PARAM_TYPE_FLOAT, "GATE_NTZ",    &parStorage.gate_neg_transZ       }, //       6
-                    {PARAM_TYPE_INT,   "GATE_RX",     &parStorage.gate_rotX             }, //       7
-                    {PARAM_TYPE_INT,   "GATE_RY",     &parStorage.gate_rotY             }, //       8
-                    {PARAM_TYPE_INT,   "GATE_RZ",     &parStorage.gate_rotZ             }, //       9
-                    {PARAM_TYPE_FLOAT, "SENS_RX",     &parStorage.rotX_sensitivity      }, //      10
-                    {PARAM_TYPE_FLOAT, "SENS_RY",     &parStorage.rotY_sensitivity      }, //      11
-                    {PARAM_TYPE_FLOAT, "SENS_RZ",     &parStorage.rotZ_sensitivity      }, //      12
-                    {PARAM_TYPE_INT,   "MODFUNC",     &parStorage.modFunc               }, //      13
-                    {PARAM_TYPE_FLOAT, "MOD_A",       &parStorage.slope_at_zero         }, //      14
-                    {PARAM_TYPE_FLOAT, "MOD_B",       &parStorage.slope_at_end          }, //      15
-                    {PARAM_TYPE_BOOL,  "INVX",        &parStorage.invX                  }, //      16
-                    {PARAM_TYPE_BOOL,  "INVY",        &parStorage.invY                  }, //      17
-                    {PARAM_TYPE_BOOL,  "INVZ",        &parStorage.invZ                  }, //      18
-                    {PARAM_TYPE_BOOL,  "INVRX",       &parStorage.invRX                 }, //      19
-                    {PARAM_TYPE_BOOL,  "INVRY",       &parStorage.invRY                 }, //      20
-                    {PARAM_TYPE_BOOL,  "INVRZ",       &parStorage.invRZ                 }, //      21
-                    {PARAM_TYPE_BOOL,  "SWITCHXY",    &parStorage.switchXY              }, //      22
-                    {PARAM_TYPE_BOOL,  "SWITCHYZ",    &parStorage.switchYZ              }, //      23
-                    {PARAM_TYPE_BOOL,  "EXCLUSIVE",   &parStorage.exclusiveMode         }, //      24
-                    {PARAM_TYPE_INT,   "EXCL_HYST",   &parStorage.exclusiveHysteresis   }, //      25
-                    {PARAM_TYPE_BOOL,  "EXCL_PRIOZ",  &parStorage.prioZexclusiveMode    }, //      26
-                    {PARAM_TYPE_BOOL,  "COMP_EN",     &parStorage.compEnabled           }, //      27
-                    {PARAM_TYPE_INT,   "COMP_NR",     &parStorage.compNoOfPoints        }, //      28
-                    {PARAM_TYPE_INT,   "COMP_WAIT",   &parStorage.compWaitTime          }, //      29
-                    {PARAM_TYPE_INT,   "COMP_MDIFF",  &parStorage.compMinMaxDiff        }, //      30
-                    {PARAM_TYPE_INT,   "COMP_CDIFF",  &parStorage.compCenterDiff        }, //      31
-                    {PARAM_TYPE_INT,   "RAXIS_ECH",   &parStorage.rotAxisEchos          }, //      32
-                    {PARAM_TYPE_INT,   "RAXIS_STR",   &parStorage.rotAxisSimStrength    }  //      33
-                  }
+                  .description = paramDescription,
+                  .changed     = true
                 };
 
-//store raw value of the keys, without debouncing
-int keyVals[NUMKEYS];
-
-// key event, after debouncing. It is 1 only for a single sample
-uint8_t keyOut[NUMKEYS];
-
-// state of the key, which stays 1 as long as the key is pressed
-uint8_t keyState[NUMKEYS];
-
 
 /**
  * @brief Setup the SpaceMouse, called by system-start
@@ -134,10 +154,12 @@ void setup() {
   #if PARAM_IN_EEPROM > 0
   getParametersFromEEPROM(par);
   #endif
+  updateJoystickTables(par);
+  par.changed = false;
 
   // setup the keys e.g. to internal pull-ups
   #if NUMKEYS > 0
-  setupKeys();
+  setupKeys(par);
   #endif
 
   #ifdef HALLEFFECT
@@ -154,7 +176,7 @@ void setup() {
   // zero the joystick position 500 times (takes approx. 480 ms)
   // during setup() we are not interested in the debug output: debugFlag = false
   busyZeroing(centerPoints, 750, false);
-  for(int i=0; i<8; i++){offsets[i] = 0;}
+  for(int i=0; i<8; i++){frame.offsets[i] = 0;}
 
   #if ROTARY_AXIS > 0 or ROTARY_KEYS > 0
   initEncoderWheel();
@@ -168,19 +190,31 @@ void setup() {
   pinMode(LEDpin, OUTPUT);
   #endif
   #endif
+
+  #if TASK_SCHEDULER > 0
+  initScheduler(taskTable, taskCount);
+  #endif
 }
 
 
+// the debug mode can be set during runtime via the serial interface. See config.h for a description of the different debug modes.
+static int  debug     = STARTDEBUG;
+static bool showMenu  = false;
+
+// the last call of send_command() has sent a HID report
+static bool reportSent = false;
+
+#if IDLE_MODE > 0
+// idle mode: the frame ended after the motion check, without the calculations and the HID report
+static bool motionCheckOnly = false;
+#endif
+
 /**
- * @brief Main-loop of the SpaceMouse, called cyclic by system
+ * @brief Serial interface: debug mode, debug menu, ProgMode and parameter menu. Takes over changed parameters.
  */
-void loop() {
-  // the debug mode can be set during runtime via the serial interface. See config.h for a description of the different debug modes.
-  static int  debug     = STARTDEBUG;
-  static bool showMenu  = false;
-
+static void menuTask() {
   //--- check if the user entered a debug mode via serial interface
-  if((debug != 20) && (debug != 30)){       //SNo: don't change debug-mode/menu when calcMinMax() or parameterMenu() are running
+  if((debug != 20) && (debug != 30) && !(KIN_MATRIX > 0 && debug == 21)){  //SNo: don't change debug-mode/menu when calcMinMax(), calcKinematicMatrix() or parameterMenu() are running
     double num;
 
     int state = userInput(num);
@@ -199,32 +233,100 @@ void loop() {
     if((state != 0) && (debug == 0 || debug == 99)){showMenu = true;}
 
     if(showMenu){
-      Serial.print(F("\r\n\r\nSpaceMouse FW"));Serial.print(F(FW_RELEASE));Serial.println(F(" - Debug Modes"));
-      Serial.println(F("ESC stop running mode, leave menu (ESC, Q)"));
-      Serial.println(F("  1 raw sensors ADC values full range, max. 0..1023"));
+      logPrint(MSG_DEBUG_TITLE);Serial.print(F(FW_RELEASE));logPrintln(MSG_DEBUG_MODES);
+      logPrintln(MSG_DEBUG_ESC);
+      #if DEBUG_TEXT_OUTPUT > 0
+      logPrintln(MSG_DEBUG_1);
       #ifdef HALLEFFECT
-      Serial.println(F(" 10 raw sensors ADC values used range, max. 0..1023"));
+      logPrintln(MSG_DEBUG_10);
+      #endif
+      logPrintln(MSG_DEBUG_2);
+      #endif
+      logPrintln(MSG_DEBUG_11);
+      logPrintln(MSG_DEBUG_20);
+      #if KIN_MATRIX > 0
+      logPrintln(MSG_DEBUG_21);
+      #endif
+      #if DEBUG_TEXT_OUTPUT > 0
+      logPrintln(MSG_DEBUG_3);
+      logPrintln(MSG_DEBUG_31);
+      logPrintln(MSG_DEBUG_4);
+      logPrintln(MSG_DEBUG_5);
+      logPrintln(MSG_DEBUG_6);
+      logPrintln(MSG_DEBUG_61);
+      #endif
+      #if ENABLE_TELEMETRY > 0
+      logPrintln(MSG_DEBUG_40);
       #endif
-      Serial.println(F("  2 centered values -500..+500"));
-      Serial.println(F(" 11 auto calibrate centers, show deadzones"));
-      Serial.println(F(" 20 find min/max-values over 20s (move stick)"));
-      Serial.println(F("  3 centered values w.deadzones -350..+350"));
-      Serial.println(F(" 31 drift compensation offsets"));
-      Serial.println(F("  4 velocity- (trans-/rot-)values -350..+350"));
-      Serial.println(F("  5 centered- & velocity-values, (3) and (4)"));
-      Serial.println(F("  6 velocity after kill-keys and keys"));
-      Serial.println(F(" 61 velocity after axis-switch, exclusive"));
-      Serial.println(F("  7 loop-frequency-test"));
-      Serial.println(F("  8 key-test, button-codes to send"));
-      Serial.println(F("  9 encoder wheel-test"));
+      logPrintln(MSG_DEBUG_7);
+      #if TASK_SCHEDULER > 0
+      logPrintln(MSG_DEBUG_71);
+      #endif
+      #if MICRO_BENCH > 0
+      logPrintln(MSG_DEBUG_72);
+      #endif
+      #if FLIGHT_RECORDER > 0
+      logPrintln(MSG_DEBUG_73);
+      #endif
+      #if STACK_MONITOR > 0
+      logPrintln(MSG_DEBUG_74);
+      #endif
+      #if LATENCY_STATS > 0
+      logPrintln(MSG_DEBUG_75);
+      #endif
+      logPrintln(MSG_DEBUG_8);
+      logPrintln(MSG_DEBUG_9);
       #if PARAM_IN_EEPROM > 0
-      Serial.println(F(" 30 parameters (load, save, edit, view)"));
+      logPrintln(MSG_DEBUG_30);
       #endif
-      Serial.print(F("mode::"));
+      logPrint(MSG_DEBUG_PROMPT);
       showMenu = false;
     }
   }
 
+  //--- update the tables derived from the parameters, when they were changed by menu, ProgMode or calibration
+  if(par.changed){
+    par.changed = false;
+    updateJoystickTables(par);
+    #if NUMKEYS > 0
+    setupKeys(par);
+    #endif
+  }
+
+  #if MICRO_BENCH > 0
+  //--- measure the primitives once, then leave this debug mode to "off" (-1)
+  if(debug == 72){
+    runMicroBenchmark(par);
+    debug = -1;
+  }
+  #endif
+
+  #if FLIGHT_RECORDER > 0
+  //--- send the frozen (or the actual) flight recorder once, then leave this debug mode to "off" (-1)
+  if(debug == 73){
+    dumpFlightRecorder();
+    debug = -1;
+  }
+  #endif
+
+  #if STACK_MONITOR > 0
+  //--- report the minimum free stack once, then leave this debug mode to "off" (-1)
+  if(debug == 74){
+    logPrint(MSG_STACK_FREE);
+    Serial.print(stackFreeMin());
+    logPrintln(MSG_STACK_BYTES);
+    debug = -1;
+  }
+  #endif
+
+  #if LATENCY_STATS > 0
+  //--- report the latency since the last query once, then leave this debug mode to "off" (-1)
+  if(debug == 75){
+    printLatencyStats(false);
+    debug = -1;
+  }
+  #endif
+
   //--- run parameter-menu
   if(debug == 30){
     #if PARAM_IN_EEPROM > 0
@@ -237,23 +339,43 @@ void loop() {
       debug = 0;
     #endif
   }
+}
+
+/**
+ * @brief Read the sensors and the keys, calculate the velocities and the keys of the HID report
+ * and print the values of the stages in the debug modes. All stages see the time of the frame.
+ */
+static void senseTask() {
+  beginFrame(frame);
+
+  #if IDLE_MODE > 0
+  //--- at rest only check one sensor, the keys and the encoder for a movement: the whole frame every IDLE_PERIOD_MS
+  //    or at once on a movement
+  motionCheckOnly = !idleFrameDue() && !idleMotion(frame, centerPoints, par);
+  if (motionCheckOnly) {
+    return;
+  }
+  #endif
 
-  //--- Read joystick values. 0-1023
-  readAllFromJoystick(rawReads);
+  //--- Read joystick values. 0-1023, and the key presses
+  readStage(frame);
 
-  //--- Reading of key presses
-  #if NUMKEYS > 0
-  readAllFromKeys(keyVals);
+  #if TASK_SCHEDULER > 0 && defined(HALLEFFECT)
+  //--- the analog reference was changed and settles: discard the frame, report no movement
+  if ((long)(frame.millis - referenceSettled) < 0) {
+    memset(frame.velocity, 0, sizeof(frame.velocity));
+    return;
+  }
   #endif
 
   // Report back 0-1023 raw ADC 10-bit values if enabled
   #ifdef HALLEFFECT
   if ((debug == 1) || (debug == 10)) {
-    debugOutput1(rawReads, keyVals);
+    debugOutput1(frame.rawReads, frame.keyVals);
   }
   #else
   if (debug == 1) {
-    debugOutput1(rawReads, keyVals);
+    debugOutput1(frame.rawReads, frame.keyVals);
   }
   #endif
 
@@ -264,164 +386,122 @@ void loop() {
     debug = -1; // after function is done, leave this debug mode to "off" (-1)
   }
 
-  //--- Calculate drift compensation offsets
-  if((par.values->compEnabled == 1) && (debug != 20)){  // only when not in debug 20 = find min/max values
-    compensateDrifts(rawReads, centerPoints, offsets, par);
-  }else{
-    for(int i = 0; i < 8; i++){offsets[i] = 0;}
-  }
+  //--- Calculate drift compensation offsets, only when not in debug 20 = find min/max values or 21 = matrix,
+  //    subtract centre position and drift-offsets from measured position to determine movement.
+  centerStage(frame, centerPoints, (debug != 20) && (debug != 21), par);
 
   // Report compensation-offset values
   if (debug == 31) {
-    debugOutput2(offsets);
-  }
-
-  //--- Subtract centre position and drift-offsets from measured position to determine movement.
-  for (int i = 0; i < 8; i++) {
-    centered[i] = rawReads[i] - centerPoints[i] + offsets[i];
+    debugOutput2(frame.offsets);
   }
 
   //--- calibrate MinMax values
   if (debug == 20) {
     // has to be (re-)called, as long as it doesn't signal "done"
-    if(calcMinMax(centered) == 0){  // when calcMinMax() signals 0="done/idle":
+    if(calcMinMax(frame.centered, par) == 0){  // when calcMinMax() signals 0="done/idle":
       debug = -1;                   // leave this debug-mode 20 to "off" (-1)
     }
   }
 
   // Report centered joystick values if enabled. Values should be approx -350 to +350, jitter around 0 at idle
   if (debug == 2) {
-    debugOutput2(centered);
+    debugOutput2(frame.centered);
   }
 
   //--- Set movement values to zero if movement is below deadzone threshold, scale to +/-350
-  FilterAnalogReadOuts(centered, par);
+  filterStage(frame, par);
 
   // Report centered joystick values. Filtered for deadzone. Approx -350 to +350, locked to zero at idle
   if (debug == 3) {
-    debugOutput2(centered);
+    debugOutput2(frame.centered);
   }
 
+  #if KIN_MATRIX > 0
+  //--- calibrate the decoupling matrix with the filtered values
+  if (debug == 21) {
+    if(calcKinematicMatrix(frame.centered, par) == 0){  // when calcKinematicMatrix() signals 0="done":
+      debug = -1;                                       // leave this debug-mode 21 to "off" (-1)
+    }
+  }
+  #endif
+
   //--- Calculate the kinematic (centered->velocity)
-  calculateKinematic(centered, velocity, par);
+  kinematicStage(frame, par);
 
   //--- if an encoder wheel is used, calculate the velocity of the wheel
   //    and replace one of the former calculated velocities
   #if (ROTARY_AXIS > 0) && (ROTARY_AXIS < 7)
-  calcEncoderWheel(velocity, (debug == 9), par);
+  calcEncoderWheel(frame.velocity, (debug == 9), par);
   #endif
 
   //--- if defined, evaluate keys
-  #if NUMKEYS > 0
-  evalKeys(keyVals, keyOut, keyState);
-  #endif
-
-
-
-
-
-
-
-
-// === Build HID keys with FN1+FN2 zero hotkey ===
-uint8_t hidKeys[NUMKEYS];
-memcpy(hidKeys, keyState, NUMKEYS);
-
-// Требуются индексы Fn из config.h:
-const bool hasFn1 = (KEY_FN1_IDX < NUMKEYS) ? (hidKeys[KEY_FN1_IDX] != 0) : false;
-const bool hasFn2 = (KEY_FN2_IDX < NUMKEYS) ? (hidKeys[KEY_FN2_IDX] != 0) : false;
-
-// Никаких других базовых кнопок в момент удержания:
-bool anyOther = false;
-for (int i = 0; i < NUMHIDKEYS; ++i) {
-  if (i == KEY_FN1_IDX || i == KEY_FN2_IDX) continue;
-  if (hidKeys[i]) { anyOther = true; break; }
-}
-
-// Армирование и срабатывание
-if (hasFn1 && hasFn2 && !anyOther && millis() >= g_fnZeroCooldownUntil) {
-  if (!g_fnZeroPending) {
-    g_fnZeroPending = true;
-    g_fnZeroStart = millis();
-  }
-  // Пока ждём вторую секунду — подавляем любые HID-кнопки полностью:
-  for (int i = 0; i < NUMKEYS; ++i) hidKeys[i] = 0;
-
-  if (millis() - g_fnZeroStart >= FN_ZERO_HOLD_MS) {
-    // Тихое зануление центров (НЕ трогаем min/max, сенсы и т.д.)
-    busyZeroing(centerPoints, FN_ZERO_SAMPLES, /*debugPrint=*/false);
-    g_fnZeroPending = false;
-    g_fnZeroCooldownUntil = millis() + FN_ZERO_COOLDOWN_MS;
-  }
-} else {
-  g_fnZeroPending = false;
-}
-
-
-
-
-
-
-
-
-
+  keyStage(frame);
 
+  //--- keys for the HID report with the FN1+FN2 zero hotkey
+  zeroHotkeyStage(frame, centerPoints);
 
   // The encoder wheel shall be treated as a key
-  #if ROTARY_KEYS > 0 
-  // The encoder wheel shall be treated as a key
-  calcEncoderAsKey(keyState, (debug == 9));
+  #if ROTARY_KEYS > 0
+  calcEncoderAsKey(frame.keyState, (debug == 9));
   #endif
 
   // report translation and rotation values if enabled
   if (debug == 4) {
-    debugOutput4(velocity, keyOut);
+    debugOutput4(frame.velocity, frame.keyOut);
   }
 
   if (debug == 5) {
-    debugOutput5(centered, velocity);
+    debugOutput5(frame.centered, frame.velocity);
   }
 
-  // if the kill-key feature is enabled, rotations or translations are killed=set to zero
-  #if (NUMKILLKEYS == 2)
-  if (keyVals[KILLROT] == LOW) {  
-    // check for the raw keyVal and not keyOut, because keyOut is only 1 for a single iteration. keyVals has inverse Logic due to pull-ups
-    // kill rotation
-    velocity[ROTX] = 0;
-    velocity[ROTY] = 0;
-    velocity[ROTZ] = 0;
-  }
-  if (keyVals[KILLTRANS] == LOW) {
-    // kill translation
-    velocity[TRANSX] = 0;
-    velocity[TRANSY] = 0;
-    velocity[TRANSZ] = 0;
+  #if ENABLE_TELEMETRY > 0
+  // binary telemetry of the values of this frame, see telemetry.h
+  if (debug == 40) {
+    sendTelemetry(frame, par.values->telemetryDecimation);
   }
   #endif
 
+  // if the kill-key feature is enabled, rotations or translations are killed=set to zero
+  killKeyStage(frame);
+
   // report velocity and keys after possible kill-key feature
   if (debug == 6) {
-    debugOutput4(velocity, keyOut);
+    debugOutput4(frame.velocity, frame.keyOut);
   }
 
-  //--- exchange axis if desired
-  if(par.values->switchYZ == 1) {switchYZ(velocity);}
-  if(par.values->switchXY == 1) {switchXY(velocity);}
-
-  // exclusive mode: rotation OR translation, but never both at the same time to avoid issues with classics joysticks
-  if(par.values->exclusiveMode == 1){
-    exclusiveMode(velocity, par.values->exclusiveHysteresis);
-  }
+  //--- exchange axis if desired, exclusive mode: rotation OR translation
+  axisStage(frame, par);
 
   // report velocity and keys after Switch or ExclusiveMode
   if(debug == 61){
-    debugOutput4(velocity, keyOut);
+    debugOutput4(frame.velocity, frame.keyOut);
   }
 
-  // SpaceMouseHID.send_command(velocity[ROTX], velocity[ROTY], velocity[ROTZ], velocity[TRANSX], velocity[TRANSY], velocity[TRANSZ], keyState, debug);
-  SpaceMouseHID.send_command(velocity[ROTX], velocity[ROTY], velocity[ROTZ], velocity[TRANSX], velocity[TRANSY], velocity[TRANSZ], hidKeys, debug);
+  #if IDLE_MODE > 0
+  // at rest for IDLE_AFTER_MS: fewer frames, only without debug output
+  updateIdle(frame, debug <= 0);
+  #endif
+}
 
-  // update and report at what frequency the loop is running
+/**
+ * @brief Send the HID report, when it is due, and check for the LED state from the host
+ */
+static void hidTask() {
+  reportSent = SpaceMouseHID.send_command(frame.velocity[ROTX], frame.velocity[ROTY], frame.velocity[ROTZ],
+                                          frame.velocity[TRANSX], frame.velocity[TRANSY], frame.velocity[TRANSZ],
+                                          frame.hidKeys, debug, frame.millis);
+
+  #if FLIGHT_RECORDER > 0
+  // the frame with the result of its HID report
+  recordFlightFrame(frame, reportSent, SpaceMouseHID.getSendFailed());
+  #endif
+
+  #if LATENCY_STATS > 0
+  // the age of the report, which send_command() has just handed to the endpoint
+  recordLatency(frame, SpaceMouseHID.getSentReportId(), micros());
+  #endif
+
+  // update and report at what frequency the loop (with the scheduler: the sensing) is running
   if(debug == 7){
     updateFrequencyReport();
   }
@@ -429,15 +509,106 @@ if (hasFn1 && hasFn2 && !anyOther && millis() >= g_fnZeroCooldownUntil) {
   // Check for the LED state by calling updateLEDState.
   // This empties the USB input buffer and checks for the corresponding report.
   SpaceMouseHID.updateLEDState();
+}
 
-  #ifdef LEDpin
+#ifdef LEDpin
+/**
+ * @brief Show the LED state from the host (or the movement on the LED ring)
+ */
+static void ledTask() {
   #ifdef LEDRING
-  processLED(velocity, SpaceMouseHID.getLEDState());
+  processLED(frame.velocity, SpaceMouseHID.getLEDState(), reportSent);
   #else
   lightSimpleLED(SpaceMouseHID.getLEDState());
   #endif
+}
+#endif
+
+#if TASK_SCHEDULER > 0
+/**
+ * @brief Send the next bytes of the telemetry frame (debug mode 40) or the next part of the text debug line
+ * (debug modes 1 to 61) of the last sensing, see flushTelemetry() and printDebugOutput()
+ */
+static void outputTask() {
+  #if ENABLE_TELEMETRY > 0
+  flushTelemetry();
   #endif
+  printDebugOutput();
+}
 
+/**
+ * @brief Print the run times, deadline misses and overruns of the tasks once per second in debug mode 71,
+ * a part of a few bytes per call
+ */
+static void statsTask() {
+  static unsigned long lastStats = 0;
+  static uint8_t part = 0;
+  if (part > 0 || (debug == 71 && millis() - lastStats >= 1000)) {
+    if (part == 0) {
+      lastStats = millis();
+    }
+    part = printTaskStats(part);
+  }
+}
+
+// Task table: sensing on a fixed grid of SENSE_PERIOD_US, the HID report and the LEDs after each sensing
+// (send_command() keeps the report rate, processLED() the LEDUPDATERATE_MS), the serial interface, the debug output
+// and the statistics in the remaining time. The budgets are the run times on the Pro Micro with some margin. After
+// the sensing and the HID report about 200 us of each period remain: the tasks for the remaining time print their
+// output in parts of at most 16 bytes (10 us per byte on the USB CDC), so they fit in there.
+const Task taskTable[] PROGMEM = {
+// task          period [us]       budget [us]
+  {senseTask,    SENSE_PERIOD_US,  1000},        // 8 conversions of 104 us + kinematics
+  {hidTask,      SENSE_PERIOD_US,   200},
+  #ifdef LEDpin
+  #ifdef LEDRING
+  {ledTask,      SENSE_PERIOD_US,   LEDRING * 30 + 100}, // FastLED.show(): 30 us per LED
+  #else
+  {ledTask,      SENSE_PERIOD_US,    20},
+  #endif
+  #endif
+  {menuTask,     0,                 200},
+  {outputTask,   0,                 200},        // a value of a debug line or 16 bytes of the telemetry
+  {statsTask,    0,                 200}         // only in debug mode 71: a value of the statistics
+};
+const uint8_t taskCount = sizeof(taskTable) / sizeof(Task);
+#endif
+
+/**
+ * @brief Main-loop of the SpaceMouse, called cyclic by system
+ */
+void loop() {
+  #if TASK_SCHEDULER > 0
+  // one task of the task table per pass
+  runScheduler();
+  #else
+  // all stages one after another
+  menuTask();
+  #if IDLE_MODE > 0
+  // no sensing while the USB is suspended: sleep until the next interrupt
+  if(USBDevice.isSuspended()){
+    idleSleep();
+    return;
+  }
+  #endif
+  senseTask();
+  #if IDLE_MODE > 0
+  // at rest without a movement: no HID report, but the LED state of the host is still read and shown, then sleep
+  // until the next interrupt (at the latest ~1 ms)
+  if(motionCheckOnly){
+    SpaceMouseHID.updateLEDState();
+    #ifdef LEDpin
+    ledTask();
+    #endif
+    idleSleep();
+    return;
+  }
+  #endif
+  hidTask();
+  #ifdef LEDpin
+  ledTask();
+  #endif
+  #endif
 } //end loop()
 
 
@@ -466,25 +637,36 @@ void lightSimpleLED(boolean light){
  * @brief Set the analog reference to 5V for debug 1 and to 2.56V otherwise
  */
 void setAnalogReferenceVoltage(int dbg){
+  static uint8_t reference = 0; // none set yet
+  uint8_t wanted = (dbg == 1) ? DEFAULT : INTERNAL;
+  if (wanted == reference){       // unchanged: nothing has to settle
+    return;
+  }
+  reference = wanted;
   if (dbg == 1){  // Set the reference voltage for the AD Convertor to 5V only for the first calibration step (pinout/inversion calibration).
     analogReference(DEFAULT);
     #ifdef DEBUG_ADC
-      Serial.println(F("Setting analog reference to 5V."));
+      logPrintln(MSG_AREF_5V);
     #endif
   }else{          // Set the reference voltage for the AD Convertor to 2.56V in order to get larger sensitivity.
     analogReference(INTERNAL);
     #ifdef DEBUG_ADC
-      Serial.println(F("Setting analog reference to 2.56V."));
+      logPrintln(MSG_AREF_256);
     #endif
   }
 
   // The first measurements after changing the reference voltage can be wrong. So take 100ms to let the voltage stabilize and
   // take some measurements afterwards just to be sure. Performancewise this isn't a problem due to the debug/setup
   // nature of this function.
+  #if TASK_SCHEDULER > 0
+  // with the scheduler the sensing keeps its grid and discards its frames meanwhile, see senseTask()
+  referenceSettled = millis() + 100;
+  #else
   delay(100);
   int tempReads[8];
   for (int i = 0; i <= 8; i++){
     readAllFromJoystick(tempReads);
   }
+  #endif
 }
 #endif
@@ -0,0 +1,47 @@
+// File for the stack monitor (debug mode 74, ProgMode >f), see stackMonitor.h
+//
+// With STACK_MONITOR 1 the RAM from the end of .bss (__heap_start, the same as _end) up to the top of the stack
+// (__stack = RAMEND) is painted in .init1, before the stack is used. stackFreeMin() counts the painted bytes from
+// the end of the heap upwards, until the first byte the stack has overwritten: the minimum free stack since the
+// start, including the interrupt routines. The host build paints the stack of the firmware in the shim
+// (sim::runOnStack()), so host/tools/stack_report uses the same function without STACK_MONITOR.
+
+#include <Arduino.h>
+#include "config.h"
+#include "stackMonitor.h"
+
+extern uint8_t __heap_start[]; // end of .bss, the heap starts here
+extern uint8_t *__brkval;      // end of the heap, 0 as long as malloc() wasn't used
+
+#if STACK_MONITOR > 0 && defined(__AVR__)
+/// @brief Paint the RAM above .bss with STACK_PAINT. Runs in .init1 before the stack pointer is set and before
+/// .data and .bss are initialized, so it must not use the stack or variables.
+void paintStack() __attribute__((naked, used, section(".init1")));
+void paintStack() {
+  __asm volatile(
+      "    ldi r30, lo8(__heap_start)\n"
+      "    ldi r31, hi8(__heap_start)\n"
+      "    ldi r24, %0\n"
+      "    ldi r25, hi8(__stack)\n"
+      "    rjmp 2f\n"
+      "1:  st Z+, r24\n"
+      "2:  cpi r30, lo8(__stack)\n"
+      "    cpc r31, r25\n"
+      "    brlo 1b\n"
+      "    breq 1b\n"
+      :: "M"(STACK_PAINT));
+}
+#endif
+
+/// @brief Count the bytes of the painted RAM, which the stack hasn't reached since the start
+/// @return minimum free stack in bytes
+uint16_t stackFreeMin() {
+  const uint8_t *p = (__brkval != 0) ? __brkval : __heap_start;
+  uint16_t count = 0;
+  // the return address of this function is above, so the loop ends
+  while (*p == STACK_PAINT) {
+    p++;
+    count++;
+  }
+  return count;
+}
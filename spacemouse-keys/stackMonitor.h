@@ -0,0 +1,17 @@
+// Header for the stack monitor (debug mode 74, ProgMode >f)
+// The free RAM between the end of .bss (or the heap) and the stack is painted with STACK_PAINT before main(). The
+// stack overwrites the paint, so the painted bytes left show the minimum free stack since the start.
+#ifndef STACKMONITOR_H
+  #define STACKMONITOR_H
+
+  #include <Arduino.h>
+  #include "config.h"
+
+  #ifndef STACK_MONITOR
+    #define STACK_MONITOR 0
+  #endif
+
+  #define STACK_PAINT 0xC5 // not 0x00 or 0xFF, which are common in variables
+
+  uint16_t stackFreeMin();
+#endif
@@ -0,0 +1,118 @@
+// File for the binary telemetry (debug mode 40)
+//
+// The text debug modes print one line every DEBUGDELAY ms, formatted with sprintf(). The telemetry sends the
+// inputs and results of every n-th loop pass (parameter TELEM_DEC, 1 = every pass) as binary frame, see
+// telemetry.h for the content. Frames are COBS encoded (Consistent Overhead Byte Stuffing): the encoded frame
+// contains no 0x00, so 0x00 marks the end of a frame and the receiver can resynchronize after lost bytes.
+// With TASK_SCHEDULER 1 the sensing task only encodes the frame, the telemetry task sends it in the remaining time
+// with flushTelemetry(), TELEMETRY_FLUSH_BYTES per call. A frame, which comes while the last one is still being sent,
+// is lost: a gap in loopCount.
+
+#include <Arduino.h>
+#include <util/crc16.h>
+#include "config.h"
+#include "telemetry.h"
+#include "scheduler.h"
+
+#if ENABLE_TELEMETRY > 0
+
+#if TASK_SCHEDULER > 0
+#define TELEMETRY_FLUSH_BYTES 16               // per call of flushTelemetry(): 160 us on the USB CDC
+static uint8_t pending[TELEMETRY_MAX_ENCODED]; // encoded frame for flushTelemetry()
+static uint8_t pendingLen = 0;
+static uint8_t pendingSent = 0;                // bytes of pending[] already sent
+#endif
+
+/// @brief Send data COBS encoded and terminated by 0x00. The data is split at each 0x00 into groups,
+/// each group is preceded by its length + 1 instead of the 0x00. The data must be shorter than 254 bytes.
+/// @param data pointer to the data
+/// @param len  number of bytes
+static void writeCobs(const uint8_t *data, uint8_t len) {
+#if TASK_SCHEDULER > 0
+  if (pendingLen > 0) {
+    return; // the last frame is still being sent
+  }
+  uint8_t *out = pending;
+#else
+  uint8_t out[TELEMETRY_MAX_ENCODED];
+#endif
+  uint8_t code = 0; // index of the length of the actual group in out
+  uint8_t n = 1;
+  for (uint8_t i = 0; i < len; i++) {
+    if (data[i] == 0) {
+      out[code] = n - code;
+      code = n++;
+    } else {
+      out[n++] = data[i];
+    }
+  }
+  out[code] = n - code;
+  out[n++] = 0;
+#if TASK_SCHEDULER > 0
+  pendingLen = n;
+  pendingSent = 0;
+#else
+  Serial.write(out, n); // one write, the USB stack combines it into full packets
+#endif
+}
+
+#if TASK_SCHEDULER > 0
+/// @brief Send the next bytes of the last encoded frame, if it wasn't sent completely. Called by the telemetry task.
+void flushTelemetry() {
+  if (pendingLen > 0) {
+    uint8_t n = min(pendingLen - pendingSent, TELEMETRY_FLUSH_BYTES);
+    Serial.write(pending + pendingSent, n);
+    pendingSent += n;
+    if (pendingSent == pendingLen) {
+      pendingLen = 0;
+    }
+  }
+}
+#endif
+
+/// @brief Send a telemetry frame with the actual values of the frame, if the decimation is due.
+/// @param frame the frame after the kinematics: raw values, centered values after the deadzone, drift compensation
+///              offsets, velocities and debounced key states
+/// @param decimation send every n-th frame
+void sendTelemetry(const Frame &frame, uint16_t decimation) {
+  static uint16_t lastSent = 0;
+
+  if ((uint16_t)(frame.sequence - lastSent) < decimation) {
+    return;
+  }
+  lastSent = frame.sequence;
+
+  struct {
+    TelemetryFrame frame;
+    uint16_t crc;
+  } __attribute__((packed)) msg;
+  TelemetryFrame &f = msg.frame;
+  f.type = TELEMETRY_FRAME_TYPE;
+  f.loopCount = frame.sequence;
+  f.micros = frame.micros;
+  for (uint8_t i = 0; i < 8; i++) {
+    f.raw[i] = frame.rawReads[i];
+    f.centered[i] = frame.centered[i];
+    f.offsets[i] = frame.offsets[i];
+  }
+  for (uint8_t i = 0; i < 6; i++) {
+    f.velocity[i] = frame.velocity[i];
+  }
+  f.keys = 0;
+#if NUMKEYS > 0
+  for (uint8_t i = 0; i < NUMKEYS && i < 16; i++) {
+    if (frame.keyState[i]) {
+      f.keys |= 1u << i;
+    }
+  }
+#endif
+
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < sizeof(TelemetryFrame); i++) {
+    crc = _crc_ccitt_update(crc, ((uint8_t *)&f)[i]);
+  }
+  msg.crc = crc;
+  writeCobs((uint8_t *)&msg, sizeof(msg));
+}
+
+#endif // ENABLE_TELEMETRY
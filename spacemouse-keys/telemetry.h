@@ -0,0 +1,35 @@
+// Header for the binary telemetry (debug mode 40)
+// Instead of formatted text lines, each loop pass is sent as a binary frame, COBS encoded and terminated by 0x00.
+// The frames are decoded by host/tools/telemetry_decode.
+#ifndef TELEMETRY_H
+  #define TELEMETRY_H
+
+  #include <Arduino.h>
+  #include "config.h"
+  #include "pipeline.h"
+
+  #ifndef ENABLE_TELEMETRY
+    #define ENABLE_TELEMETRY 0
+  #endif
+
+  #define TELEMETRY_FRAME_TYPE 1 // first byte of a frame, change it when TelemetryFrame changes
+
+  // Content of a frame, all values little endian. The frame is followed by the CRC-16/MCRF4XX of the frame
+  // (_crc_ccitt_update(), start 0xFFFF, low byte first) and then COBS encoded.
+  // 69 bytes + 2 bytes CRC + 2 bytes COBS overhead = 73 bytes, ~73 kByte/s at 1 kHz.
+  typedef struct _TelemetryFrame {
+    uint8_t  type;         // TELEMETRY_FRAME_TYPE
+    uint16_t loopCount;    // Frame::sequence, gaps show the decimation or lost frames
+    uint32_t micros;       // Frame::micros: time of the sampling of the sensors
+    int16_t  raw[8];       // rawReads[], as in debug mode 1
+    int16_t  centered[8];  // centered[] after the deadzone, as in debug mode 3
+    int16_t  offsets[8];   // drift compensation offsets, as in debug mode 31
+    int16_t  velocity[6];  // velocity[] before kill-keys, as in debug mode 4
+    uint16_t keys;         // bit i = keyState[i]
+  } __attribute__((packed)) TelemetryFrame;
+
+  #define TELEMETRY_MAX_ENCODED (sizeof(TelemetryFrame) + 2 + 2) // frame + CRC + COBS code + delimiter
+
+  void sendTelemetry(const Frame &frame, uint16_t decimation);
+  void flushTelemetry(); // TASK_SCHEDULER 1: sends the next bytes of the frame of sendTelemetry()
+#endif